@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+/**
+ * Checkpoint of a pool full of dirty pages: one WritePage per page in page id order (how FlushAllPages wrote them
+ * before) against FlushAllPages, which writes neighbouring pages with one pwritev. Both end with the checkpoint of
+ * the disk manager, so both include the fdatasync of the file.
+ *
+ * Every page of the pool is dirty, or a random half of them. With several shards the pages of all shards go into
+ * one batch.
+ *
+ * Usage: flush_benchmark [pool_size]
+ */
+static const std::string db_name = "flush_benchmark.db";
+
+struct Result {
+  double per_page_ms_;
+  double batched_ms_;
+};
+
+static Result Bench(size_t pool_size, size_t num_instances, double dirty_ratio) {
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  BufferPoolManager *bpm;
+  if (num_instances > 1) {
+    bpm = new ParallelBufferPoolManager(num_instances, pool_size / num_instances, disk_manager);
+  } else {
+    bpm = new BufferPoolManager(pool_size, disk_manager);
+  }
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < pool_size; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(page_id);
+    memset(page->GetData(), 'd', PAGE_SIZE);
+    bpm->UnpinPage(page_id, true);
+    page_ids.push_back(page_id);
+  }
+  // the file has its full size, neither run extends it
+  bpm->FlushAllPages();
+  std::mt19937 gen(2022);
+  std::shuffle(page_ids.begin(), page_ids.end(), gen);
+  page_ids.resize(static_cast<size_t>(dirty_ratio * pool_size));
+  std::sort(page_ids.begin(), page_ids.end());
+
+  Result result{};
+  {
+    std::vector<Page *> pages;
+    for (auto page_id : page_ids) {
+      pages.push_back(bpm->FetchPage(page_id));
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (auto page : pages) {
+      disk_manager->WritePage(page->GetPageId(), page->GetData());
+    }
+    disk_manager->Checkpoint();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    result.per_page_ms_ = elapsed.count();
+    for (auto page_id : page_ids) {
+      bpm->UnpinPage(page_id, true);
+    }
+  }
+  {
+    auto start = std::chrono::steady_clock::now();
+    bpm->FlushAllPages();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    result.batched_ms_ = elapsed.count();
+  }
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+  return result;
+}
+
+int main(int argc, char **argv) {
+  size_t pool_size = argc > 1 ? std::stoul(argv[1]) : 16384;
+
+  printf("%-8s %8s %14s %14s %8s\n", "shards", "dirty", "per page ms", "batched ms", "speedup");
+  for (size_t num_instances : {1, 4}) {
+    for (double dirty_ratio : {1.0, 0.5}) {
+      Result result = Bench(pool_size, num_instances, dirty_ratio);
+      printf("%-8zu %7.0f%% %14.1f %14.1f %7.2fx\n", num_instances, dirty_ratio * 100, result.per_page_ms_,
+             result.batched_ms_, result.per_page_ms_ / result.batched_ms_);
+    }
+  }
+  return 0;
+}
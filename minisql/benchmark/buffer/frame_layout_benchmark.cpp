@@ -0,0 +1,78 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+
+/**
+ * Metadata scans and random page hits on a big buffer pool.
+ *
+ * 1. CheckAllUnpinned walks the metadata of every frame, like a victim search does.
+ * 2. Random FetchPage hits that read one word of each page, over the whole pool (TLB bound).
+ * Also reports how much of the process is backed by transparent huge pages.
+ *
+ * Usage: frame_layout_benchmark [num_frames] [num_fetches]
+ */
+static const std::string db_name = "frame_layout_benchmark.db";
+
+static long AnonHugePagesKb() {
+  std::ifstream smaps("/proc/self/smaps");
+  std::string line;
+  long total = 0;
+  while (std::getline(smaps, line)) {
+    if (line.compare(0, 14, "AnonHugePages:") == 0) {
+      total += std::stol(line.substr(14));
+    }
+  }
+  return total;
+}
+
+int main(int argc, char **argv) {
+  size_t num_frames = argc > 1 ? std::stoul(argv[1]) : 65536;
+  int num_fetches = argc > 2 ? std::stoi(argv[2]) : 5000000;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(num_frames, disk_manager);
+  // the file is empty, every page reads back as zeros and stays clean
+  for (size_t i = 0; i < num_frames; i++) {
+    bpm->FetchPage(i)->GetData()[0] = 1;
+    bpm->UnpinPage(i, false);
+  }
+
+  const int scans = 200;
+  auto start = std::chrono::steady_clock::now();
+  bool all_unpinned = true;
+  for (int i = 0; i < scans; i++) {
+    all_unpinned = bpm->CheckAllUnpinned() && all_unpinned;
+  }
+  std::chrono::duration<double> scan_time = std::chrono::steady_clock::now() - start;
+
+  std::mt19937 gen(2022);
+  std::uniform_int_distribution<page_id_t> dist(0, num_frames - 1);
+  std::vector<page_id_t> page_ids(num_fetches);
+  for (auto &page_id : page_ids) {
+    page_id = dist(gen);
+  }
+  long sum = 0;
+  start = std::chrono::steady_clock::now();
+  for (auto page_id : page_ids) {
+    Page *page = bpm->FetchPage(page_id);
+    sum += page->GetData()[page_id % PAGE_SIZE];
+    bpm->UnpinPage(page_id, false);
+  }
+  std::chrono::duration<double> fetch_time = std::chrono::steady_clock::now() - start;
+
+  printf("frames                  %zu (%zu MB)\n", num_frames, num_frames * PAGE_SIZE >> 20);
+  printf("sizeof(Page)            %zu bytes\n", sizeof(Page));
+  printf("metadata scan           %.1f us per pass\n", scan_time.count() * 1e6 / scans);
+  printf("random hits             %.0f fetches/s\n", num_fetches / fetch_time.count());
+  printf("AnonHugePages           %ld kB\n", AnonHugePagesKb());
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+  return all_unpinned && sum >= 0 ? 0 : 1;
+}
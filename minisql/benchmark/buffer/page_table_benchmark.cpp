@@ -0,0 +1,100 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/page_table.h"
+
+/**
+ * Miss-heavy page table lookups.
+ *
+ * 1. The lookup alone: std::unordered_map::at() with a caught std::out_of_range (what FetchPage
+ *    used to do on every miss) against PageTable::Find(), for a pool sized table and mostly absent keys.
+ * 2. End to end FetchPage throughput when the working set is 8x the pool, so most fetches miss.
+ *
+ * Usage: page_table_benchmark [num_lookups] [num_fetches]
+ */
+static const std::string db_name = "page_table_benchmark.db";
+static const size_t pool_size = 1024;
+
+template <typename F>
+static double Measure(int ops, F &&f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return ops / elapsed.count();
+}
+
+static std::vector<page_id_t> RandomPageIds(int count, page_id_t max_page_id) {
+  std::mt19937 gen(2022);
+  std::uniform_int_distribution<page_id_t> dist(0, max_page_id - 1);
+  std::vector<page_id_t> res(count);
+  for (auto &page_id : res) {
+    page_id = dist(gen);
+  }
+  return res;
+}
+
+int main(int argc, char **argv) {
+  int num_lookups = argc > 1 ? std::stoi(argv[1]) : 2000000;
+  int num_fetches = argc > 2 ? std::stoi(argv[2]) : 200000;
+
+  // 1. lookups, about 1 in 8 keys present
+  auto keys = RandomPageIds(num_lookups, pool_size * 8);
+  std::unordered_map<page_id_t, frame_id_t> map;
+  PageTable table(pool_size);
+  for (size_t i = 0; i < pool_size; i++) {
+    map[i * 8] = i;
+    table.Insert(i * 8, i);
+  }
+  size_t found = 0;
+  double map_ops = Measure(num_lookups, [&] {
+    for (auto page_id : keys) {
+      try {
+        found += map.at(page_id);
+      } catch (const std::out_of_range &e) {
+        continue;
+      }
+    }
+  });
+  double table_ops = Measure(num_lookups, [&] {
+    frame_id_t frame_id;
+    for (auto page_id : keys) {
+      if (table.Find(page_id, &frame_id)) {
+        found += frame_id;
+      }
+    }
+  });
+  printf("%-36s %14.0f lookups/s\n", "unordered_map::at + catch", map_ops);
+  printf("%-36s %14.0f lookups/s (%.1fx)\n", "PageTable::Find", table_ops, table_ops / map_ops);
+
+  // 2. FetchPage with a working set 8x the pool
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(pool_size, disk_manager);
+  page_id_t page_id;
+  for (size_t i = 0; i < pool_size * 8; i++) {
+    bpm->NewPage(page_id);
+    bpm->UnpinPage(page_id, false);
+  }
+  auto fetches = RandomPageIds(num_fetches, pool_size * 8);
+  size_t misses = bpm->GetMissCount();
+  double fetch_ops = Measure(num_fetches, [&] {
+    for (auto fetch_id : fetches) {
+      if (bpm->FetchPage(fetch_id) != nullptr) {
+        bpm->UnpinPage(fetch_id, false);
+      }
+    }
+  });
+  printf("%-36s %14.0f fetches/s (%.1f%% misses)\n", "BufferPoolManager::FetchPage", fetch_ops,
+         100.0 * (bpm->GetMissCount() - misses) / num_fetches);
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+  // use the result, so the lookups are not optimized away
+  return found == 0 ? 1 : 0;
+}
@@ -0,0 +1,76 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+/**
+ * Fetch/unpin throughput of a single latched BufferPoolManager against a sharded
+ * ParallelBufferPoolManager of the same total size, with 1 to 32 threads.
+ * The working set fits in the pool, so (after warm up) every fetch is a hit and
+ * the buffer pool latch is the only contended resource.
+ *
+ * Usage: parallel_buffer_pool_manager_benchmark [fetches_per_thread] [num_instances]
+ */
+static const std::string db_name = "parallel_bpm_benchmark.db";
+static const size_t total_frames = 1024;
+static const int working_set = 512;
+
+static double RunFetches(BufferPoolManager *bpm, int num_threads, int fetches_per_thread) {
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([bpm, t, fetches_per_thread] {
+      std::mt19937 gen(t);
+      std::uniform_int_distribution<page_id_t> dist(0, working_set - 1);
+      for (int i = 0; i < fetches_per_thread; i++) {
+        page_id_t page_id = dist(gen);
+        Page *page = bpm->FetchPage(page_id);
+        if (page != nullptr) {
+          bpm->UnpinPage(page_id, false);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return num_threads * static_cast<double>(fetches_per_thread) / elapsed.count();
+}
+
+static double Bench(size_t num_instances, int num_threads, int fetches_per_thread) {
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  BufferPoolManager *bpm;
+  if (num_instances > 1) {
+    bpm = new ParallelBufferPoolManager(num_instances, total_frames / num_instances, disk_manager);
+  } else {
+    bpm = new BufferPoolManager(total_frames, disk_manager);
+  }
+  page_id_t page_id;
+  for (int i = 0; i < working_set; i++) {
+    bpm->NewPage(page_id);
+    bpm->UnpinPage(page_id, false);
+  }
+  double fetches_per_sec = RunFetches(bpm, num_threads, fetches_per_thread);
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+  return fetches_per_sec;
+}
+
+int main(int argc, char **argv) {
+  int fetches_per_thread = argc > 1 ? std::stoi(argv[1]) : 200000;
+  size_t num_instances = argc > 2 ? std::stoul(argv[2]) : 16;
+  printf("%8s %18s %18s %8s\n", "threads", "single (fetch/s)", "sharded (fetch/s)", "speedup");
+  for (int num_threads = 1; num_threads <= 32; num_threads *= 2) {
+    double single = Bench(1, num_threads, fetches_per_thread);
+    double sharded = Bench(num_instances, num_threads, fetches_per_thread);
+    printf("%8d %18.0f %18.0f %7.2fx\n", num_threads, single, sharded, sharded / single);
+  }
+  return 0;
+}
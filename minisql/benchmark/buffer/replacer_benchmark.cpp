@@ -0,0 +1,87 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+
+#include "buffer/buffer_pool_manager.h"
+
+/**
+ * Hit ratio of each replacement policy on point lookups mixed with periodic full scans.
+ *
+ * A point lookup walks a three level B+ tree (root, one of the inner pages, one of the leaves)
+ * and then fetches one random heap page. Every scan_interval lookups a full scan walks every
+ * heap page in order, fetching each page once per row like TableIterator does. The index pages
+ * fit in the pool, the heap does not.
+ *
+ * Usage: replacer_benchmark [num_lookups] [scan_interval]
+ */
+static const std::string db_name = "replacer_benchmark.db";
+static const size_t pool_size = 256;
+static const int inner_pages = 8;
+static const int leaf_pages = 120;
+static const int heap_pages = 2000;
+static const int rows_per_page = 16;
+
+static void Touch(BufferPoolManager *bpm, page_id_t page_id) {
+  if (bpm->FetchPage(page_id) != nullptr) {
+    bpm->UnpinPage(page_id, false);
+  }
+}
+
+static void Bench(const char *name, ReplacerType replacer_type, int num_lookups, int scan_interval) {
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(pool_size, disk_manager, replacer_type);
+  const int index_pages = 1 + inner_pages + leaf_pages;
+  page_id_t page_id;
+  for (int i = 0; i < index_pages + heap_pages; i++) {
+    bpm->NewPage(page_id);
+    bpm->UnpinPage(page_id, false);
+  }
+  const page_id_t root = 0;
+  const page_id_t first_inner = 1;
+  const page_id_t first_leaf = first_inner + inner_pages;
+  const page_id_t first_heap = index_pages;
+
+  std::mt19937 gen(2022);
+  std::uniform_int_distribution<int> key(0, leaf_pages * 64 - 1);
+  std::uniform_int_distribution<page_id_t> heap(first_heap, first_heap + heap_pages - 1);
+  size_t lookup_hits = 0;
+  size_t lookup_fetches = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_lookups; i++) {
+    if (i % scan_interval == 0) {
+      for (page_id_t p = first_heap; p < first_heap + heap_pages; p++) {
+        for (int row = 0; row < rows_per_page; row++) {
+          Touch(bpm, p);
+        }
+      }
+    }
+    size_t hits = bpm->GetHitCount();
+    int leaf = key(gen) / 64;
+    Touch(bpm, root);
+    Touch(bpm, first_inner + leaf * inner_pages / leaf_pages);
+    Touch(bpm, first_leaf + leaf);
+    Touch(bpm, heap(gen));
+    lookup_hits += bpm->GetHitCount() - hits;
+    lookup_fetches += 4;
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  size_t hits = bpm->GetHitCount();
+  size_t misses = bpm->GetMissCount();
+  printf("%-8s %14.2f%% %14.2f%% %10zu %10.3f\n", name, 100.0 * lookup_hits / lookup_fetches,
+         100.0 * hits / (hits + misses), misses, elapsed.count());
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+int main(int argc, char **argv) {
+  int num_lookups = argc > 1 ? std::stoi(argv[1]) : 200000;
+  int scan_interval = argc > 2 ? std::stoi(argv[2]) : 5000;
+  printf("%-8s %15s %15s %10s %10s\n", "policy", "lookup hit", "overall hit", "misses", "seconds");
+  Bench("lru", ReplacerType::LRU_REPLACER, num_lookups, scan_interval);
+  Bench("clock", ReplacerType::CLOCK_REPLACER, num_lookups, scan_interval);
+  Bench("lru-2", ReplacerType::LRU_K_REPLACER, num_lookups, scan_interval);
+  return 0;
+}
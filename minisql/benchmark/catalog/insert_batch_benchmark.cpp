@@ -0,0 +1,72 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/instance.h"
+#include "record/field.h"
+#include "record/schema.h"
+
+/**
+ * Load of a table with a primary key index, a row at a time with CatalogManager::Insert (how every insert of an
+ * executed file went in before) against CatalogManager::InsertBatch with batches of INSERT_BATCH_SIZE rows. The
+ * keys come in random order, as from a file not sorted by the key, or in key order with "sorted".
+ *
+ * Usage: insert_batch_benchmark [num_rows] [sorted]
+ */
+static const std::string db_name = "insert_batch_benchmark.db";
+static const int payload_len = 100;
+
+int main(int argc, char **argv) {
+  int num_rows = argc > 1 ? std::stoi(argv[1]) : 200000;
+  bool sorted = argc > 2 && std::string(argv[2]) == "sorted";
+
+  std::vector<int> keys(num_rows);
+  for (int i = 0; i < num_rows; i++) {
+    keys[i] = i;
+  }
+  if (!sorted) {
+    std::mt19937 gen(2022);
+    std::shuffle(keys.begin(), keys.end(), gen);
+  }
+  std::string payload(payload_len, 'x');
+
+  printf("%-8s %12s %12s\n", "insert", "seconds", "rows/s");
+  for (bool batched : {false, true}) {
+    DBStorageEngine engine(db_name, true);
+    std::vector<Column *> columns = {
+            new Column("id", TypeId::kTypeInt, 0, false, false),
+            new Column("payload", TypeId::kTypeChar, payload_len, 1, false, false)
+    };
+    Schema schema(columns);
+    TableInfo *table_info = nullptr;
+    IndexInfo *index_info = nullptr;
+    engine.catalog_mgr_->CreateTable("t", &schema, nullptr, table_info, {0});
+    engine.catalog_mgr_->CreateIndex("t", CatalogManager::AutoGenPKIndexName("t"), {"id"}, nullptr, index_info);
+    std::vector<Row> rows;
+    rows.reserve(INSERT_BATCH_SIZE);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_rows; i++) {
+      std::vector<Field> fields = {
+              Field(TypeId::kTypeInt, keys[i]),
+              Field(TypeId::kTypeChar, const_cast<char *>(payload.c_str()), payload_len, false)
+      };
+      if (!batched) {
+        Row row(fields);
+        engine.catalog_mgr_->Insert(table_info, row, nullptr);
+        continue;
+      }
+      rows.emplace_back(fields);
+      if (rows.size() == static_cast<size_t>(INSERT_BATCH_SIZE) || i == num_rows - 1) {
+        engine.catalog_mgr_->InsertBatch(table_info, rows, nullptr);
+        rows.clear();
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    printf("%-8s %12.2f %12.0f\n", batched ? "batch" : "row", elapsed.count(), num_rows / elapsed.count());
+  }
+  remove(db_name.c_str());
+  return 0;
+}
@@ -0,0 +1,80 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "storage/disk_manager.h"
+#include "drop_cache.h"
+
+/**
+ * Random page reads through DiskManager::ReadPageAsync at increasing queue depths, with io_uring and with the
+ * thread pool backend, against one synchronous ReadPage at a time.
+ *
+ * The file is dropped from the page cache (posix_fadvise) before every run, so the reads go to the device and
+ * the numbers show how much of its parallelism each queue depth uses.
+ *
+ * Usage: async_io_benchmark [num_pages] [num_reads]
+ */
+static const std::string db_name = "async_io_benchmark.db";
+
+static void Report(const char *name, size_t queue_depth, int num_reads, double seconds) {
+  printf("%-12s %6zu %12.0f %10.1f\n", name, queue_depth, num_reads / seconds,
+         static_cast<double>(num_reads) * PAGE_SIZE / seconds / (1 << 20));
+}
+
+int main(int argc, char **argv) {
+  int num_pages = argc > 1 ? std::stoi(argv[1]) : 32768;
+  int num_reads = argc > 2 ? std::stoi(argv[2]) : 20000;
+
+  remove(db_name.c_str());
+  DiskManager disk_manager(db_name, DurabilityPolicy::NONE);
+  {
+    char data[PAGE_SIZE];
+    memset(data, 'r', PAGE_SIZE);
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      disk_manager.WritePage(page_id, data);
+    }
+  }
+  std::mt19937 gen(2022);
+  std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+  std::vector<page_id_t> page_ids(num_reads);
+  for (auto &page_id : page_ids) {
+    page_id = dist(gen);
+  }
+
+  printf("%-12s %6s %12s %10s\n", "backend", "depth", "reads/s", "MB/s");
+  {
+    DropCache(db_name);
+    char data[PAGE_SIZE];
+    auto start = std::chrono::steady_clock::now();
+    for (auto page_id : page_ids) {
+      disk_manager.ReadPage(page_id, data);
+    }
+    std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+    Report("sync", 1, num_reads, time.count());
+  }
+  std::vector<char> buffer(static_cast<size_t>(num_reads) * PAGE_SIZE);
+  for (bool use_io_uring : {true, false}) {
+    for (size_t queue_depth : {1, 4, 16, 64, 128}) {
+      disk_manager.ConfigureAsyncIO(queue_depth, use_io_uring);
+      const char *name = disk_manager.GetAsyncIOBackend() == AsyncIO::Backend::IO_URING ? "io_uring" : "threads";
+      DropCache(db_name);
+      IOWaitGroup reads;
+      reads.Add(num_reads);
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < num_reads; i++) {
+        disk_manager.ReadPageAsync(page_ids[i], buffer.data() + static_cast<size_t>(i) * PAGE_SIZE,
+                                   [&reads](bool) { reads.Done(); });
+      }
+      // blocks while the queue is full
+      disk_manager.SubmitBatch();
+      reads.Wait();
+      std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+      Report(name, queue_depth, num_reads, time.count());
+    }
+  }
+  remove(db_name.c_str());
+  return 0;
+}
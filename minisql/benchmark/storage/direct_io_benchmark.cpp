@@ -0,0 +1,135 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/instance.h"
+#include "index/index.h"
+#include "record/field.h"
+#include "record/schema.h"
+#include "storage/table_heap.h"
+#include "drop_cache.h"
+
+/**
+ * Point lookups and a full scan with a buffer pool large enough for the whole database, with the disk manager
+ * reading the file with pread through the kernel page cache and with O_DIRECT (DiskIOMode::DIRECT).
+ *
+ * The file is dropped from the page cache before each mode, so every page is read from the device once. After
+ * the run, "rss" is the memory the process gained while the database was open (mostly the buffer pool) and
+ * "cached" how much of the file the kernel page cache holds on top of it: with pread every page is in memory twice.
+ *
+ * Usage: direct_io_benchmark [num_rows] [num_lookups] [buffer_pool_size]
+ */
+static const std::string db_name = "direct_io_benchmark.db";
+static const int payload_len = 100;
+
+// resident set of the process in MB
+static double RssMB() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind("VmRSS:", 0) == 0) {
+      return std::stod(line.substr(6)) / 1024;
+    }
+  }
+  return 0;
+}
+
+// MB of the file in the kernel page cache
+static double CachedMB() {
+  int fd = open(db_name.c_str(), O_RDONLY);
+  struct stat stat_buf;
+  if (fd < 0 || fstat(fd, &stat_buf) != 0 || stat_buf.st_size == 0) {
+    return 0;
+  }
+  size_t os_page_size = sysconf(_SC_PAGESIZE);
+  void *map = mmap(nullptr, stat_buf.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    return 0;
+  }
+  std::vector<unsigned char> resident((stat_buf.st_size + os_page_size - 1) / os_page_size);
+  size_t cached = 0;
+  if (mincore(map, stat_buf.st_size, resident.data()) == 0) {
+    for (auto page : resident) {
+      cached += page & 1;
+    }
+  }
+  munmap(map, stat_buf.st_size);
+  return static_cast<double>(cached) * os_page_size / (1 << 20);
+}
+
+int main(int argc, char **argv) {
+  int num_rows = argc > 1 ? std::stoi(argv[1]) : 100000;
+  int num_lookups = argc > 2 ? std::stoi(argv[2]) : 200000;
+  uint32_t pool_size = argc > 3 ? std::stoi(argv[3]) : 16384;
+
+  {
+    DBStorageEngine engine(db_name, true, 16384);
+    std::vector<Column *> columns = {
+            new Column("id", TypeId::kTypeInt, 0, false, false),
+            new Column("payload", TypeId::kTypeChar, payload_len, 1, false, false)
+    };
+    Schema schema(columns);
+    TableInfo *table_info = nullptr;
+    IndexInfo *index_info = nullptr;
+    engine.catalog_mgr_->CreateTable("t", &schema, nullptr, table_info, {0});
+    engine.catalog_mgr_->CreateIndex("t", CatalogManager::AutoGenPKIndexName("t"), {"id"}, nullptr, index_info);
+    std::string payload(payload_len, 'x');
+    for (int i = 0; i < num_rows; i++) {
+      std::vector<Field> fields = {
+              Field(TypeId::kTypeInt, i),
+              Field(TypeId::kTypeChar, const_cast<char *>(payload.c_str()), payload_len, false)
+      };
+      Row row(fields);
+      engine.catalog_mgr_->Insert(table_info, row, nullptr);
+    }
+  }
+
+  printf("%-8s %12s %12s %10s %10s\n", "mode", "lookups/s", "scan ms", "rss MB", "cached MB");
+  for (auto io_mode : {DiskIOMode::PREAD, DiskIOMode::DIRECT}) {
+    DropCache(db_name);
+    double rss = RssMB();
+    DBStorageEngine engine(db_name, false, pool_size, DEFAULT_BUFFER_POOL_INSTANCES, DEFAULT_REPLACER_TYPE, 0,
+                           DEFAULT_DURABILITY_POLICY, io_mode);
+    const char *name = engine.disk_mgr_->GetIOMode() == DiskIOMode::DIRECT ? "direct" : "pread";
+    TableInfo *table_info = nullptr;
+    IndexInfo *index_info = nullptr;
+    engine.catalog_mgr_->GetTable("t", table_info);
+    engine.catalog_mgr_->GetIndex("t", CatalogManager::AutoGenPKIndexName("t"), index_info);
+    std::mt19937 gen(2022);
+    std::uniform_int_distribution<int> dist(0, num_rows - 1);
+    std::vector<RowId> result;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_lookups; i++) {
+      std::vector<Field> key_fields = {Field(TypeId::kTypeInt, dist(gen))};
+      Row key(key_fields);
+      result.clear();
+      if (index_info->GetIndex()->ScanKey(key, result, nullptr) == DB_SUCCESS) {
+        Row row(result[0]);
+        table_info->GetTableHeap()->GetTuple(&row, nullptr);
+      }
+    }
+    std::chrono::duration<double> lookup_time = std::chrono::steady_clock::now() - start;
+    start = std::chrono::steady_clock::now();
+    int rows = 0;
+    for (auto iter = table_info->GetTableHeap()->Begin(nullptr); !iter.isNull(); ++iter) {
+      rows++;
+    }
+    std::chrono::duration<double, std::milli> scan_time = std::chrono::steady_clock::now() - start;
+    if (rows != num_rows) {
+      printf("scanned %d rows, expected %d\n", rows, num_rows);
+    }
+    printf("%-8s %12.0f %12.1f %10.1f %10.1f\n", name, num_lookups / lookup_time.count(), scan_time.count(),
+           RssMB() - rss, CachedMB());
+  }
+  remove(db_name.c_str());
+  return 0;
+}
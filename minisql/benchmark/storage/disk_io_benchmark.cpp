@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+#include "storage/disk_manager.h"
+
+/**
+ * Random page reads and writes through the DiskManager (pread/pwrite, file size cached) against the
+ * std::fstream I/O it used before (stat per read, seek and read or write and flush under one mutex).
+ *
+ * The file is small enough to stay in the page cache, so the numbers show the cost of the I/O path rather
+ * than the device, except for the fdatasync of the durability policies. Reads are spread over threads.
+ *
+ * Usage: disk_io_benchmark [num_pages] [num_ops] [num_threads]
+ */
+static const std::string db_name = "disk_io_benchmark.db";
+
+/**
+ * The I/O path of the DiskManager before it used a file descriptor. Page ids are shifted past the meta page
+ * and the first bitmap page like the logical page ids of the first extent, so the file stays valid.
+ */
+class StreamDiskIO {
+public:
+  explicit StreamDiskIO(const std::string &file_name) : file_name_(file_name) {
+    db_io_.open(file_name, std::ios::binary | std::ios::in | std::ios::out);
+  }
+
+  void ReadPage(page_id_t page_id, char *page_data) {
+    std::scoped_lock<std::mutex> lock(latch_);
+    int64_t offset = static_cast<int64_t>(page_id + 2) * PAGE_SIZE;
+    struct stat stat_buf;
+    if (stat(file_name_.c_str(), &stat_buf) != 0 || offset >= stat_buf.st_size) {
+      memset(page_data, 0, PAGE_SIZE);
+      return;
+    }
+    db_io_.seekp(offset);
+    db_io_.read(page_data, PAGE_SIZE);
+  }
+
+  void WritePage(page_id_t page_id, const char *page_data) {
+    std::scoped_lock<std::mutex> lock(latch_);
+    db_io_.seekp(static_cast<int64_t>(page_id + 2) * PAGE_SIZE);
+    db_io_.write(page_data, PAGE_SIZE);
+    db_io_.flush();
+  }
+
+private:
+  std::fstream db_io_;
+  std::string file_name_;
+  std::mutex latch_;
+};
+
+template<typename IO>
+static double RandomReads(IO *io, int num_pages, int num_ops, int num_threads) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([io, num_pages, num_ops, num_threads, t]() {
+      std::mt19937 gen(t);
+      std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+      char data[PAGE_SIZE];
+      for (int i = 0; i < num_ops / num_threads; i++) {
+        io->ReadPage(dist(gen), data);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+  return time.count();
+}
+
+template<typename IO>
+static double RandomWrites(IO *io, int num_pages, int num_ops) {
+  auto start = std::chrono::steady_clock::now();
+  std::mt19937 gen(2022);
+  std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+  char data[PAGE_SIZE];
+  memset(data, 'w', PAGE_SIZE);
+  for (int i = 0; i < num_ops; i++) {
+    io->WritePage(dist(gen), data);
+  }
+  std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+  return time.count();
+}
+
+static void Report(const char *name, const char *op, int num_ops, double seconds) {
+  printf("%-30s %-6s %12.0f %10.2f\n", name, op, num_ops / seconds, seconds * 1e6 / num_ops);
+}
+
+int main(int argc, char **argv) {
+  // pages of the first extent
+  int num_pages = argc > 1 ? std::min<int>(std::stoi(argv[1]), DiskManager::BITMAP_SIZE) : 16384;
+  int num_ops = argc > 2 ? std::stoi(argv[2]) : 200000;
+  int num_threads = argc > 3 ? std::stoi(argv[3]) : 4;
+
+  remove(db_name.c_str());
+  {
+    // lay out the file, so both paths read existing pages
+    DiskManager disk_manager(db_name, DurabilityPolicy::NONE);
+    char data[PAGE_SIZE];
+    memset(data, 'r', PAGE_SIZE);
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      disk_manager.WritePage(page_id, data);
+    }
+  }
+  printf("%-30s %-6s %12s %10s\n", "io", "op", "ops/s", "us/op");
+  {
+    StreamDiskIO stream(db_name);
+    Report("fstream", "read", num_ops, RandomReads(&stream, num_pages, num_ops, num_threads));
+    Report("fstream", "write", num_ops, RandomWrites(&stream, num_pages, num_ops));
+  }
+  for (auto durability : {DurabilityPolicy::NONE, DurabilityPolicy::SYNC_ON_CHECKPOINT,
+                          DurabilityPolicy::SYNC_EVERY_WRITE}) {
+    DiskManager disk_manager(db_name, durability);
+    const char *name = durability == DurabilityPolicy::NONE ? "pread/pwrite, no sync"
+                       : durability == DurabilityPolicy::SYNC_ON_CHECKPOINT ? "pread/pwrite, sync checkpoint"
+                       : "pread/pwrite, sync write";
+    if (durability == DurabilityPolicy::NONE) {
+      Report(name, "read", num_ops, RandomReads(&disk_manager, num_pages, num_ops, num_threads));
+    }
+    // syncing every write is far slower, fewer writes keep the run short
+    int num_writes = durability == DurabilityPolicy::SYNC_EVERY_WRITE ? num_ops / 100 : num_ops;
+    auto start = std::chrono::steady_clock::now();
+    RandomWrites(&disk_manager, num_pages, num_writes);
+    disk_manager.Checkpoint();
+    std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+    Report(name, "write", num_writes, time.count());
+  }
+  remove(db_name.c_str());
+  return 0;
+}
@@ -0,0 +1,26 @@
+#ifndef MINISQL_DROP_CACHE_H
+#define MINISQL_DROP_CACHE_H
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Write a database file back and drop it from the page cache, so the next reads of a benchmark go to the disk.
+ * @param num_tablespaces the tablespace files db_name.1 to db_name.num_tablespaces are dropped too, if they exist
+ */
+inline void DropCache(const std::string &db_name, uint32_t num_tablespaces = 0) {
+  for (uint32_t tablespace_id = 0; tablespace_id <= num_tablespaces; tablespace_id++) {
+    std::string file_name = tablespace_id == 0 ? db_name : db_name + "." + std::to_string(tablespace_id);
+    int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd >= 0) {
+      fdatasync(fd);
+      posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+      close(fd);
+    }
+  }
+}
+
+#endif  // MINISQL_DROP_CACHE_H
@@ -0,0 +1,86 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "common/instance.h"
+#include "record/field.h"
+#include "record/schema.h"
+#include "storage/table_heap.h"
+#include "drop_cache.h"
+
+/**
+ * Two tables loaded at the same time, rows going to both in turn, kept in the database file and with file per object
+ * (a tablespace file per table heap, see DiskManager). Reports a cold full scan of one table and the time to drop
+ * the other one, FreeHeap walking and freeing its page chain against unlinking its file.
+ *
+ * Before the scan the database is reopened with a small pool and its files are dropped from the OS page cache, so
+ * each page really comes from the device.
+ *
+ * Usage: file_per_object_benchmark [num_rows_per_table]
+ */
+static const std::string db_name = "file_per_object_benchmark.db";
+static const uint32_t pool_size = 256;
+static const int row_len = 1800;  // two rows per page
+
+int main(int argc, char **argv) {
+  int num_rows = argc > 1 ? std::stoi(argv[1]) : 8192;
+
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("payload", TypeId::kTypeChar, row_len, 1, false, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  std::string payload(row_len, 'x');
+
+  printf("%-16s %12s %12s %12s\n", "layout", "rows/s", "MB/s", "drop ms");
+  for (bool file_per_object : {false, true}) {
+    page_id_t scanned_page_id;
+    page_id_t dropped_page_id;
+    {
+      // load with a pool holding everything
+      DBStorageEngine engine(db_name, true, 16384);
+      engine.disk_mgr_->SetFilePerObject(file_per_object);
+      TableHeap *scanned = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap,
+                                             DiskManager::TableTablespaceId(0));
+      TableHeap *dropped = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap,
+                                             DiskManager::TableTablespaceId(1));
+      for (int i = 0; i < num_rows; i++) {
+        std::vector<Field> fields = {
+                Field(TypeId::kTypeInt, i),
+                Field(TypeId::kTypeChar, const_cast<char *>(payload.c_str()), row_len, false)
+        };
+        Row row(fields);
+        scanned->InsertTuple(row, nullptr);
+        Row other_row(fields);
+        dropped->InsertTuple(other_row, nullptr);
+      }
+      scanned_page_id = scanned->GetFirstPageId();
+      dropped_page_id = dropped->GetFirstPageId();
+    }
+
+    DropCache(db_name, 2);
+    DBStorageEngine engine(db_name, false, pool_size);
+    TableHeap *table_heap = TableHeap::Create(engine.bpm_, scanned_page_id, schema.get(), nullptr, nullptr, &heap);
+    size_t pages = engine.bpm_->GetMissCount();
+    int rows = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto iter = table_heap->Begin(nullptr); !iter.isNull(); ++iter) {
+      rows++;
+    }
+    std::chrono::duration<double> scan_time = std::chrono::steady_clock::now() - start;
+    pages = engine.bpm_->GetMissCount() - pages;
+
+    DropCache(db_name, 2);
+    TableHeap *dropped = TableHeap::Create(engine.bpm_, dropped_page_id, schema.get(), nullptr, nullptr, &heap);
+    start = std::chrono::steady_clock::now();
+    dropped->FreeHeap();
+    std::chrono::duration<double, std::milli> drop_time = std::chrono::steady_clock::now() - start;
+    printf("%-16s %12.0f %12.1f %12.1f\n", file_per_object ? "file per object" : "database file",
+           rows / scan_time.count(), static_cast<double>(pages) * PAGE_SIZE / scan_time.count() / (1 << 20),
+           drop_time.count());
+  }
+  DiskManager::RemoveFiles(db_name);
+  return 0;
+}
@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "common/instance.h"
+#include "record/field.h"
+#include "record/schema.h"
+#include "storage/table_heap.h"
+
+/**
+ * Insert latency of a table heap as it grows, the free space map finding the page for each row. The rows are
+ * inserted in steps of a tenth of the total, each step reports the mean and the slowest insert and the buffer
+ * pool misses per insert. With the first fit walk of the page chain every insert cost a fetch of every page.
+ *
+ * Usage: insert_benchmark [num_rows] [buffer_pool_size]
+ */
+static const std::string db_name = "insert_benchmark.db";
+static const int payload_len = 100;
+
+int main(int argc, char **argv) {
+  int num_rows = argc > 1 ? std::stoi(argv[1]) : 2000000;
+  uint32_t pool_size = argc > 2 ? std::stoi(argv[2]) : 4096;
+
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("payload", TypeId::kTypeChar, payload_len, 1, false, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  std::string payload(payload_len, 'x');
+
+  DBStorageEngine engine(db_name, true, pool_size);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  int step = std::max(1, num_rows / 10);
+  printf("%12s %10s %12s %12s %14s\n", "rows", "pages", "mean us", "max us", "misses/insert");
+  int pages = 1;
+  page_id_t last_page_id = table_heap->GetFirstPageId();
+  for (int begin = 0; begin < num_rows; begin += step) {
+    int end = std::min(num_rows, begin + step);
+    size_t misses = engine.bpm_->GetMissCount();
+    double max_us = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = begin; i < end; i++) {
+      std::vector<Field> fields = {
+              Field(TypeId::kTypeInt, i),
+              Field(TypeId::kTypeChar, const_cast<char *>(payload.c_str()), payload_len, false)
+      };
+      Row row(fields);
+      auto insert_start = std::chrono::steady_clock::now();
+      table_heap->InsertTuple(row, nullptr);
+      std::chrono::duration<double, std::micro> insert_time = std::chrono::steady_clock::now() - insert_start;
+      max_us = std::max(max_us, insert_time.count());
+      if (row.GetRowId().GetPageId() != last_page_id) {
+        last_page_id = row.GetRowId().GetPageId();
+        pages++;
+      }
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    misses = engine.bpm_->GetMissCount() - misses;
+    printf("%12d %10d %12.2f %12.1f %14.3f\n", end, pages, elapsed.count() / (end - begin), max_us,
+           static_cast<double>(misses) / (end - begin));
+  }
+  remove(db_name.c_str());
+  return 0;
+}
@@ -0,0 +1,104 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/instance.h"
+#include "index/index.h"
+#include "record/field.h"
+#include "record/schema.h"
+#include "storage/table_heap.h"
+
+/**
+ * Point lookups and full scans of a database several times larger than the buffer pool, with the disk manager
+ * reading the file with pread or copying pages out of a mapping of it (DiskIOMode::MMAP).
+ *
+ * The database is loaded once, then reopened in each mode. Every mode gets a warm-up pass first, so the file is
+ * in the page cache, as for a reporting database read all day: the numbers show the cost of a buffer pool miss
+ * served from the page cache.
+ *
+ * Usage: mmap_benchmark [num_rows] [num_lookups] [buffer_pool_size]
+ */
+static const std::string db_name = "mmap_benchmark.db";
+static const int payload_len = 100;
+
+struct Result {
+  double lookup_us_;
+  double scan_ms_;
+  size_t misses_;
+};
+
+static Result Run(DiskIOMode io_mode, int num_rows, int num_lookups, uint32_t pool_size) {
+  DBStorageEngine engine(db_name, false, pool_size, DEFAULT_BUFFER_POOL_INSTANCES, DEFAULT_REPLACER_TYPE, 0,
+                         DEFAULT_DURABILITY_POLICY, io_mode);
+  TableInfo *table_info = nullptr;
+  IndexInfo *index_info = nullptr;
+  engine.catalog_mgr_->GetTable("t", table_info);
+  engine.catalog_mgr_->GetIndex("t", CatalogManager::AutoGenPKIndexName("t"), index_info);
+  std::mt19937 gen(2022);
+  std::uniform_int_distribution<int> dist(0, num_rows - 1);
+  size_t misses = engine.bpm_->GetMissCount();
+  std::vector<RowId> result;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_lookups; i++) {
+    std::vector<Field> key_fields = {Field(TypeId::kTypeInt, dist(gen))};
+    Row key(key_fields);
+    result.clear();
+    if (index_info->GetIndex()->ScanKey(key, result, nullptr) == DB_SUCCESS) {
+      Row row(result[0]);
+      table_info->GetTableHeap()->GetTuple(&row, nullptr);
+    }
+  }
+  std::chrono::duration<double, std::micro> lookup_time = std::chrono::steady_clock::now() - start;
+  start = std::chrono::steady_clock::now();
+  int rows = 0;
+  for (auto iter = table_info->GetTableHeap()->Begin(nullptr); !iter.isNull(); ++iter) {
+    rows++;
+  }
+  std::chrono::duration<double, std::milli> scan_time = std::chrono::steady_clock::now() - start;
+  if (rows != num_rows) {
+    printf("scanned %d rows, expected %d\n", rows, num_rows);
+  }
+  return {lookup_time.count() / num_lookups, scan_time.count(), engine.bpm_->GetMissCount() - misses};
+}
+
+int main(int argc, char **argv) {
+  int num_rows = argc > 1 ? std::stoi(argv[1]) : 100000;
+  int num_lookups = argc > 2 ? std::stoi(argv[2]) : 200000;
+  uint32_t pool_size = argc > 3 ? std::stoi(argv[3]) : 256;
+
+  {
+    // load with a pool holding everything
+    DBStorageEngine engine(db_name, true, 16384);
+    std::vector<Column *> columns = {
+            new Column("id", TypeId::kTypeInt, 0, false, false),
+            new Column("payload", TypeId::kTypeChar, payload_len, 1, false, false)
+    };
+    Schema schema(columns);
+    TableInfo *table_info = nullptr;
+    IndexInfo *index_info = nullptr;
+    engine.catalog_mgr_->CreateTable("t", &schema, nullptr, table_info, {0});
+    engine.catalog_mgr_->CreateIndex("t", CatalogManager::AutoGenPKIndexName("t"), {"id"}, nullptr, index_info);
+    std::string payload(payload_len, 'x');
+    for (int i = 0; i < num_rows; i++) {
+      std::vector<Field> fields = {
+              Field(TypeId::kTypeInt, i),
+              Field(TypeId::kTypeChar, const_cast<char *>(payload.c_str()), payload_len, false)
+      };
+      Row row(fields);
+      engine.catalog_mgr_->Insert(table_info, row, nullptr);
+    }
+  }
+
+  printf("%-8s %12s %12s %10s\n", "mode", "lookup us", "scan ms", "misses");
+  for (auto io_mode : {DiskIOMode::PREAD, DiskIOMode::MMAP}) {
+    // warm up the page cache
+    Run(io_mode, num_rows, num_lookups, pool_size);
+    Result result = Run(io_mode, num_rows, num_lookups, pool_size);
+    printf("%-8s %12.2f %12.1f %10zu\n", io_mode == DiskIOMode::PREAD ? "pread" : "mmap", result.lookup_us_,
+           result.scan_ms_, result.misses_);
+  }
+  remove(db_name.c_str());
+  return 0;
+}
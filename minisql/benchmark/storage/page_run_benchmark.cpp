@@ -0,0 +1,88 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "common/instance.h"
+#include "record/field.h"
+#include "record/schema.h"
+#include "storage/table_heap.h"
+#include "drop_cache.h"
+
+/**
+ * Cold full scan of a table that was loaded at the same time as another one, rows going to both tables in turn,
+ * with the pages of each table taken from runs of contiguous pages (the default) and allocated one at a time.
+ *
+ * One at a time, the pages of the two tables alternate in the file and a scan of one of them reads every other
+ * page. "adjacent" is the share of the page chain of the table where the next page directly follows in the file.
+ * Before the scan the database is reopened with a small pool and the file is dropped from the OS page cache,
+ * so each page really comes from the device.
+ *
+ * Usage: page_run_benchmark [num_rows_per_table]
+ */
+static const std::string db_name = "page_run_benchmark.db";
+static const uint32_t pool_size = 256;
+static const int row_len = 1800;  // two rows per page
+
+int main(int argc, char **argv) {
+  int num_rows = argc > 1 ? std::stoi(argv[1]) : 8192;
+
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("payload", TypeId::kTypeChar, row_len, 1, false, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  std::string payload(row_len, 'x');
+
+  printf("%-10s %10s %12s %12s %10s\n", "runs", "adjacent", "rows/s", "MB/s", "misses");
+  for (bool page_runs : {true, false}) {
+    page_id_t first_page_id;
+    {
+      // load with a pool holding everything
+      DBStorageEngine engine(db_name, true, 16384);
+      if (!page_runs) {
+        engine.disk_mgr_->ConfigurePageRuns(1, 1);
+      }
+      TableHeap *scanned = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+      TableHeap *other = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+      for (int i = 0; i < num_rows; i++) {
+        std::vector<Field> fields = {
+                Field(TypeId::kTypeInt, i),
+                Field(TypeId::kTypeChar, const_cast<char *>(payload.c_str()), row_len, false)
+        };
+        Row row(fields);
+        scanned->InsertTuple(row, nullptr);
+        Row other_row(fields);
+        other->InsertTuple(other_row, nullptr);
+      }
+      first_page_id = scanned->GetFirstPageId();
+    }
+
+    DropCache(db_name);
+    DBStorageEngine engine(db_name, false, pool_size);
+    TableHeap *table_heap = TableHeap::Create(engine.bpm_, first_page_id, schema.get(), nullptr, nullptr, &heap);
+    size_t misses = engine.bpm_->GetMissCount();
+    int rows = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto iter = table_heap->Begin(nullptr); !iter.isNull(); ++iter) {
+      rows++;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    misses = engine.bpm_->GetMissCount() - misses;
+
+    // walk the chain again, the pages are in the OS page cache by now
+    size_t pages = 0;
+    size_t adjacent = 0;
+    for (page_id_t page_id = first_page_id; page_id != INVALID_PAGE_ID; pages++) {
+      ReadPageGuard guard = engine.bpm_->FetchPageRead(page_id);
+      page_id_t next_page_id = TablePage::NextPageIdOf(guard.GetData());
+      adjacent += next_page_id == page_id + 1 ? 1 : 0;
+      page_id = next_page_id;
+    }
+    printf("%-10s %9.1f%% %12.0f %12.1f %10zu\n", page_runs ? "on" : "off", 100.0 * adjacent / pages,
+           rows / elapsed.count(), static_cast<double>(pages) * PAGE_SIZE / elapsed.count() / (1 << 20), misses);
+  }
+  remove(db_name.c_str());
+  return 0;
+}
@@ -0,0 +1,83 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "common/instance.h"
+#include "record/field.h"
+#include "record/schema.h"
+#include "storage/table_heap.h"
+
+/**
+ * Warm full scan of a table heap, every tuple read once: TableIterator, which fetches the page again for every
+ * row, against TableHeap::PageScan, which fetches each page once and yields its tuples as a batch, decoded into
+ * rows or read in place as views. "fetches" counts the pages asked from the buffer pool per page of the heap.
+ *
+ * Usage: page_scan_benchmark [num_rows]
+ */
+static const std::string db_name = "page_scan_benchmark.db";
+static const int payload_len = 100;
+
+int main(int argc, char **argv) {
+  int num_rows = argc > 1 ? std::stoi(argv[1]) : 1000000;
+
+  DBStorageEngine engine(db_name, true, 65536);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("payload", TypeId::kTypeChar, payload_len, 1, false, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  std::string payload(payload_len, 'x');
+  for (int i = 0; i < num_rows; i++) {
+    std::vector<Field> fields = {
+            Field(TypeId::kTypeInt, i),
+            Field(TypeId::kTypeChar, const_cast<char *>(payload.c_str()), payload_len, false)
+    };
+    Row row(fields);
+    table_heap->InsertTuple(row, nullptr);
+  }
+  size_t pages = 0;
+  for (page_id_t page_id = table_heap->GetFirstPageId(); page_id != INVALID_PAGE_ID; pages++) {
+    ReadPageGuard guard = engine.bpm_->FetchPageRead(page_id);
+    page_id = TablePage::NextPageIdOf(guard.GetData());
+  }
+
+  printf("%-10s %12s %12s\n", "scan", "rows/s", "fetches");
+  for (const char *mode : {"iterator", "page rows", "page views"}) {
+    std::string name = mode;
+    size_t fetches = engine.bpm_->GetHitCount() + engine.bpm_->GetMissCount();
+    int rows = 0;
+    int64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    if (name == "iterator") {
+      for (auto iter = table_heap->Begin(nullptr); !iter.isNull(); ++iter) {
+        sum += iter->GetRowId().GetSlotNum();
+        rows++;
+      }
+    } else {
+      TableHeap::PageScan scan(table_heap, nullptr);
+      while (scan.Next()) {
+        for (size_t i = 0; i < scan.GetTupleCount(); i++) {
+          if (name == "page rows") {
+            Row *row = scan.GetRow(i);
+            sum += row->GetRowId().GetSlotNum();
+            delete row;
+          } else {
+            sum += scan.GetView(i).GetRowId().GetSlotNum();
+          }
+          rows++;
+        }
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    fetches = engine.bpm_->GetHitCount() + engine.bpm_->GetMissCount() - fetches;
+    printf("%-10s %12.0f %12.2f\n", mode, rows / elapsed.count(), static_cast<double>(fetches) / pages);
+    if (sum < 0) {
+      printf("overflow\n");
+    }
+  }
+  remove(db_name.c_str());
+  return 0;
+}
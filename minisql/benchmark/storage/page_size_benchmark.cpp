@@ -0,0 +1,97 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/instance.h"
+#include "index/index.h"
+#include "record/field.h"
+#include "record/schema.h"
+#include "storage/table_heap.h"
+
+/**
+ * Point lookups through a B+ tree index and full scans at the page size of this build.
+ *
+ * The buffer pool gets the same number of bytes whatever the page size is and holds the whole
+ * table and index, so the numbers show the cost of the page layout (tree height, slots per page)
+ * rather than the device. Builds with different page sizes are compared run against run:
+ *   for size in 4096 8192 16384 32768; do
+ *     cmake -B build_$size -DMINISQL_PAGE_SIZE=$size && make -C build_$size page_size_benchmark
+ *     build_$size/benchmark/page_size_benchmark
+ *   done
+ *
+ * Usage: page_size_benchmark [num_rows] [num_lookups]
+ */
+static const std::string db_name = "page_size_benchmark.db";
+static const size_t pool_bytes = 16 << 20;
+static const int payload_len = 100;
+
+int main(int argc, char **argv) {
+  int num_rows = argc > 1 ? std::stoi(argv[1]) : 40000;
+  int num_lookups = argc > 2 ? std::stoi(argv[2]) : 200000;
+
+  DBStorageEngine engine(db_name, true, pool_bytes / PAGE_SIZE);
+  std::vector<Column *> columns = {
+          new Column("id", TypeId::kTypeInt, 0, false, false),
+          new Column("payload", TypeId::kTypeChar, payload_len, 1, false, false)
+  };
+  Schema schema(columns);
+  TableInfo *table_info = nullptr;
+  IndexInfo *index_info = nullptr;
+  // id is the primary key, its index is created the way the executor does it
+  engine.catalog_mgr_->CreateTable("t", &schema, nullptr, table_info, {0});
+  engine.catalog_mgr_->CreateIndex("t", CatalogManager::AutoGenPKIndexName("t"), {"id"}, nullptr, index_info);
+
+  std::string payload(payload_len, 'x');
+  auto load_start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_rows; i++) {
+    std::vector<Field> fields = {
+            Field(TypeId::kTypeInt, i),
+            Field(TypeId::kTypeChar, const_cast<char *>(payload.c_str()), payload_len, false)
+    };
+    Row row(fields);
+    engine.catalog_mgr_->Insert(table_info, row, nullptr);
+  }
+  std::chrono::duration<double> load_time = std::chrono::steady_clock::now() - load_start;
+
+  // point lookups: index probe, then the tuple from the heap
+  std::mt19937 gen(2022);
+  std::uniform_int_distribution<int> dist(0, num_rows - 1);
+  size_t fetches = engine.bpm_->GetHitCount() + engine.bpm_->GetMissCount();
+  size_t misses = engine.bpm_->GetMissCount();
+  int found = 0;
+  std::vector<RowId> result;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_lookups; i++) {
+    std::vector<Field> key_fields = {Field(TypeId::kTypeInt, dist(gen))};
+    Row key(key_fields);
+    result.clear();
+    if (index_info->GetIndex()->ScanKey(key, result, nullptr) == DB_SUCCESS) {
+      Row row(result[0]);
+      found += table_info->GetTableHeap()->GetTuple(&row, nullptr);
+    }
+  }
+  std::chrono::duration<double> lookup_time = std::chrono::steady_clock::now() - start;
+  double lookup_fetches =
+          static_cast<double>(engine.bpm_->GetHitCount() + engine.bpm_->GetMissCount() - fetches) / num_lookups;
+  double lookup_misses = static_cast<double>(engine.bpm_->GetMissCount() - misses) / num_lookups;
+
+  // full scan
+  fetches = engine.bpm_->GetHitCount() + engine.bpm_->GetMissCount();
+  int rows = 0;
+  start = std::chrono::steady_clock::now();
+  for (auto iter = table_info->GetTableHeap()->Begin(nullptr); !iter.isNull(); ++iter) {
+    rows++;
+  }
+  std::chrono::duration<double> scan_time = std::chrono::steady_clock::now() - start;
+  size_t scan_fetches = engine.bpm_->GetHitCount() + engine.bpm_->GetMissCount() - fetches;
+
+  printf("page size               %d bytes (%zu frames)\n", PAGE_SIZE, pool_bytes / PAGE_SIZE);
+  printf("load                    %.0f rows/s\n", num_rows / load_time.count());
+  printf("point lookup            %.2f us, %.2f fetches, %.3f misses\n", lookup_time.count() * 1e6 / num_lookups,
+         lookup_fetches, lookup_misses);
+  printf("full scan               %.2f ms, %zu fetches, %d rows\n", scan_time.count() * 1e3, scan_fetches, rows);
+  remove(db_name.c_str());
+  return found == num_lookups && rows == num_rows ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/instance.h"
+#include "record/field.h"
+#include "record/row_view.h"
+#include "record/schema.h"
+#include "storage/table_heap.h"
+
+/**
+ * Warm full scan of a table with a filter, as SELECT * FROM t WHERE score > c runs it: TableHeap::Scan on one
+ * thread against TableHeap::ParallelScan with 1, 2, 4, ... workers up to max_workers (the number of cores by
+ * default), each worker taking its range of the page directory. All pages are in the buffer pool, so the scan is
+ * bound by the work per row.
+ *
+ * Usage: parallel_scan_benchmark [num_rows] [max_workers]
+ */
+static const std::string db_name = "parallel_scan_benchmark.db";
+static const int name_len = 32;
+
+int main(int argc, char **argv) {
+  int num_rows = argc > 1 ? std::stoi(argv[1]) : 2000000;
+
+  DBStorageEngine engine(db_name, true, 65536);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, name_len, 1, false, false),
+          ALLOC_COLUMN(heap)("score", TypeId::kTypeFloat, 2, false, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  for (int i = 0; i < num_rows; i++) {
+    std::string name = "name" + std::to_string(i);
+    std::vector<Field> fields = {
+            Field(TypeId::kTypeInt, i),
+            Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), false),
+            Field(TypeId::kTypeFloat, static_cast<float>(i % 1000))
+    };
+    Row row(fields);
+    table_heap->InsertTuple(row, nullptr);
+  }
+  Field bound(TypeId::kTypeFloat, 500.0f);
+  size_t cores = std::max(1u, std::thread::hardware_concurrency());
+  size_t max_workers = argc > 2 ? std::stoul(argv[2]) : cores;
+  printf("%zu pages, %zu cores\n", table_heap->GetPageIds().size(), cores);
+
+  printf("%-8s %12s %12s\n", "workers", "rows/s", "selected");
+  std::vector<size_t> worker_counts = {0};
+  for (size_t workers = 1; workers < max_workers; workers *= 2) {
+    worker_counts.push_back(workers);
+  }
+  worker_counts.push_back(max_workers);
+  for (size_t workers : worker_counts) {
+    std::vector<size_t> selected(std::max<size_t>(1, workers), 0);
+    auto start = std::chrono::steady_clock::now();
+    if (workers == 0) {
+      table_heap->Scan([&](const RowView &row) {
+        if (row.GetField(2).CompareGreaterThan(bound) == kTrue) {
+          selected[0]++;
+        }
+      }, nullptr);
+    } else {
+      table_heap->ParallelScan(workers, [&](size_t worker, const RowView &row) {
+        if (row.GetField(2).CompareGreaterThan(bound) == kTrue) {
+          selected[worker]++;
+        }
+      }, nullptr);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    size_t total = 0;
+    for (size_t count : selected) {
+      total += count;
+    }
+    std::string name = workers == 0 ? "scan" : std::to_string(workers);
+    printf("%-8s %12.0f %12zu\n", name.c_str(), num_rows / elapsed.count(), total);
+  }
+  remove(db_name.c_str());
+  return 0;
+}
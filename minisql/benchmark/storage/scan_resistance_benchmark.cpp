@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_access_strategy.h"
+#include "common/instance.h"
+#include "index/index.h"
+#include "record/field.h"
+#include "record/schema.h"
+#include "storage/table_heap.h"
+
+/**
+ * Point select latency while a large table is scanned, with and without a ring access strategy.
+ *
+ * A small table with a primary key index is the working set of the point selects, it fits in the buffer
+ * pool with room to spare. A second table is several times the buffer pool. The full scan and the point
+ * selects interleave in one thread, one select every select_every scanned rows, so the numbers show what
+ * the scan does to the buffer pool rather than thread scheduling.
+ *
+ * Usage: scan_resistance_benchmark [big_table_pages] [select_every]
+ */
+static const std::string db_name = "scan_resistance_benchmark.db";
+static const uint32_t pool_size = 512;
+static const int hot_rows = 5000;
+static const int hot_payload_len = 100;
+static const int big_row_len = 3000;  // one row per page
+
+struct Latencies {
+  std::vector<double> us_;
+  size_t misses_{0};
+};
+
+static double Percentile(std::vector<double> &values, double p) {
+  if (values.empty()) {
+    return 0;
+  }
+  size_t k = std::min(values.size() - 1, static_cast<size_t>(p * values.size()));
+  std::nth_element(values.begin(), values.begin() + k, values.end());
+  return values[k];
+}
+
+static double PointSelect(IndexInfo *index_info, TableHeap *heap, int key) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<Field> key_fields = {Field(TypeId::kTypeInt, key)};
+  Row key_row(key_fields);
+  std::vector<RowId> result;
+  if (index_info->GetIndex()->ScanKey(key_row, result, nullptr) == DB_SUCCESS) {
+    Row row(result[0]);
+    heap->GetTuple(&row, nullptr);
+  }
+  std::chrono::duration<double, std::micro> time = std::chrono::steady_clock::now() - start;
+  return time.count();
+}
+
+int main(int argc, char **argv) {
+  int big_pages = argc > 1 ? std::stoi(argv[1]) : 4 * static_cast<int>(pool_size);
+  int select_every = argc > 2 ? std::stoi(argv[2]) : 4;
+
+  // load with a pool holding everything, then shrink it
+  DBStorageEngine engine(db_name, true, big_pages + 2 * pool_size, DEFAULT_BUFFER_POOL_INSTANCES,
+                         DEFAULT_REPLACER_TYPE);
+  std::vector<Column *> hot_columns = {
+          new Column("id", TypeId::kTypeInt, 0, false, false),
+          new Column("payload", TypeId::kTypeChar, hot_payload_len, 1, false, false)
+  };
+  Schema hot_schema(hot_columns);
+  TableInfo *hot_table = nullptr;
+  IndexInfo *hot_index = nullptr;
+  engine.catalog_mgr_->CreateTable("hot", &hot_schema, nullptr, hot_table, {0});
+  engine.catalog_mgr_->CreateIndex("hot", CatalogManager::AutoGenPKIndexName("hot"), {"id"}, nullptr, hot_index);
+  std::string payload(hot_payload_len, 'h');
+  for (int i = 0; i < hot_rows; i++) {
+    std::vector<Field> fields = {
+            Field(TypeId::kTypeInt, i),
+            Field(TypeId::kTypeChar, const_cast<char *>(payload.c_str()), hot_payload_len, false)
+    };
+    Row row(fields);
+    engine.catalog_mgr_->Insert(hot_table, row, nullptr);
+  }
+  std::vector<Column *> big_columns = {
+          new Column("id", TypeId::kTypeInt, 0, false, false),
+          new Column("payload", TypeId::kTypeChar, big_row_len, 1, false, false)
+  };
+  Schema big_schema(big_columns);
+  SimpleMemHeap heap;
+  TableHeap *big = TableHeap::Create(engine.bpm_, &big_schema, nullptr, nullptr, nullptr, &heap);
+  std::string big_payload(big_row_len, 'b');
+  for (int i = 0; i < big_pages; i++) {
+    std::vector<Field> fields = {
+            Field(TypeId::kTypeInt, i),
+            Field(TypeId::kTypeChar, const_cast<char *>(big_payload.c_str()), big_row_len, false)
+    };
+    Row row(fields);
+    big->InsertTuple(row, nullptr);
+  }
+  engine.bpm_->FlushAllPages();
+  if (!engine.bpm_->Resize(pool_size)) {
+    printf("failed to shrink the buffer pool to %u frames\n", pool_size);
+    return 1;
+  }
+  // warm up the working set of the point selects
+  TableHeap *hot_heap = hot_table->GetTableHeap();
+  for (int i = 0; i < hot_rows; i++) {
+    PointSelect(hot_index, hot_heap, i);
+  }
+
+  std::mt19937 gen(2022);
+  std::uniform_int_distribution<int> dist(0, hot_rows - 1);
+  printf("%-20s %10s %10s %10s %10s %12s %10s\n", "scan", "p50 us", "p99 us", "max us", "selects", "sel misses",
+         "scan ms");
+  for (int mode = 0; mode < 3; mode++) {
+    const char *name = mode == 0 ? "no scan" : mode == 1 ? "scan, shared pool" : "scan, ring";
+    Latencies latencies;
+    std::shared_ptr<BufferAccessStrategy> strategy =
+            mode == 2 ? std::make_shared<BufferAccessStrategy>() : nullptr;
+    auto start = std::chrono::steady_clock::now();
+    int scanned = 0;
+    auto iter = big->Begin(nullptr, strategy);
+    for (int i = 0; i < big_pages; i++) {
+      if (mode > 0) {
+        if (iter.isNull()) {
+          break;
+        }
+        ++iter;
+      }
+      if (++scanned % select_every != 0) {
+        continue;
+      }
+      size_t misses = engine.bpm_->GetMissCount();
+      latencies.us_.push_back(PointSelect(hot_index, hot_heap, dist(gen)));
+      latencies.misses_ += engine.bpm_->GetMissCount() - misses;
+    }
+    std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+    size_t selects = latencies.us_.size();
+    double p50 = Percentile(latencies.us_, 0.50);
+    double p99 = Percentile(latencies.us_, 0.99);
+    double max = Percentile(latencies.us_, 1.0);
+    printf("%-20s %10.2f %10.2f %10.2f %10zu %12zu %10.1f\n", name, p50, p99, max, selects, latencies.misses_,
+           mode > 0 ? time.count() : 0.0);
+    // the working set is back in the pool before the next mode
+    for (int i = 0; i < hot_rows; i++) {
+      PointSelect(hot_index, hot_heap, i);
+    }
+  }
+  remove(db_name.c_str());
+  return 0;
+}
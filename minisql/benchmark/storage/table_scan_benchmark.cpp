@@ -0,0 +1,70 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "common/instance.h"
+#include "record/field.h"
+#include "record/schema.h"
+#include "storage/table_heap.h"
+#include "drop_cache.h"
+
+/**
+ * Cold full scans of a table heap with different read-ahead distances.
+ *
+ * The table is about 16 times the buffer pool. Before every scan the pool is flushed and the
+ * file is dropped from the OS page cache, so each page really comes from the device.
+ *
+ * Usage: table_scan_benchmark [num_rows]
+ */
+static const std::string db_name = "table_scan_benchmark.db";
+static const uint32_t pool_size = 256;
+static const int row_len = 1800;  // two rows per page
+
+// write back everything and evict the file from the OS page cache
+static void DropCaches(DBStorageEngine &engine) {
+  engine.bpm_->FlushAllPages();
+  DropCache(db_name);
+}
+
+int main(int argc, char **argv) {
+  int num_rows = argc > 1 ? std::stoi(argv[1]) : 8192;
+
+  DBStorageEngine engine(db_name, true, pool_size);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("payload", TypeId::kTypeChar, row_len, 1, false, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  std::string payload(row_len, 'x');
+  for (int i = 0; i < num_rows; i++) {
+    std::vector<Field> fields = {
+            Field(TypeId::kTypeInt, i),
+            Field(TypeId::kTypeChar, const_cast<char *>(payload.c_str()), row_len, false)
+    };
+    Row row(fields);
+    table_heap->InsertTuple(row, nullptr);
+  }
+
+  printf("%-10s %12s %12s %10s %10s\n", "distance", "rows/s", "MB/s", "misses", "prefetched");
+  for (size_t distance : {0, 2, 8, 32}) {
+    DropCaches(engine);
+    table_heap->SetPrefetchDistance(distance);
+    size_t misses = engine.bpm_->GetMissCount();
+    size_t prefetched = engine.bpm_->GetPrefetchCount();
+    int rows = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto iter = table_heap->Begin(nullptr); !iter.isNull(); ++iter) {
+      rows++;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double pages = static_cast<double>(rows) / 2;
+    printf("%-10zu %12.0f %12.1f %10zu %10zu\n", distance, rows / elapsed.count(),
+           pages * PAGE_SIZE / elapsed.count() / (1 << 20), engine.bpm_->GetMissCount() - misses,
+           engine.bpm_->GetPrefetchCount() - prefetched);
+  }
+  remove(db_name.c_str());
+  return 0;
+}
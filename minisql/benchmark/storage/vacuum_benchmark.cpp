@@ -0,0 +1,110 @@
+#include <sys/stat.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "common/instance.h"
+#include "record/field.h"
+#include "record/schema.h"
+#include "drop_cache.h"
+
+/**
+ * Cold full scan of a table after most of its rows were deleted, before and after CatalogManager::Vacuum. The table
+ * has a primary key index and a file of its own (file per object), so "file MB" is the size of the table heap on
+ * disk.
+ *
+ * Rows are deleted spread over the whole table, every page keeps some of them and the scan still reads them all.
+ * Before each scan the database is reopened with a small pool and its files are dropped from the OS page cache, so
+ * each page really comes from the device.
+ *
+ * Usage: vacuum_benchmark [num_rows] [percent_deleted]
+ */
+static const std::string db_name = "vacuum_benchmark.db";
+static const std::string table_file = db_name + "." + std::to_string(DiskManager::TableTablespaceId(0));
+static const uint32_t pool_size = 256;
+static const int payload_len = 200;
+
+static double FileMB() {
+  struct stat stat_buf;
+  if (stat(table_file.c_str(), &stat_buf) != 0) {
+    return 0;
+  }
+  return static_cast<double>(stat_buf.st_size) / (1 << 20);
+}
+
+// reopens the database and scans the table cold
+static void Scan(const char *name, size_t pages) {
+  DropCache(db_name, 2);
+  DBStorageEngine engine(db_name, false, pool_size);
+  TableInfo *table_info = nullptr;
+  engine.catalog_mgr_->GetTable("t", table_info);
+  size_t misses = engine.bpm_->GetMissCount();
+  int rows = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (auto iter = table_info->GetTableHeap()->Begin(nullptr); !iter.isNull(); ++iter) {
+    rows++;
+  }
+  std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+  misses = engine.bpm_->GetMissCount() - misses;
+  printf("%-8s %10d %10zu %10.2f %10zu %12.1f\n", name, rows, pages, FileMB(), misses, elapsed.count());
+}
+
+int main(int argc, char **argv) {
+  int num_rows = argc > 1 ? std::stoi(argv[1]) : 16384;
+  int percent_deleted = argc > 2 ? std::stoi(argv[2]) : 90;
+
+  size_t pages_before = 0;
+  {
+    // load with a pool holding everything
+    DBStorageEngine engine(db_name, true, 16384, DEFAULT_BUFFER_POOL_INSTANCES, DEFAULT_REPLACER_TYPE, 0,
+                           DEFAULT_DURABILITY_POLICY, DEFAULT_DISK_IO_MODE, true);
+    std::vector<Column *> columns = {
+            new Column("id", TypeId::kTypeInt, 0, false, false),
+            new Column("payload", TypeId::kTypeChar, payload_len, 1, false, false)
+    };
+    Schema schema(columns);
+    TableInfo *table_info = nullptr;
+    IndexInfo *index_info = nullptr;
+    engine.catalog_mgr_->CreateTable("t", &schema, nullptr, table_info, {0});
+    engine.catalog_mgr_->CreateIndex("t", CatalogManager::AutoGenPKIndexName("t"), {"id"}, nullptr, index_info);
+    std::string payload(payload_len, 'x');
+    std::vector<Row> deleted;
+    for (int i = 0; i < num_rows; i++) {
+      std::vector<Field> fields = {
+              Field(TypeId::kTypeInt, i),
+              Field(TypeId::kTypeChar, const_cast<char *>(payload.c_str()), payload_len, false)
+      };
+      Row row(fields);
+      engine.catalog_mgr_->Insert(table_info, row, nullptr);
+      if (i % 100 < percent_deleted) {
+        deleted.push_back(row);
+      }
+    }
+    for (auto &row : deleted) {
+      engine.catalog_mgr_->Delete(table_info, row, nullptr);
+    }
+    page_id_t page_id = table_info->GetTableHeap()->GetFirstPageId();
+    for (; page_id != INVALID_PAGE_ID; pages_before++) {
+      ReadPageGuard guard = engine.bpm_->FetchPageRead(page_id);
+      page_id = TablePage::NextPageIdOf(guard.GetData());
+    }
+  }
+
+  printf("%-8s %10s %10s %10s %10s %12s\n", "vacuum", "rows", "pages", "file MB", "misses", "scan ms");
+  Scan("before", pages_before);
+  VacuumStats stats;
+  std::chrono::duration<double, std::milli> vacuum_time{};
+  {
+    DBStorageEngine engine(db_name, false, 16384);
+    auto start = std::chrono::steady_clock::now();
+    engine.catalog_mgr_->Vacuum("t", nullptr, &stats);
+    vacuum_time = std::chrono::steady_clock::now() - start;
+  }
+  Scan("after", stats.pages_after_);
+  printf("vacuum moved %zu rows in %.1f ms, %zu pages returned to the file system\n", stats.rows_moved_,
+         vacuum_time.count(), stats.pages_truncated_);
+  DiskManager::RemoveFiles(db_name);
+  return 0;
+}
@@ -0,0 +1,29 @@
+#include "buffer/buffer_access_strategy.h"
+
+BufferAccessStrategy::BufferAccessStrategy(size_t ring_size)
+        : ring_(ring_size > 0 ? ring_size : 1, Slot{nullptr, INVALID_FRAME_ID, INVALID_PAGE_ID}) {}
+
+size_t BufferAccessStrategy::GetReuseCount() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return reuse_count_;
+}
+
+bool BufferAccessStrategy::Current(const BufferPoolManager *bpm, frame_id_t *frame_id, page_id_t *page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  Slot &slot = ring_[current_];
+  if (slot.bpm_ != bpm) {
+    return false;
+  }
+  *frame_id = slot.frame_id_;
+  *page_id = slot.page_id_;
+  return true;
+}
+
+void BufferAccessStrategy::Put(const BufferPoolManager *bpm, frame_id_t frame_id, page_id_t page_id, bool recycled) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  ring_[current_] = {bpm, frame_id, page_id};
+  current_ = (current_ + 1) % ring_.size();
+  if (recycled) {
+    reuse_count_++;
+  }
+}
@@ -0,0 +1,232 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include "buffer/buffer_pool_budget.h"
+#include "glog/logging.h"
+
+BufferPoolBudget::BufferPoolBudget(size_t budget_frames, size_t min_pool_size)
+        : budget_(budget_frames), min_pool_size_(min_pool_size) {}
+
+BufferPoolBudget::~BufferPoolBudget() {
+  StopAutoTuning();
+}
+
+size_t BufferPoolBudget::DetectBudget() {
+  // cgroup v2, then cgroup v1
+  for (const char *path : {"/sys/fs/cgroup/memory.max", "/sys/fs/cgroup/memory/memory.limit_in_bytes"}) {
+    std::ifstream in(path);
+    std::string value;
+    if (!(in >> value)) {
+      continue;
+    }
+    unsigned long long limit = std::strtoull(value.c_str(), nullptr, 10);
+    // "max" in v2, a huge number in v1 when there is no limit
+    if (value == "max" || limit == 0 || limit >= (1ULL << 60)) {
+      break;
+    }
+    return std::max<size_t>(limit / BUFFER_POOL_CGROUP_SHARE / PAGE_SIZE, MIN_BUFFER_POOL_SIZE);
+  }
+  return DEFAULT_BUFFER_POOL_BUDGET;
+}
+
+size_t BufferPoolBudget::InitialPoolSize() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  size_t used = UsedFrames();
+  size_t spare = budget_ > used ? budget_ - used : 0;
+  return std::min(budget_, std::max(min_pool_size_, std::min<size_t>(spare, DEFAULT_BUFFER_POOL_SIZE)));
+}
+
+void BufferPoolBudget::Register(BufferPoolManager *bpm) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (FindPool(bpm) != nullptr) {
+    return;
+  }
+  std::vector<PoolState *> donors;
+  for (auto &pool : pools_) {
+    if (!pool.fixed_) {
+      donors.push_back(&pool);
+    }
+  }
+  size_t used = UsedFrames() + bpm->GetPoolSize();
+  if (used > budget_ && Reclaim(used - budget_, donors, 1.0) < used - budget_) {
+    LOG(WARNING) << "Buffer pools hold " << UsedFrames() + bpm->GetPoolSize() << " frames, over the budget of "
+                 << budget_ << " frames.";
+  }
+  pools_.push_back({bpm, false, bpm->GetHitCount(), bpm->GetMissCount()});
+}
+
+void BufferPoolBudget::Unregister(BufferPoolManager *bpm) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto registered = [bpm](const PoolState &pool) { return pool.bpm_ == bpm; };
+  pools_.erase(std::remove_if(pools_.begin(), pools_.end(), registered), pools_.end());
+}
+
+bool BufferPoolBudget::SetPoolSize(BufferPoolManager *bpm, size_t pool_size) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  PoolState *state = FindPool(bpm);
+  if (state == nullptr) {
+    return false;
+  }
+  if (pool_size == 0) {
+    state->fixed_ = false;
+    return true;
+  }
+  if (pool_size > bpm->GetMaxPoolSize()) {
+    return false;
+  }
+  size_t pool_used = bpm->GetPoolSize();
+  if (pool_size > pool_used) {
+    size_t needed = pool_size - pool_used;
+    size_t used = UsedFrames();
+    size_t spare = budget_ > used ? budget_ - used : 0;
+    if (spare < needed) {
+      std::vector<PoolState *> donors;
+      size_t reclaimable = 0;
+      for (auto &pool : pools_) {
+        if (!pool.fixed_ && pool.bpm_ != bpm) {
+          donors.push_back(&pool);
+          reclaimable += pool.bpm_->GetPoolSize() - std::min(pool.bpm_->GetPoolSize(), min_pool_size_);
+        }
+      }
+      // do not shrink the other pools for nothing
+      if (spare + reclaimable < needed) {
+        return false;
+      }
+      spare += Reclaim(needed - spare, donors, 1.0);
+    }
+    if (spare < needed) {
+      return false;
+    }
+  }
+  if (!bpm->Resize(pool_size)) {
+    return false;
+  }
+  state->fixed_ = true;
+  return true;
+}
+
+size_t BufferPoolBudget::Rebalance() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  std::vector<PoolState *> needy;
+  std::vector<PoolState *> donors;
+  for (auto &pool : pools_) {
+    size_t hits = pool.bpm_->GetHitCount();
+    size_t misses = pool.bpm_->GetMissCount();
+    size_t new_hits = hits - pool.last_hits_;
+    size_t new_misses = misses - pool.last_misses_;
+    pool.last_hits_ = hits;
+    pool.last_misses_ = misses;
+    if (pool.fixed_) {
+      continue;
+    }
+    if (new_misses > 0 && new_hits < BUFFER_POOL_GROW_HIT_RATIO * (new_hits + new_misses)) {
+      if (pool.bpm_->GetPoolSize() < pool.bpm_->GetMaxPoolSize()) {
+        needy.push_back(&pool);
+      }
+    } else {
+      // hits often enough, or was idle
+      donors.push_back(&pool);
+    }
+  }
+  size_t grown = 0;
+  for (auto pool : needy) {
+    size_t pool_size = pool->bpm_->GetPoolSize();
+    // grow by a quarter at a time
+    size_t wanted = std::min(std::max(pool_size / 4, min_pool_size_), pool->bpm_->GetMaxPoolSize() - pool_size);
+    size_t used = UsedFrames();
+    size_t spare = budget_ > used ? budget_ - used : 0;
+    if (spare < wanted) {
+      spare += Reclaim(wanted - spare, donors, 0.25);
+    }
+    size_t granted = std::min(wanted, spare);
+    if (granted > 0 && pool->bpm_->Resize(pool_size + granted)) {
+      grown++;
+    }
+  }
+  return grown;
+}
+
+void BufferPoolBudget::StartAutoTuning(uint32_t interval_ms) {
+  if (tuner_.joinable()) {
+    return;
+  }
+  {
+    std::scoped_lock<std::mutex> lock(tuner_mutex_);
+    tuner_stop_ = false;
+  }
+  tuner_ = std::thread(&BufferPoolBudget::AutoTuningLoop, this, interval_ms);
+}
+
+void BufferPoolBudget::StopAutoTuning() {
+  {
+    std::scoped_lock<std::mutex> lock(tuner_mutex_);
+    tuner_stop_ = true;
+  }
+  tuner_cv_.notify_all();
+  if (tuner_.joinable()) {
+    tuner_.join();
+  }
+}
+
+size_t BufferPoolBudget::GetUsed() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return UsedFrames();
+}
+
+size_t BufferPoolBudget::UsedFrames() const {
+  size_t used = 0;
+  for (auto &pool : pools_) {
+    used += pool.bpm_->GetPoolSize();
+  }
+  return used;
+}
+
+BufferPoolBudget::PoolState *BufferPoolBudget::FindPool(BufferPoolManager *bpm) {
+  for (auto &pool : pools_) {
+    if (pool.bpm_ == bpm) {
+      return &pool;
+    }
+  }
+  return nullptr;
+}
+
+size_t BufferPoolBudget::Reclaim(size_t frames, std::vector<PoolState *> donors, double max_share) {
+  std::sort(donors.begin(), donors.end(), [](PoolState *a, PoolState *b) {
+    return a->bpm_->GetPoolSize() > b->bpm_->GetPoolSize();
+  });
+  size_t freed = 0;
+  for (auto pool : donors) {
+    if (freed >= frames) {
+      break;
+    }
+    size_t pool_size = pool->bpm_->GetPoolSize();
+    if (pool_size <= min_pool_size_) {
+      continue;
+    }
+    size_t take = std::min({frames - freed, pool_size - min_pool_size_,
+                            std::max<size_t>(1, static_cast<size_t>(pool_size * max_share))});
+    // the frames at the end of the pool may be pinned, try taking fewer
+    while (take > 0 && !pool->bpm_->Resize(pool_size - take)) {
+      take /= 2;
+    }
+    // a sharded pool rounds the size down to a multiple of the number of shards
+    freed += pool_size - pool->bpm_->GetPoolSize();
+  }
+  return freed;
+}
+
+void BufferPoolBudget::AutoTuningLoop(uint32_t interval_ms) {
+  std::unique_lock<std::mutex> lock(tuner_mutex_);
+  while (!tuner_stop_) {
+    tuner_cv_.wait_for(lock, std::chrono::milliseconds(interval_ms));
+    if (tuner_stop_) {
+      break;
+    }
+    lock.unlock();
+    Rebalance();
+    lock.lock();
+  }
+}
@@ -1,32 +1,65 @@
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "glog/logging.h"
 #include "page/bitmap_page.h"
 
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
 
-BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager)
-        : pool_size_(pool_size), disk_manager_(disk_manager) {
-  pages_ = new Page[pool_size_];
-  #ifdef USING_CLOCK_REPLACER
-    replacer_ = new ClockReplacer(pool_size_);
-  #else
-    replacer_ = new LRUReplacer(pool_size_);
-  #endif
+BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, ReplacerType replacer_type,
+                                     size_t max_pool_size)
+        : pool_size_(pool_size), max_pool_size_(MAX(pool_size, max_pool_size)), arena_(max_pool_size_),
+          disk_manager_(disk_manager), page_table_(pool_size_) {
+  // frame metadata in one array, the data of frame i is in the arena. Like the arena, the array only reserves
+  // the address space of max_pool_size_ frames, so the metadata of a frame takes memory once the pool grows to
+  // it and the Page of a pinned frame never moves.
+  void *mapping = mmap(nullptr, max_pool_size_ * sizeof(Page), PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  ASSERT(mapping != MAP_FAILED, "Failed to map the buffer pool frame metadata.");
+  pages_ = static_cast<Page *>(mapping);
+  GrowFrames(pool_size_);
+  switch (replacer_type) {
+    case ReplacerType::LRU_REPLACER:
+      replacer_ = new LRUReplacer(pool_size_);
+      break;
+    case ReplacerType::LRU_K_REPLACER:
+      replacer_ = new LRUKReplacer(pool_size_);
+      break;
+    case ReplacerType::CLOCK_REPLACER:
+    default:
+      replacer_ = new ClockReplacer(pool_size_);
+      break;
+  }
   for (size_t i = 0; i < pool_size_; i++) {
     free_list_.emplace_back(i);
   }
 }
 
+BufferPoolManager::BufferPoolManager(DiskManager *disk_manager)
+        : pool_size_(0), max_pool_size_(0), arena_(0), pages_(nullptr), disk_manager_(disk_manager), page_table_(0),
+          replacer_(nullptr) {}
+
 BufferPoolManager::~BufferPoolManager() {
-  for (auto page: page_table_) {
-    FlushPage(page.first);
+  StopPrefetcher();
+  StopBackgroundWriter();
+  FlushAllPages();
+  for (size_t i = 0; i < num_frames_; i++) {
+    pages_[i].~Page();
+  }
+  if (pages_ != nullptr) {
+    munmap(pages_, max_pool_size_ * sizeof(Page));
   }
-  delete[] pages_;
+
   delete replacer_;
 }
 
 // Remember to UNPIN after using this method!
-Page *BufferPoolManager::FetchPage(page_id_t page_id) {
+Page *BufferPoolManager::FetchPage(page_id_t page_id, BufferAccessStrategy *strategy) {
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
   // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
@@ -35,76 +68,73 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id) {
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
 
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   // 1.     Search the page table for the requested page (P).
-  try
-  { // P exist
-    frame_id_t P_frame_id = page_table_.at(page_id); // may throw err out_of_range
-    pages_[P_frame_id].pin_count_++;
-    replacer_->Pin(P_frame_id);
-    return &pages_[P_frame_id];
-  }
-  catch(const std::out_of_range& e)
-  { // P not exist
-
-    // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
-    frame_id_t frame_id; // the Page R's index in the BufferPool's pages_ array
-    if (!free_list_.empty()) {
-      frame_id = free_list_.front();
-      free_list_.pop_front();
-    } else {
-      if (!replacer_->Victim(&frame_id)) {
-        // LOG(ERROR) << "No free page available"; // for debug
-        return nullptr;
-      }
-    }
+  frame_id_t frame_id;
+  if (page_table_.Find(page_id, &frame_id)) {
+    // 1.1    If P exists, pin it and return it immediately.
+    pages_[frame_id].pin_count_++;
+    replacer_->Pin(frame_id);
+    replacer_->RecordAccess(frame_id);
+    hit_count_++;
+    return &pages_[frame_id];
+  }
+  miss_count_++;
 
-    // 2.     If R is dirty, write it back to the disk.
-    page_id_t R_page_id = pages_[frame_id].GetPageId();
-    if (pages_[frame_id].IsDirty()) 
-      FlushPage(R_page_id);
+  // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
+  // 2.     If R is dirty, write it back to the disk.
+  // A bulk operation recycles the frames of its ring first.
+  bool recycled = strategy != nullptr && AcquireRingFrame(strategy, &frame_id);
+  if (!recycled && !AcquireFrame(&frame_id)) {
+    // LOG(ERROR) << "No free page available"; // for debug
+    return nullptr;
+  }
 
-    // 3.     Delete R from the page table and insert P.
-    page_table_.erase(R_page_id);
-    page_table_[page_id] = frame_id;
+  // 3.     Delete R from the page table and insert P.
+  page_table_.Insert(page_id, frame_id);
 
-    // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
-    Page *P = &pages_[frame_id];
-    // update metadata
-    P->page_id_ = page_id;
-    P->pin_count_ = 1;
-    P->is_dirty_ = false;
-    // read in page content
-    disk_manager_->ReadPage(page_id, P->GetData());
-    return P;
+  // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
+  Page *P = &pages_[frame_id];
+  // update metadata
+  P->page_id_ = page_id;
+  P->pin_count_ = 1;
+  P->is_dirty_ = false;
+  replacer_->RecordAccess(frame_id);
+  // read in page content
+  disk_manager_->ReadPage(page_id, P->GetData());
+  if (strategy != nullptr) {
+    strategy->Put(this, frame_id, page_id, recycled);
   }
+  return P;
 }
 
 // return nullptr if failed
 // Remember to UNPIN after using this method!
-Page *BufferPoolManager::NewPage(page_id_t &page_id) {
+Page *BufferPoolManager::NewPage(page_id_t &page_id, BufferAccessStrategy *strategy) {
   // 0.   Make sure you call AllocatePage!
   // 1.   If all the pages in the buffer pool are pinned, return nullptr.
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
 
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
   frame_id_t frame_id; // the Page's index in the BufferPool's pages_ array
-  if (!free_list_.empty()) {
-    frame_id = free_list_.front();
-    free_list_.pop_front();
-  } else {
-    if (!replacer_->Victim(&frame_id)) {
-      // 1.   If all the pages in the buffer pool are pinned, return nullptr.
-      return nullptr;
-    }
-    // Important: remove the Victim from the page table
-    page_table_.erase(pages_[frame_id].GetPageId());
+  bool recycled = strategy != nullptr && AcquireRingFrame(strategy, &frame_id);
+  if (!recycled && !AcquireFrame(&frame_id)) {
+    // 1.   If all the pages in the buffer pool are pinned, return nullptr.
+    return nullptr;
   }
 
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   page_id_t P_page_id = AllocatePage();
   Page *P = &pages_[frame_id];
+  if (P_page_id == INVALID_PAGE_ID) {
+    // the database file is full
+    P->page_id_ = INVALID_PAGE_ID;
+    free_list_.push_back(frame_id);
+    return nullptr;
+  }
   // Update P's metadata
   P->page_id_ = P_page_id;
   P->pin_count_ = 1;
@@ -112,13 +142,135 @@ Page *BufferPoolManager::NewPage(page_id_t &page_id) {
   // Zero out memory
   P->ResetMemory();
   // Add P to the page table
-  page_table_[P_page_id] = frame_id;
+  page_table_.Insert(P_page_id, frame_id);
+  replacer_->RecordAccess(frame_id);
+  if (strategy != nullptr) {
+    strategy->Put(this, frame_id, P_page_id, recycled);
+  }
 
   // 4.   Set the page ID output parameter. Return a pointer to P.
   page_id = P_page_id;
   return P;
 }
 
+// the page must already be allocated on disk, e.g. by ParallelBufferPoolManager::NewPage
+Page *BufferPoolManager::NewPageWithId(page_id_t page_id, BufferAccessStrategy *strategy) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
+  frame_id_t frame_id;
+  bool recycled = strategy != nullptr && AcquireRingFrame(strategy, &frame_id);
+  if (!recycled && !AcquireFrame(&frame_id)) {
+    return nullptr;
+  }
+  Page *P = &pages_[frame_id];
+  P->page_id_ = page_id;
+  P->pin_count_ = 1;
+  P->is_dirty_ = true;
+  P->ResetMemory();
+  page_table_.Insert(page_id, frame_id);
+  replacer_->RecordAccess(frame_id);
+  if (strategy != nullptr) {
+    strategy->Put(this, frame_id, page_id, recycled);
+  }
+  return P;
+}
+
+Page *BufferPoolManager::NewPageFor(const void *owner, page_id_t &page_id, BufferAccessStrategy *strategy) {
+  page_id_t new_page_id = disk_manager_->AllocatePage(owner);
+  if (new_page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  Page *page = NewPageWithId(new_page_id, strategy);
+  if (page == nullptr) {
+    disk_manager_->DeAllocatePage(new_page_id);
+    return nullptr;
+  }
+  page_id = new_page_id;
+  return page;
+}
+
+bool BufferPoolManager::NewPages(size_t count, std::vector<Page *> &pages, BufferAccessStrategy *strategy) {
+  pages.clear();
+  page_id_t first_page_id = disk_manager_->AllocateRun(count);
+  if (first_page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  for (size_t i = 0; i < count; i++) {
+    Page *page = NewPageWithId(first_page_id + i, strategy);
+    if (page != nullptr) {
+      pages.push_back(page);
+      continue;
+    }
+    // the pool is full of pinned pages, take back the whole run
+    for (Page *new_page : pages) {
+      page_id_t new_page_id = new_page->GetPageId();
+      UnpinPage(new_page_id, false);
+      DeletePage(new_page_id);
+    }
+    for (size_t j = i; j < count; j++) {
+      disk_manager_->DeAllocatePage(first_page_id + j);
+    }
+    pages.clear();
+    return false;
+  }
+  return true;
+}
+
+// Caller must hold latch_. The returned frame is neither in the page table nor in the replacer.
+bool BufferPoolManager::AcquireFrame(frame_id_t *frame_id) {
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    return true;
+  }
+  if (!replacer_->Victim(frame_id)) {
+    return false;
+  }
+  // write back the victim before its frame is reused
+  Page *R = &pages_[*frame_id];
+  if (R->IsDirty()) {
+    disk_manager_->WritePage(R->GetPageId(), R->GetData());
+    R->is_dirty_ = false;
+    RecordWriteBack(R->GetPageId());
+    // the background writer is falling behind
+    bg_cv_.notify_one();
+  }
+  page_table_.Erase(R->GetPageId());
+  return true;
+}
+
+// Caller must hold latch_. Like AcquireFrame, the returned frame is neither in the page table nor in the replacer.
+bool BufferPoolManager::AcquireRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id) {
+  frame_id_t ring_frame;
+  page_id_t ring_page;
+  if (!strategy->Current(this, &ring_frame, &ring_page) || static_cast<size_t>(ring_frame) >= pool_size_) {
+    return false;
+  }
+  Page *R = &pages_[ring_frame];
+  // the page may have been evicted (and the frame reused) or deleted meanwhile, or be in use
+  if (R->page_id_ != ring_page || R->pin_count_ != 0 || flushing_[ring_frame]) {
+    return false;
+  }
+  replacer_->Remove(ring_frame);
+  if (R->IsDirty()) {
+    disk_manager_->WritePage(R->GetPageId(), R->GetData());
+    R->is_dirty_ = false;
+    RecordWriteBack(R->GetPageId());
+  }
+  page_table_.Erase(R->GetPageId());
+  *frame_id = ring_frame;
+  return true;
+}
+
+void BufferPoolManager::GrowFrames(size_t num_frames) {
+  for (; num_frames_ < num_frames; num_frames_++) {
+    new (&pages_[num_frames_]) Page(arena_.GetFrame(num_frames_));
+  }
+  if (flushing_.size() < num_frames) {
+    flushing_.resize(num_frames, false);
+  }
+  page_table_.Grow(num_frames);
+}
+
 bool BufferPoolManager::DeletePage(page_id_t page_id) {
   // 0.   Make sure you call DeallocatePage!
   // 1.   Search the page table for the requested page (P).
@@ -126,17 +278,16 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
   
+  // a background write of the page in flight lands before the page is gone
+  std::scoped_lock<std::mutex> write_back_lock(write_back_latch_);
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   // 0.   Make sure you call DeallocatePage!
   DeallocatePage(page_id);
 
   // 1.   Search the page table for the requested page (P).
   frame_id_t P_frame_id;
-  try
-  { 
-    P_frame_id = page_table_.at(page_id); // may throw err out_of_range
-  }
-  catch(const std::out_of_range& e)
-  { // P not exist, return true.
+  if (!page_table_.Find(page_id, &P_frame_id)) {
+    // P not exist, return true.
     return true;
   }
   
@@ -148,8 +299,8 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
   // 3.   Otherwise, P can be deleted. Remove P from the page table, 
   //      reset its metadata and return it to the free list.
   // Remove P from the page table
-  page_table_.erase(page_id);
-  replacer_->Pin(P_frame_id); // remove P from the replacer
+  page_table_.Erase(page_id);
+  replacer_->Remove(P_frame_id); // remove P (and its access history) from the replacer
   // Reset P's metadata
   Page *P = &pages_[P_frame_id];
   P->page_id_ = INVALID_PAGE_ID;
@@ -160,27 +311,71 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
   return true;
 }
 
+size_t BufferPoolManager::TruncateFreeExtents() {
+  // a background write of a page freed meanwhile would grow the file again past the cut
+  std::scoped_lock<std::mutex> write_back_lock(write_back_latch_);
+  return disk_manager_->TruncateFreeExtents();
+}
+
+bool BufferPoolManager::DropTablespace(const void *owner) {
+  uint32_t tablespace_id = disk_manager_->GetTablespaceId(owner);
+  if (tablespace_id == 0) {
+    return false;
+  }
+  // the pages must not be written into the file after it is gone
+  DiscardTablespacePages(tablespace_id);
+  disk_manager_->DropTablespace(tablespace_id);
+  return true;
+}
+
+void BufferPoolManager::DiscardTablespacePages(uint32_t tablespace_id) {
+  // no frame is left being written by the background writer, its batch in flight lands before the file is gone
+  std::scoped_lock<std::mutex> write_back_lock(write_back_latch_);
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
+  for (size_t i = 0; i < pool_size_; i++) {
+    Page &page = pages_[i];
+    if (page.page_id_ == INVALID_PAGE_ID || disk_manager_->TablespaceOf(page.page_id_) != tablespace_id) {
+      continue;
+    }
+    // as DeletePage
+    page_table_.Erase(page.page_id_);
+    replacer_->Remove(i);
+    page.page_id_ = INVALID_PAGE_ID;
+    page.pin_count_ = 0;
+    page.is_dirty_ = false;
+    free_list_.push_back(i);
+  }
+}
+
 bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
-  frame_id_t frame_id = page_table_[page_id];
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id)) {
+    return false;
+  }
   // decrement pin count (lower bound is 0)
   pages_[frame_id].pin_count_ = MAX(pages_[frame_id].pin_count_-1, 0);
   // if pin count is 0, call replacer_->Unpin
-  if(!pages_[frame_id].pin_count_)
+  // a page being written by the background writer becomes evictable once the write is done
+  if(!pages_[frame_id].pin_count_ && !flushing_[frame_id])
     replacer_->Unpin(frame_id);
   if (is_dirty)
     pages_[frame_id].is_dirty_ = true;
   return true;
-
-  // return false; // impossible for now
 }
 
 bool BufferPoolManager::FlushPage(page_id_t page_id) {
-  frame_id_t frame_id = page_table_[page_id];
+  // an older copy of the page written by the background writer must not land after this write
+  std::scoped_lock<std::mutex> write_back_lock(write_back_latch_);
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id)) {
+    return false;
+  }
   disk_manager_->WritePage(page_id, pages_[frame_id].GetData());
   pages_[frame_id].is_dirty_ = false; // reset dirty bit
+  RecordWriteBack(page_id);
   return true;
-
-  // return false; // impossible for now
 }
 
 page_id_t BufferPoolManager::AllocatePage() {
@@ -198,6 +393,7 @@ bool BufferPoolManager::IsPageFree(page_id_t page_id) {
 
 // Only used for debug
 bool BufferPoolManager::CheckAllUnpinned() {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   bool res = true;
   for (size_t i = 0; i < pool_size_; i++) {
     if (pages_[i].pin_count_ != 0) {
@@ -206,4 +402,365 @@ bool BufferPoolManager::CheckAllUnpinned() {
     }
   }
   return res;
+}
+
+void BufferPoolManager::FlushAllPages() {
+  // the background writes in flight land before the checkpoint, and no new one starts until it is done
+  std::scoped_lock<std::mutex> write_back_lock(write_back_latch_);
+  FlushDirtyPages();
+  disk_manager_->Checkpoint();
+}
+
+void BufferPoolManager::FlushDirtyPages() {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
+  std::vector<Page *> dirty_pages;
+  CollectDirtyPages(dirty_pages);
+  WriteDirtyPages(dirty_pages);
+}
+
+void BufferPoolManager::CollectDirtyPages(std::vector<Page *> &pages) {
+  for (size_t i = 0; i < pool_size_; i++) {
+    if (pages_[i].page_id_ != INVALID_PAGE_ID && pages_[i].is_dirty_) {
+      pages.push_back(&pages_[i]);
+      RecordWriteBack(pages_[i].page_id_);
+    }
+  }
+}
+
+void BufferPoolManager::WriteDirtyPages(const std::vector<Page *> &pages) {
+  std::vector<std::pair<page_id_t, const char *>> writes;
+  writes.reserve(pages.size());
+  for (Page *page : pages) {
+    writes.emplace_back(page->page_id_, page->GetData());
+  }
+  // written in page id order, i.e. sequentially in the file
+  disk_manager_->WritePages(writes);
+  for (Page *page : pages) {
+    page->is_dirty_ = false;
+  }
+}
+
+bool BufferPoolManager::Resize(size_t pool_size) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
+  if (pool_size == 0 || pool_size > max_pool_size_) {
+    return false;
+  }
+  if (pool_size < pool_size_) {
+    // the frames to remove must not be in use, including by the background writer
+    for (size_t i = pool_size; i < pool_size_; i++) {
+      if (pages_[i].pin_count_ != 0 || flushing_[i]) {
+        return false;
+      }
+    }
+    std::vector<Page *> dirty_pages;
+    for (size_t i = pool_size; i < pool_size_; i++) {
+      if (pages_[i].page_id_ != INVALID_PAGE_ID && pages_[i].is_dirty_) {
+        dirty_pages.push_back(&pages_[i]);
+        RecordWriteBack(pages_[i].page_id_);
+      }
+    }
+    WriteDirtyPages(dirty_pages);
+    for (size_t i = pool_size; i < pool_size_; i++) {
+      Page &page = pages_[i];
+      if (page.page_id_ == INVALID_PAGE_ID) {
+        continue;
+      }
+      page_table_.Erase(page.page_id_);
+      replacer_->Remove(i);
+      page.page_id_ = INVALID_PAGE_ID;
+      page.is_dirty_ = false;
+    }
+    free_list_.remove_if([pool_size](frame_id_t frame_id) { return static_cast<size_t>(frame_id) >= pool_size; });
+    arena_.Release(pool_size, pool_size_ - pool_size);
+  } else {
+    // the frames removed by an earlier shrink keep their metadata
+    GrowFrames(pool_size);
+    for (size_t i = pool_size_; i < pool_size; i++) {
+      free_list_.emplace_back(i);
+    }
+  }
+  {
+    // keep the same share of the pool clean
+    std::scoped_lock<std::mutex> bg_lock(bg_mutex_);
+    bg_target_clean_ = bg_target_clean_ * pool_size / pool_size_;
+  }
+  pool_size_ = pool_size;
+  return true;
+}
+
+void BufferPoolManager::StartBackgroundWriter(size_t target_clean_frames, uint32_t interval_ms) {
+  if (bg_writer_.joinable()) {
+    return;
+  }
+  {
+    std::scoped_lock<std::mutex> lock(bg_mutex_);
+    bg_stop_ = false;
+    bg_target_clean_ = target_clean_frames;
+  }
+  bg_writer_ = std::thread(&BufferPoolManager::BackgroundWriterLoop, this, interval_ms);
+}
+
+void BufferPoolManager::StopBackgroundWriter() {
+  {
+    std::scoped_lock<std::mutex> lock(bg_mutex_);
+    bg_stop_ = true;
+  }
+  bg_cv_.notify_all();
+  if (bg_writer_.joinable()) {
+    bg_writer_.join();
+  }
+}
+
+void BufferPoolManager::BackgroundWriterLoop(uint32_t interval_ms) {
+  std::unique_lock<std::mutex> lock(bg_mutex_);
+  while (!bg_stop_) {
+    lock.unlock();
+    size_t written = BackgroundFlush();
+    lock.lock();
+    // a full batch was written, check again right away
+    if (written == 0 && !bg_stop_) {
+      bg_cv_.wait_for(lock, std::chrono::milliseconds(interval_ms));
+    }
+  }
+}
+
+size_t BufferPoolManager::BackgroundFlush() {
+  // held until the batch is on disk, see write_back_latch_
+  std::scoped_lock<std::mutex> write_back_lock(write_back_latch_);
+  std::vector<std::pair<page_id_t, frame_id_t>> batch;
+  // aligned, so DiskIOMode::DIRECT writes it as it is
+  std::unique_ptr<char[], void (*)(void *)> buffer(nullptr, free);
+  {
+    std::scoped_lock<std::recursive_mutex> lock(latch_);
+    // frames the replacer can hand out without a write
+    size_t clean = free_list_.size();
+    for (size_t i = 0; i < pool_size_; i++) {
+      Page &page = pages_[i];
+      if (page.page_id_ == INVALID_PAGE_ID || page.pin_count_ != 0) {
+        continue;
+      }
+      if (page.is_dirty_) {
+        batch.emplace_back(page.page_id_, i);
+      } else {
+        clean++;
+      }
+    }
+    if (clean >= bg_target_clean_ || batch.empty()) {
+      return 0;
+    }
+    std::sort(batch.begin(), batch.end());
+    batch.resize(std::min(batch.size(), bg_target_clean_ - clean));
+    // keep the pages out of the replacer so they are not evicted before they are on disk, and write a
+    // snapshot so the latch is not held during the I/O. A page changed after the snapshot is marked
+    // dirty again on unpin.
+    buffer = DiskManager::AllocatePageBuffer(batch.size());
+    for (size_t i = 0; i < batch.size(); i++) {
+      Page &page = pages_[batch[i].second];
+      replacer_->Pin(batch[i].second);
+      flushing_[batch[i].second] = true;
+      memcpy(buffer.get() + i * PAGE_SIZE, page.GetData(), PAGE_SIZE);
+      page.is_dirty_ = false;
+    }
+  }
+  // the writes of the batch are in flight together
+  IOWaitGroup writes;
+  writes.Add(batch.size());
+  for (size_t i = 0; i < batch.size(); i++) {
+    disk_manager_->WritePageAsync(batch[i].first, buffer.get() + i * PAGE_SIZE, [&writes](bool) { writes.Done(); });
+  }
+  disk_manager_->SubmitBatch();
+  writes.Wait();
+  {
+    std::scoped_lock<std::recursive_mutex> lock(latch_);
+    for (auto &flushed : batch) {
+      // a prefetch read before the write must not be installed
+      RecordWriteBack(flushed.first);
+      // the frame may hold another page by now, it is evictable as long as it is in use and unpinned
+      flushing_[flushed.second] = false;
+      if (pages_[flushed.second].page_id_ != INVALID_PAGE_ID && pages_[flushed.second].pin_count_ == 0) {
+        replacer_->Unpin(flushed.second);
+      }
+    }
+  }
+  return batch.size();
+}
+
+void BufferPoolManager::Prefetch(const std::vector<page_id_t> &page_ids) {
+  std::scoped_lock<std::mutex> lock(prefetch_mutex_);
+  if (prefetch_stop_ || prefetch_queue_.size() >= GetPoolSize()) {
+    return;
+  }
+  for (auto page_id : page_ids) {
+    prefetch_queue_.push_back({page_id, 1, nullptr, nullptr});
+  }
+  if (!prefetcher_.joinable()) {
+    prefetcher_ = std::thread(&BufferPoolManager::PrefetchLoop, this);
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManager::Prefetch(page_id_t page_id, size_t distance, NextPageIdFunc next_page_id,
+                                 std::shared_ptr<BufferAccessStrategy> strategy) {
+  std::scoped_lock<std::mutex> lock(prefetch_mutex_);
+  if (prefetch_stop_ || prefetch_queue_.size() >= GetPoolSize()) {
+    return;
+  }
+  prefetch_queue_.push_back({page_id, distance, next_page_id, std::move(strategy)});
+  if (!prefetcher_.joinable()) {
+    prefetcher_ = std::thread(&BufferPoolManager::PrefetchLoop, this);
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManager::StopPrefetcher() {
+  {
+    std::scoped_lock<std::mutex> lock(prefetch_mutex_);
+    prefetch_stop_ = true;
+    prefetch_queue_.clear();
+  }
+  prefetch_cv_.notify_all();
+  if (prefetcher_.joinable()) {
+    prefetcher_.join();
+  }
+}
+
+void BufferPoolManager::PrefetchLoop() {
+  std::unique_lock<std::mutex> lock(prefetch_mutex_);
+  while (true) {
+    prefetch_cv_.wait(lock, [this] { return prefetch_stop_ || !prefetch_queue_.empty(); });
+    if (prefetch_stop_) {
+      return;
+    }
+    // every queued request is served at once
+    std::vector<PrefetchRequest> requests(std::make_move_iterator(prefetch_queue_.begin()),
+                                          std::make_move_iterator(prefetch_queue_.end()));
+    prefetch_queue_.clear();
+    lock.unlock();
+    PrefetchBatch(requests);
+    lock.lock();
+  }
+}
+
+void BufferPoolManager::PrefetchBatch(std::vector<PrefetchRequest> &requests) {
+  auto buffer = DiskManager::AllocatePageBuffer(requests.size());
+  std::vector<size_t> write_backs(requests.size());
+  // written by the I/O threads, one element each
+  std::unique_ptr<bool[]> read_ok(new bool[requests.size()]);
+  // a page chain only tells its next page once a page is read: each round reads the next page of every
+  // request together
+  while (!requests.empty()) {
+    {
+      std::scoped_lock<std::mutex> lock(prefetch_mutex_);
+      if (prefetch_stop_) {
+        return;
+      }
+    }
+    std::vector<size_t> reading;
+    for (size_t i = 0; i < requests.size(); i++) {
+      PrefetchRequest &request = requests[i];
+      // pages already in the pool only tell where the chain goes on
+      while (request.distance_ > 0 && request.page_id_ >= 0 &&
+             PrefetchLookup(request.page_id_, request.next_page_id_, &request.page_id_, &write_backs[i])) {
+        request.distance_--;
+      }
+      if (request.distance_ > 0 && request.page_id_ >= 0) {
+        reading.push_back(i);
+      }
+    }
+    if (reading.size() == 1) {
+      // a lone read (e.g. one table heap chain) is not worth a round trip through an I/O thread
+      disk_manager_->ReadPage(requests[reading[0]].page_id_, buffer.get() + reading[0] * PAGE_SIZE);
+      read_ok[reading[0]] = true;
+    } else {
+      IOWaitGroup reads;
+      reads.Add(reading.size());
+      for (auto i : reading) {
+        read_ok[i] = false;
+        disk_manager_->ReadPageAsync(requests[i].page_id_, buffer.get() + i * PAGE_SIZE,
+                                     [&reads, &read_ok, i](bool ok) {
+                                       read_ok[i] = ok;
+                                       reads.Done();
+                                     });
+      }
+      disk_manager_->SubmitBatch();
+      reads.Wait();
+    }
+    for (auto i : reading) {
+      PrefetchRequest &request = requests[i];
+      const char *data = buffer.get() + i * PAGE_SIZE;
+      page_id_t next = request.next_page_id_ != nullptr ? request.next_page_id_(data) : INVALID_PAGE_ID;
+      if (!read_ok[i] || !PrefetchInstall(request.page_id_, data, write_backs[i], request.strategy_.get())) {
+        // no frame to spare, or the disk failed: stop this request
+        request.distance_ = 0;
+        continue;
+      }
+      request.page_id_ = next;
+      request.distance_--;
+    }
+    // keep the unfinished requests, each with its own buffer slot
+    size_t kept = 0;
+    for (size_t i = 0; i < requests.size(); i++) {
+      if (requests[i].distance_ > 0 && requests[i].page_id_ >= 0) {
+        requests[kept++] = std::move(requests[i]);
+      }
+    }
+    requests.resize(kept);
+  }
+}
+
+bool BufferPoolManager::PrefetchLookup(page_id_t page_id, NextPageIdFunc next_page_id, page_id_t *next,
+                                       size_t *write_backs) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
+  frame_id_t frame_id;
+  if (page_table_.Find(page_id, &frame_id)) {
+    *next = next_page_id != nullptr ? next_page_id(pages_[frame_id].GetData()) : INVALID_PAGE_ID;
+    return true;
+  }
+  *write_backs = write_backs_;
+  return false;
+}
+
+void BufferPoolManager::RecordWriteBack(page_id_t page_id) {
+  written_back_pages_[write_backs_ % WRITE_BACK_HISTORY] = page_id;
+  write_backs_++;
+}
+
+bool BufferPoolManager::WrittenBackSince(page_id_t page_id, size_t write_backs) {
+  // too many to tell, assume the page was among them
+  if (write_backs_ - write_backs > WRITE_BACK_HISTORY) {
+    return true;
+  }
+  for (size_t i = write_backs; i < write_backs_; i++) {
+    if (written_back_pages_[i % WRITE_BACK_HISTORY] == page_id) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool BufferPoolManager::PrefetchInstall(page_id_t page_id, const char *data, size_t write_backs,
+                                        BufferAccessStrategy *strategy) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
+  frame_id_t frame_id;
+  // someone fetched the page meanwhile, or a copy of it may have been loaded, changed and written back
+  // after our read (and left the pool clean): keep what is in the pool / on disk
+  if (page_table_.Find(page_id, &frame_id) || WrittenBackSince(page_id, write_backs)) {
+    return true;
+  }
+  bool recycled = strategy != nullptr && AcquireRingFrame(strategy, &frame_id);
+  if (!recycled && !AcquireFrame(&frame_id)) {
+    return false;
+  }
+  Page *P = &pages_[frame_id];
+  P->page_id_ = page_id;
+  P->pin_count_ = 0;
+  P->is_dirty_ = false;
+  memcpy(P->GetData(), data, PAGE_SIZE);
+  page_table_.Insert(page_id, frame_id);
+  replacer_->Unpin(frame_id);
+  if (strategy != nullptr) {
+    strategy->Put(this, frame_id, page_id, recycled);
+  }
+  prefetch_count_++;
+  return true;
 }
\ No newline at end of file
@@ -0,0 +1,50 @@
+#include <sys/mman.h>
+
+#include <cstdint>
+
+#include "buffer/frame_arena.h"
+
+FrameArena::FrameArena(size_t num_frames) {
+  size_t size = num_frames * PAGE_SIZE;
+  if (size == 0) {
+    return;
+  }
+  // over-allocate so the start can be aligned to a huge page, the slack is unmapped below
+  bool use_huge_page = size >= HUGE_PAGE_SIZE;
+  mapping_size_ = use_huge_page ? size + HUGE_PAGE_SIZE : size;
+  mapping_ = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1,
+                  0);
+  ASSERT(mapping_ != MAP_FAILED, "Failed to map the buffer pool frames.");
+  data_ = static_cast<char *>(mapping_);
+  if (use_huge_page) {
+    auto start = reinterpret_cast<uintptr_t>(mapping_);
+    auto aligned = (start + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    size_t head = aligned - start;
+    if (head > 0) {
+      munmap(mapping_, head);
+    }
+    size_t tail = mapping_size_ - head - size;
+    if (tail > 0) {
+      munmap(reinterpret_cast<char *>(aligned) + size, tail);
+    }
+    mapping_ = reinterpret_cast<void *>(aligned);
+    mapping_size_ = size;
+    data_ = static_cast<char *>(mapping_);
+#ifdef MADV_HUGEPAGE
+    huge_page_advised_ = madvise(mapping_, mapping_size_, MADV_HUGEPAGE) == 0;
+#endif
+  }
+}
+
+FrameArena::~FrameArena() {
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+  }
+}
+
+void FrameArena::Release(frame_id_t first, size_t count) {
+  if (count == 0) {
+    return;
+  }
+  madvise(GetFrame(first), count * PAGE_SIZE, MADV_DONTNEED);
+}
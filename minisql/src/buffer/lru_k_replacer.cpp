@@ -0,0 +1,94 @@
+#include "buffer/lru_k_replacer.h"
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k) : k_(k) {
+  frames_.reserve(num_pages);
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+// both queues are ordered by the oldest kept timestamp, i.e. the k-th most recent access
+// for cache_queue_ and the first access for history_queue_
+void LRUKReplacer::Enqueue(frame_id_t frame_id, const FrameEntry &entry) {
+  QueueOf(entry).emplace(entry.history_.front(), frame_id);
+}
+
+void LRUKReplacer::Dequeue(frame_id_t frame_id, const FrameEntry &entry) {
+  QueueOf(entry).erase(make_pair(entry.history_.front(), frame_id));
+}
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  // frames with infinite backward k-distance go first
+  auto &queue = history_queue_.empty() ? cache_queue_ : history_queue_;
+  if (queue.empty()) {
+    return false;
+  }
+  *frame_id = queue.begin()->second;
+  queue.erase(queue.begin());
+  // the frame is about to hold another page, its history is meaningless now
+  frames_.erase(*frame_id);
+  if (last_accessed_ == *frame_id) {
+    last_accessed_ = INVALID_FRAME_ID;
+  }
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  auto iter = frames_.find(frame_id);
+  if (iter == frames_.end() || !iter->second.evictable_) {
+    return;
+  }
+  Dequeue(frame_id, iter->second);
+  iter->second.evictable_ = false;
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  auto &entry = frames_[frame_id];
+  if (entry.evictable_) {
+    return;
+  }
+  if (entry.history_.empty()) {
+    // never reported through RecordAccess, count the unpin as the access
+    entry.history_.push_back(current_timestamp_++);
+    last_accessed_ = frame_id;
+  }
+  entry.evictable_ = true;
+  Enqueue(frame_id, entry);
+}
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
+  auto &entry = frames_[frame_id];
+  if (entry.evictable_) {
+    Dequeue(frame_id, entry);
+  }
+  if (last_accessed_ == frame_id && !entry.history_.empty()) {
+    // correlated reference, only refresh the latest access
+    entry.history_.back() = current_timestamp_++;
+  } else {
+    entry.history_.push_back(current_timestamp_++);
+    if (entry.history_.size() > k_) {
+      entry.history_.pop_front();
+    }
+  }
+  last_accessed_ = frame_id;
+  if (entry.evictable_) {
+    Enqueue(frame_id, entry);
+  }
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  auto iter = frames_.find(frame_id);
+  if (iter == frames_.end()) {
+    return;
+  }
+  if (iter->second.evictable_) {
+    Dequeue(frame_id, iter->second);
+  }
+  frames_.erase(iter);
+  if (last_accessed_ == frame_id) {
+    last_accessed_ = INVALID_FRAME_ID;
+  }
+}
+
+size_t LRUKReplacer::Size() {
+  return history_queue_.size() + cache_queue_.size();
+}
@@ -122,12 +122,12 @@ bool ClockReplacer::Victim(frame_id_t *frame_id){
 void ClockReplacer::Pin(frame_id_t frame_id){
   auto iter = clock_map.find(frame_id);
   if(iter != clock_map.end()){
+    // the hand moves on to the next frame, end() if it was the last, Victim wraps around
     if (clock_hand == iter->second) {
-      clock_hand++;
-      if (clock_hand == clock_list.end())
-        clock_hand = clock_list.begin();
+      clock_hand = clock_list.erase(iter->second);
+    } else {
+      clock_list.erase(iter->second);
     }
-    clock_list.erase(iter->second);
     clock_map.erase(iter);
   }
 }
@@ -0,0 +1,44 @@
+#include <utility>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/page_guard.h"
+
+ReadPageGuard::ReadPageGuard(ReadPageGuard &&that) noexcept
+        : bpm_(std::exchange(that.bpm_, nullptr)), page_(std::exchange(that.page_, nullptr)) {}
+
+ReadPageGuard &ReadPageGuard::operator=(ReadPageGuard &&that) noexcept {
+  if (this != &that) {
+    Drop();
+    bpm_ = std::exchange(that.bpm_, nullptr);
+    page_ = std::exchange(that.page_, nullptr);
+  }
+  return *this;
+}
+
+void ReadPageGuard::Drop() {
+  if (page_ != nullptr) {
+    bpm_->UnpinPage(page_->GetPageId(), false);
+    page_ = nullptr;
+  }
+  bpm_ = nullptr;
+}
+
+WritePageGuard::WritePageGuard(WritePageGuard &&that) noexcept
+        : bpm_(std::exchange(that.bpm_, nullptr)), page_(std::exchange(that.page_, nullptr)) {}
+
+WritePageGuard &WritePageGuard::operator=(WritePageGuard &&that) noexcept {
+  if (this != &that) {
+    Drop();
+    bpm_ = std::exchange(that.bpm_, nullptr);
+    page_ = std::exchange(that.page_, nullptr);
+  }
+  return *this;
+}
+
+void WritePageGuard::Drop() {
+  if (page_ != nullptr) {
+    bpm_->UnpinPage(page_->GetPageId(), true);
+    page_ = nullptr;
+  }
+  bpm_ = nullptr;
+}
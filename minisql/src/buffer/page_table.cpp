@@ -0,0 +1,103 @@
+#include "buffer/page_table.h"
+
+PageTable::PageTable(size_t num_frames) {
+  Allocate(num_frames);
+}
+
+PageTable::~PageTable() {
+  delete[] slots_;
+}
+
+void PageTable::Allocate(size_t num_frames) {
+  max_size_ = num_frames;
+  // at least twice the number of frames, so there is always an empty slot
+  size_t capacity = 2;
+  shift_ = 1;
+  while (capacity < 2 * num_frames) {
+    capacity <<= 1;
+    shift_++;
+  }
+  mask_ = capacity - 1;
+  slots_ = new Slot[capacity];
+  for (size_t i = 0; i < capacity; i++) {
+    slots_[i].page_id_ = INVALID_PAGE_ID;
+    slots_[i].frame_id_ = INVALID_FRAME_ID;
+  }
+}
+
+void PageTable::Grow(size_t num_frames) {
+  if (num_frames <= max_size_) {
+    return;
+  }
+  if (2 * num_frames <= mask_ + 1) {
+    max_size_ = num_frames;
+    return;
+  }
+  // the home slots depend on the capacity, so every entry moves
+  Slot *old_slots = slots_;
+  size_t old_capacity = mask_ + 1;
+  Allocate(num_frames);
+  size_ = 0;
+  for (size_t i = 0; i < old_capacity; i++) {
+    if (old_slots[i].page_id_ != INVALID_PAGE_ID) {
+      Insert(old_slots[i].page_id_, old_slots[i].frame_id_);
+    }
+  }
+  delete[] old_slots;
+}
+
+// @return the slot holding page_id, or the empty slot ending its probe sequence
+size_t PageTable::Probe(page_id_t page_id) const {
+  size_t i = Home(page_id);
+  while (slots_[i].page_id_ != INVALID_PAGE_ID && slots_[i].page_id_ != page_id) {
+    i = (i + 1) & mask_;
+  }
+  return i;
+}
+
+bool PageTable::Find(page_id_t page_id, frame_id_t *frame_id) const {
+  const Slot &slot = slots_[Probe(page_id)];
+  if (slot.page_id_ == INVALID_PAGE_ID) {
+    return false;
+  }
+  *frame_id = slot.frame_id_;
+  return true;
+}
+
+bool PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  Slot &slot = slots_[Probe(page_id)];
+  if (slot.page_id_ == INVALID_PAGE_ID) {
+    if (size_ == max_size_) {
+      return false;
+    }
+    slot.page_id_ = page_id;
+    size_++;
+  }
+  slot.frame_id_ = frame_id;
+  return true;
+}
+
+bool PageTable::Erase(page_id_t page_id) {
+  size_t hole = Probe(page_id);
+  if (slots_[hole].page_id_ == INVALID_PAGE_ID) {
+    return false;
+  }
+  // backward shift: move every later entry of the cluster that may live in the hole into it
+  size_t i = hole;
+  while (true) {
+    i = (i + 1) & mask_;
+    if (slots_[i].page_id_ == INVALID_PAGE_ID) {
+      break;
+    }
+    size_t home = Home(slots_[i].page_id_);
+    // the entry can move iff its home is not in the (cyclic) range (hole, i]
+    if (((i - home) & mask_) >= ((i - hole) & mask_)) {
+      slots_[hole] = slots_[i];
+      hole = i;
+    }
+  }
+  slots_[hole].page_id_ = INVALID_PAGE_ID;
+  slots_[hole].frame_id_ = INVALID_FRAME_ID;
+  size_--;
+  return true;
+}
@@ -0,0 +1,164 @@
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "glog/logging.h"
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size,
+                                                     DiskManager *disk_manager, ReplacerType replacer_type,
+                                                     size_t max_pool_size)
+        : BufferPoolManager(disk_manager), num_instances_(num_instances), pool_size_(pool_size),
+          disk_manager_(disk_manager) {
+  ASSERT(num_instances_ > 0, "Need at least one buffer pool instance.");
+  for (size_t i = 0; i < num_instances_; i++) {
+    instances_.push_back(new BufferPoolManager(pool_size_, disk_manager_, replacer_type, max_pool_size));
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  // the prefetcher calls into the shards
+  StopPrefetcher();
+  // write back the pages of all shards in one batch, the shards find nothing left to write
+  StopBackgroundWriter();
+  FlushAllPages();
+  for (auto instance : instances_) {
+    delete instance;
+  }
+}
+
+// a strategy remembers the shard of each frame of its ring, frames of other shards are not recycled
+Page *ParallelBufferPoolManager::FetchPage(page_id_t page_id, BufferAccessStrategy *strategy) {
+  return GetInstance(page_id)->FetchPage(page_id, strategy);
+}
+
+bool ParallelBufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+  return GetInstance(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+bool ParallelBufferPoolManager::FlushPage(page_id_t page_id) {
+  return GetInstance(page_id)->FlushPage(page_id);
+}
+
+// return nullptr if the shard owning the new page id has no evictable frame
+Page *ParallelBufferPoolManager::NewPage(page_id_t &page_id, BufferAccessStrategy *strategy) {
+  // the page id decides the shard, so allocate it first
+  page_id_t new_page_id = disk_manager_->AllocatePage();
+  if (new_page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  Page *page = GetInstance(new_page_id)->NewPageWithId(new_page_id, strategy);
+  if (page == nullptr) {
+    disk_manager_->DeAllocatePage(new_page_id);
+    return nullptr;
+  }
+  page_id = new_page_id;
+  return page;
+}
+
+bool ParallelBufferPoolManager::DeletePage(page_id_t page_id) {
+  return GetInstance(page_id)->DeletePage(page_id);
+}
+
+bool ParallelBufferPoolManager::IsPageFree(page_id_t page_id) {
+  return disk_manager_->IsPageFree(page_id);
+}
+
+// Only used for debug
+bool ParallelBufferPoolManager::CheckAllUnpinned() {
+  bool res = true;
+  for (auto instance : instances_) {
+    res = instance->CheckAllUnpinned() && res;
+  }
+  return res;
+}
+
+void ParallelBufferPoolManager::FlushAllPages() {
+  // the background writes of the shards in flight land first, as in BufferPoolManager::FlushAllPages
+  std::vector<std::unique_lock<std::mutex>> write_back_locks;
+  for (auto instance : instances_) {
+    write_back_locks.emplace_back(instance->write_back_latch_);
+  }
+  // one batch for all shards, so neighbouring pages of different shards are written together
+  std::vector<std::unique_lock<std::recursive_mutex>> locks;
+  std::vector<Page *> dirty_pages;
+  for (auto instance : instances_) {
+    locks.emplace_back(instance->latch_);
+    instance->CollectDirtyPages(dirty_pages);
+  }
+  WriteDirtyPages(dirty_pages);
+  locks.clear();
+  // the shards share the disk manager, one checkpoint covers them all
+  disk_manager_->Checkpoint();
+}
+
+size_t ParallelBufferPoolManager::TruncateFreeExtents() {
+  std::vector<std::unique_lock<std::mutex>> write_back_locks;
+  for (auto instance : instances_) {
+    write_back_locks.emplace_back(instance->write_back_latch_);
+  }
+  return disk_manager_->TruncateFreeExtents();
+}
+
+void ParallelBufferPoolManager::StartBackgroundWriter(size_t target_clean_frames, uint32_t interval_ms) {
+  for (auto instance : instances_) {
+    instance->StartBackgroundWriter(target_clean_frames / num_instances_, interval_ms);
+  }
+}
+
+void ParallelBufferPoolManager::StopBackgroundWriter() {
+  for (auto instance : instances_) {
+    instance->StopBackgroundWriter();
+  }
+}
+
+bool ParallelBufferPoolManager::Resize(size_t pool_size) {
+  size_t shard_size = pool_size / num_instances_;
+  // out of range for every shard, so a shard can only refuse to shrink (a frame to remove is in use)
+  if (shard_size == 0 || shard_size > instances_[0]->GetMaxPoolSize()) {
+    return false;
+  }
+  for (size_t i = 0; i < num_instances_; i++) {
+    if (!instances_[i]->Resize(shard_size)) {
+      // the shards before i were shrunk, growing them back within their max only adds free frames
+      for (size_t j = 0; j < i; j++) {
+        if (!instances_[j]->Resize(pool_size_)) {
+          LOG(ERROR) << "Buffer pool shard " << j << " could not be resized back to " << pool_size_ << " frames.";
+        }
+      }
+      return false;
+    }
+  }
+  pool_size_ = shard_size;
+  return true;
+}
+
+bool ParallelBufferPoolManager::PrefetchLookup(page_id_t page_id, NextPageIdFunc next_page_id, page_id_t *next,
+                                               size_t *write_backs) {
+  return GetInstance(page_id)->PrefetchLookup(page_id, next_page_id, next, write_backs);
+}
+
+bool ParallelBufferPoolManager::PrefetchInstall(page_id_t page_id, const char *data, size_t write_backs,
+                                                BufferAccessStrategy *strategy) {
+  return GetInstance(page_id)->PrefetchInstall(page_id, data, write_backs, strategy);
+}
+
+size_t ParallelBufferPoolManager::GetPrefetchCount() {
+  size_t res = 0;
+  for (auto instance : instances_) {
+    res += instance->GetPrefetchCount();
+  }
+  return res;
+}
+
+size_t ParallelBufferPoolManager::GetHitCount() {
+  size_t res = 0;
+  for (auto instance : instances_) {
+    res += instance->GetHitCount();
+  }
+  return res;
+}
+
+size_t ParallelBufferPoolManager::GetMissCount() {
+  size_t res = 0;
+  for (auto instance : instances_) {
+    res += instance->GetMissCount();
+  }
+  return res;
+}
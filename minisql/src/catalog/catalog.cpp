@@ -109,8 +109,9 @@ dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schem
   } 
   page_id_t pageID;
   Page *pge=buffer_pool_manager_->NewPage(pageID);
-  TableHeap *th=TableHeap::Create(this->buffer_pool_manager_,schema,txn,this->log_manager_,this->lock_manager_,this->heap_);
   table_id_t tableID=this->catalog_meta_->GetNextTableId();
+  TableHeap *th=TableHeap::Create(this->buffer_pool_manager_,schema,txn,this->log_manager_,this->lock_manager_,this->heap_,
+                                  DiskManager::TableTablespaceId(tableID));
   TableMetadata *tm=TableMetadata::Create(tableID,table_name,th->GetFirstPageId(),schema,this->heap_,primaryKeyIndexs);
   table_info=TableInfo::Create(this->heap_);
   table_info->Init(tm,th);
@@ -211,8 +212,8 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
       IndexMetadata *im=IndexMetadata::Create(this->catalog_meta_->GetNextIndexId(),index_name,this->table_names_.at(table_name),tmp,this->heap_); 
       index_info=IndexInfo::Create(this->heap_);
       index_info->Init(im,tf,this->buffer_pool_manager_);
-      // insert current rows of table into index
-      TableIterator iter = tf->GetTableHeap()->Begin(nullptr);
+      // insert current rows of table into index, the table is read through a ring of frames
+      TableIterator iter = tf->GetTableHeap()->Begin(nullptr, std::make_shared<BufferAccessStrategy>());
       for (; !iter.isNull(); iter++) {
         Row row = *iter;
         Row keyRow(row, tmp);
@@ -384,7 +385,7 @@ dberr_t CatalogManager::GetTable(const table_id_t table_id, TableInfo *&table_in
 
 // new: insert with checking primary key & unique and maintaining indexes
 // ret: DB_PK_DUPLICATE, DB_UNI_KEY_DUPLICATE, DB_TUPLE_TOO_LARGE, DB_SUCCESS
-dberr_t CatalogManager::Insert(TableInfo* &tf, Row &row, Transaction *txn) {
+dberr_t CatalogManager::Insert(TableInfo* &tf, Row &row, Transaction *txn, BufferAccessStrategy *strategy) {
   // 1. check primary key and unique key
   auto uni_pk_maps = tf->GetUniPKMaps();
   for (auto &key_map : uni_pk_maps){
@@ -405,7 +406,8 @@ dberr_t CatalogManager::Insert(TableInfo* &tf, Row &row, Transaction *txn) {
     assert(ret == DB_KEY_NOT_FOUND);
   }
   // 2. do insert
-  bool ret_bool = tf->GetTableHeap()->InsertTuple(row, nullptr);
+  // the heap pages of a bulk insert go through the ring of strategy, the index pages stay in the pool
+  bool ret_bool = tf->GetTableHeap()->InsertTuple(row, nullptr, strategy);
   if (!ret_bool) {
     // error: the tuple is too large (>= page_size)
     return DB_TUPLE_TOO_LARGE;
@@ -421,6 +423,140 @@ dberr_t CatalogManager::Insert(TableInfo* &tf, Row &row, Transaction *txn) {
   return DB_SUCCESS;
 }
 
+// order of the keys of an index, fields compared one after the other
+static bool KeyLess(Row &a, Row &b) {
+  for (uint32_t i = 0; i < a.GetFieldCount(); i++) {
+    if (a.GetField(i)->CompareLessThan(*b.GetField(i)) == CmpBool::kTrue) {
+      return true;
+    }
+    if (b.GetField(i)->CompareLessThan(*a.GetField(i)) == CmpBool::kTrue) {
+      return false;
+    }
+  }
+  return false;
+}
+
+static bool KeyEquals(Row &a, Row &b) {
+  for (uint32_t i = 0; i < a.GetFieldCount(); i++) {
+    if (a.GetField(i)->CompareEquals(*b.GetField(i)) != CmpBool::kTrue) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// new: insert a batch with checking primary key & unique and maintaining indexes
+// ret: DB_PK_DUPLICATE, DB_UNI_KEY_DUPLICATE, DB_TUPLE_TOO_LARGE, DB_SUCCESS
+dberr_t CatalogManager::InsertBatch(TableInfo* &tf, vector<Row> &rows, Transaction *txn, vector<dberr_t> *results,
+                                    BufferAccessStrategy *strategy) {
+  vector<dberr_t> row_results(rows.size(), DB_SUCCESS);
+  // 1. check primary key and unique key against the index, in key order, one probe for the rows of equal keys
+  auto uni_pk_maps = tf->GetUniPKMaps();
+  vector<vector<size_t>> key_groups(uni_pk_maps.size()); // per key map, the rows of equal keys share a group
+  vector<vector<bool>> key_taken(uni_pk_maps.size());    // per key map and group, in the index or inserted
+  for (size_t m = 0; m < uni_pk_maps.size(); m++) {
+    auto &key_map = uni_pk_maps[m];
+    vector<IndexInfo *> indexInfos;
+    this->GetIndexesForKeyMap(tf->GetTableName(), key_map, indexInfos);
+    auto indexInfo = indexInfos[0]; // one index is enough for checking
+    vector<Row> keys;
+    keys.reserve(rows.size());
+    for (auto &row : rows) {
+      keys.emplace_back(row, key_map);
+    }
+    vector<size_t> order(rows.size());
+    for (size_t i = 0; i < order.size(); i++) {
+      order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return KeyLess(keys[a], keys[b]); });
+    key_groups[m].resize(rows.size());
+    vector<Row *> probe_keys;
+    for (size_t i = 0; i < order.size(); i++) {
+      size_t cur = order[i];
+      if (i == 0 || !KeyEquals(keys[order[i - 1]], keys[cur])) {
+        probe_keys.push_back(&keys[cur]);
+      }
+      key_groups[m][cur] = probe_keys.size() - 1;
+    }
+    indexInfo->GetIndex()->ScanKeys(probe_keys, key_taken[m], txn);
+  }
+  // then in batch order, as one Insert after the other: a row whose key is taken is a duplicate, and only the
+  // rows accepted take their keys, so a row rejected for one key does not reject the later rows on another
+  for (size_t i = 0; i < rows.size(); i++) {
+    for (size_t m = 0; m < uni_pk_maps.size(); m++) {
+      if (key_taken[m][key_groups[m][i]]) {
+        row_results[i] = uni_pk_maps[m] == tf->GetPrimaryKeyIndexs() ? DB_PK_DUPLICATE : DB_UNI_KEY_DUPLICATE;
+        break;
+      }
+    }
+    if (row_results[i] != DB_SUCCESS) {
+      continue;
+    }
+    // a row too large for a page is rejected before it takes its keys, the heap would not take it
+    if (rows[i].GetSerializedSize(tf->GetSchema()) > TablePage::SIZE_MAX_ROW) {
+      row_results[i] = DB_TUPLE_TOO_LARGE;
+      continue;
+    }
+    for (size_t m = 0; m < uni_pk_maps.size(); m++) {
+      key_taken[m][key_groups[m][i]] = true;
+    }
+  }
+  // 2. do insert
+  vector<Row *> accepted;
+  for (size_t i = 0; i < rows.size(); i++) {
+    if (row_results[i] == DB_SUCCESS) {
+      accepted.push_back(&rows[i]);
+    }
+  }
+  tf->GetTableHeap()->InsertTuples(accepted, txn, strategy);
+  vector<Row *> inserted;
+  for (size_t i = 0; i < rows.size(); i++) {
+    if (row_results[i] != DB_SUCCESS) {
+      continue;
+    }
+    if (rows[i].GetRowId().GetPageId() == INVALID_PAGE_ID) {
+      // error: no page could be allocated for the tuple, reported as Insert does
+      row_results[i] = DB_TUPLE_TOO_LARGE;
+      continue;
+    }
+    inserted.push_back(&rows[i]);
+  }
+  // 3. maintain indexes, each in key order, a leaf takes its run of keys at once
+  vector<IndexInfo *> indexes;
+  GetTableIndexes(tf->GetTableName(), indexes);
+  for (auto &index : indexes){
+    auto key_map = index->GetKeyMapping();
+    vector<Row> keys;
+    keys.reserve(inserted.size());
+    for (auto row : inserted) {
+      keys.emplace_back(*row, key_map);
+    }
+    vector<size_t> order(keys.size());
+    for (size_t i = 0; i < order.size(); i++) {
+      order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return KeyLess(keys[a], keys[b]); });
+    vector<Row *> sorted_keys;
+    vector<RowId> row_ids;
+    sorted_keys.reserve(order.size());
+    row_ids.reserve(order.size());
+    for (auto i : order) {
+      sorted_keys.push_back(&keys[i]);
+      row_ids.push_back(inserted[i]->GetRowId());
+    }
+    index->GetIndex()->InsertEntries(sorted_keys, row_ids, txn);
+  }
+  if (results != nullptr) {
+    *results = row_results;
+  }
+  for (auto result : row_results) {
+    if (result != DB_SUCCESS) {
+      return result;
+    }
+  }
+  return DB_SUCCESS;
+}
+
 // new: update with checking primary key & unique and maintaining indexes
 // ret: DB_PK_DUPLICATE, DB_UNI_KEY_DUPLICATE, DB_TUPLE_TOO_LARGE, DB_SUCCESS
 dberr_t CatalogManager::Update(TableInfo* &tf, Row &old_row, Row &row, Transaction *txn) {
@@ -473,6 +609,31 @@ dberr_t CatalogManager::Update(TableInfo* &tf, Row &old_row, Row &row, Transacti
   return DB_SUCCESS;
 }
 
+// new: vacuum with maintaining indexes
+// ret: DB_TABLE_NOT_EXIST, DB_SUCCESS
+dberr_t CatalogManager::Vacuum(const string &table_name, Transaction *txn, VacuumStats *stats) {
+  TableInfo *tf = nullptr;
+  if (GetTable(table_name, tf) != DB_SUCCESS) {
+    return DB_TABLE_NOT_EXIST;
+  }
+  vector<IndexInfo *> indexes;
+  GetTableIndexes(table_name, indexes);
+  VacuumStats result;
+  // every index entry of a moved row points to its new place
+  result.rows_moved_ = tf->GetTableHeap()->Vacuum(txn, [&](const Row &row, const RowId &new_rid) {
+    for (auto &index : indexes){
+      Row key(row, index->GetKeyMapping());
+      index->GetIndex()->RemoveEntry(key, row.GetRowId(), txn);
+      index->GetIndex()->InsertEntry(key, new_rid, txn);
+    }
+  }, &result.pages_before_, &result.pages_after_);
+  result.pages_truncated_ = buffer_pool_manager_->TruncateFreeExtents();
+  if (stats != nullptr) {
+    *stats = result;
+  }
+  return DB_SUCCESS;
+}
+
 // new: delete with maintaining indexes
 // ret: DB_FAILED, DB_SUCCESS
 dberr_t CatalogManager::Delete(TableInfo* &tf, Row &row, Transaction *txn) {
@@ -4,6 +4,9 @@
 #include <algorithm>
 #include <time.h>
 #include <iomanip>
+#include <chrono>
+#include <thread>
+#include <stdexcept>
 #include <fstream>
 // #include "utils/tree_file_mgr.h"
 
@@ -18,7 +21,8 @@ extern int yyparse(void);
 
 // #define ENABLE_EXECUTE_DEBUG // debug
 
-ExecuteEngine::ExecuteEngine() {
+ExecuteEngine::ExecuteEngine(size_t buffer_pool_budget)
+        : budget_(buffer_pool_budget > 0 ? buffer_pool_budget : BufferPoolBudget::DetectBudget()) {
   ifstream ifs;
   ifs.open("databases.txt",ios::in);
   if(!ifs.is_open()){
@@ -29,11 +33,25 @@ ExecuteEngine::ExecuteEngine() {
     for(int i = 0;i<size;i++){
       string database_name;
       ifs>>database_name;
-      auto temp = new DBStorageEngine(database_name,false);
-      this->dbs_[database_name] = temp;
+      try {
+        auto temp = OpenDatabase(database_name,false);
+        this->dbs_[database_name] = temp;
+      } catch (const std::runtime_error &e) {
+        // e.g. the file was created by a build with another page size
+        cout<<"Skip database "<<database_name<<": "<<e.what()<<endl;
+      }
     }
     cout<<"Loaded databases."<<endl;
   }
+  budget_.StartAutoTuning();
+}
+
+DBStorageEngine *ExecuteEngine::OpenDatabase(const std::string &db_name, bool init) {
+  // the pool can grow up to the whole budget, only the frames it uses take memory
+  auto db = new DBStorageEngine(db_name, init, budget_.InitialPoolSize(), DEFAULT_BUFFER_POOL_INSTANCES,
+                                DEFAULT_REPLACER_TYPE, budget_.GetBudget());
+  budget_.Register(db->bpm_);
+  return db;
 }
 
 dberr_t ExecuteEngine::Execute(pSyntaxNode ast, ExecuteContext *context) {
@@ -79,6 +97,10 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast, ExecuteContext *context) {
       return ExecuteExecfile(ast, context);
     case kNodeQuit:
       return ExecuteQuit(ast, context);
+    case kNodeSetVariable:
+      return ExecuteSetVariable(ast, context);
+    case kNodeVacuum:
+      return ExecuteVacuum(ast, context);
     default:
       break;
   }
@@ -98,7 +120,7 @@ dberr_t ExecuteEngine::ExecuteCreateDatabase(pSyntaxNode ast, ExecuteContext *co
     cout << "Error: Database " << dbName << " already exists." << endl;
     return DB_FAILED;
   }
-  dbs_.insert(std::make_pair(dbName, new DBStorageEngine(dbName)));
+  dbs_.insert(std::make_pair(dbName, OpenDatabase(dbName, true)));
   long time_end = clock();
   cout << "Database " << dbName << " created." << "  (" << (double)(time_end - time_start)/CLOCKS_PER_SEC  << " sec)" << endl;
 
@@ -116,6 +138,7 @@ dberr_t ExecuteEngine::ExecuteDropDatabase(pSyntaxNode ast, ExecuteContext *cont
     cout << "Error: Database " << dbName << " does not exist." << endl;
     return DB_FAILED;
   }
+  budget_.Unregister(dbs_[dbName]->bpm_);
   delete dbs_[dbName];
   dbs_.erase(dbName);
   long time_end = clock();
@@ -429,13 +452,43 @@ vector<pSyntaxNode> GetChilds(const pSyntaxNode &columnListNode) {
   return columnList;
 }
 
+// new: get a field of a row
+inline const Field &FieldOf(const Row &row, uint32_t index) {
+  return *row.GetField(index);
+}
+
+// new: get a field of a row view, read in place from the page
+inline Field FieldOf(const RowView &row, uint32_t index) {
+  return row.GetField(index);
+}
+
+// new: workers of a full table scan, one per core, fewer for a table too small to give each of them
+// PARALLEL_SCAN_MIN_PAGES pages
+static size_t ScanWorkers(TableInfo *table_info) {
+  return table_info->GetTableHeap()->GetParallelScanWorkers(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+// new: full scan of the table on workers threads (ScanWorkers), through a ring of frames for each of them so the rest
+// of the buffer pool is left alone, the ring taking at most 1/BUFFER_ACCESS_RING_POOL_SHARE of the pool. visit gets
+// the worker it runs on, the tuples of worker 0 come first in the table. false if a page of the table could not be
+// fetched, only part of the table was visited then
+static bool ScanTable(TableInfo *table_info, BufferPoolManager *bpm, size_t workers,
+                      const TableHeap::ParallelScanCallback &visit) {
+  size_t ring_size = std::max<size_t>(1, std::min<size_t>(BUFFER_ACCESS_RING_SIZE * workers,
+                                                          bpm->GetPoolSize() / BUFFER_ACCESS_RING_POOL_SHARE));
+  return table_info->GetTableHeap()->ParallelScan(workers, visit, nullptr,
+                                                  std::make_shared<BufferAccessStrategy>(ring_size));
+}
+
 // new: get the result of a CompareOperator node 
 // operators '=', '<>', '<=', '>=', '<', '>', is, not
-CmpBool GetCompareResult(const pSyntaxNode &ast, const Row &row, TableSchema *schema) {
+template <typename RowType>
+CmpBool GetCompareResult(const pSyntaxNode &ast, const RowType &row, TableSchema *schema) {
   string fieldName = ast->child_->val_;
   uint32_t fieldIndex;
   schema->GetColumnIndex(fieldName, fieldIndex);
   TypeId type = schema->GetColumn(fieldIndex)->GetType();
+  const Field &field = FieldOf(row, fieldIndex);
 
   Field tempField(type); // null now
   if (ast->child_->next_->type_ != kNodeNull){
@@ -444,21 +497,21 @@ CmpBool GetCompareResult(const pSyntaxNode &ast, const Row &row, TableSchema *sc
   }
   
   if (string(ast->val_) == "="){
-    return row.GetField(fieldIndex)->CompareEquals(tempField);
+    return field.CompareEquals(tempField);
   }else if (string(ast->val_) == "<>"){
-    return row.GetField(fieldIndex)->CompareNotEquals(tempField);
+    return field.CompareNotEquals(tempField);
   }else if (string(ast->val_) == "<="){
-    return row.GetField(fieldIndex)->CompareLessThanEquals(tempField);
+    return field.CompareLessThanEquals(tempField);
   }else if (string(ast->val_) == ">="){
-    return row.GetField(fieldIndex)->CompareGreaterThanEquals(tempField);
+    return field.CompareGreaterThanEquals(tempField);
   }else if (string(ast->val_) == "<"){
-    return row.GetField(fieldIndex)->CompareLessThan(tempField);
+    return field.CompareLessThan(tempField);
   }else if (string(ast->val_) == ">"){
-    return row.GetField(fieldIndex)->CompareGreaterThan(tempField);
+    return field.CompareGreaterThan(tempField);
   }else if (string(ast->val_) == "is"){
-    return GetCmpBool(row.GetField(fieldIndex)->IsNull() == tempField.IsNull());
+    return GetCmpBool(field.IsNull() == tempField.IsNull());
   }else if (string(ast->val_) == "not"){
-    return GetCmpBool(row.GetField(fieldIndex)->IsNull() != tempField.IsNull());
+    return GetCmpBool(field.IsNull() != tempField.IsNull());
   }else{
     LOG(ERROR) << "Unknown kNodeCompareOperator val: " << string(ast->val_) << endl;
     return kFalse;
@@ -466,7 +519,8 @@ CmpBool GetCompareResult(const pSyntaxNode &ast, const Row &row, TableSchema *sc
 }
 
 // new: get the result of a node (kTrue, kFalse, kNull)
-CmpBool GetResultOfNode(const pSyntaxNode &ast, const Row &row, TableSchema *schema) {
+template <typename RowType>
+CmpBool GetResultOfNode(const pSyntaxNode &ast, const RowType &row, TableSchema *schema) {
   if (ast == nullptr) {
     LOG(ERROR) << "Unexpected nullptr." << endl;
     return kFalse;
@@ -508,6 +562,30 @@ CmpBool GetResultOfNode(const pSyntaxNode &ast, const Row &row, TableSchema *sch
   return kFalse;
 }
 
+// new: the rows of the table matching the where clause (all rows if it is nullptr), decoded, in the order of the table.
+// false, with no rows, if the scan of the table failed
+static bool ScanRows(TableInfo *table_info, BufferPoolManager *bpm, pSyntaxNode whereNode, TableSchema *schema,
+                     vector<Row *> &rows) {
+  size_t workers = ScanWorkers(table_info);
+  vector<vector<Row *>> worker_rows(workers);
+  bool scanned = ScanTable(table_info, bpm, workers, [&](size_t worker, const RowView &row) {
+    if (whereNode == nullptr || GetResultOfNode(whereNode, row, schema) == kTrue) {
+      worker_rows[worker].push_back(row.ToRow());
+    }
+  });
+  rows.clear();
+  for (auto &part : worker_rows) {
+    if (!scanned) {
+      for (auto row : part) {
+        delete row;
+      }
+      continue;
+    }
+    rows.insert(rows.end(), part.begin(), part.end());
+  }
+  return scanned;
+}
+
 // new: is and connector
 inline bool isAnd(const pSyntaxNode &ast) {
   return ast->type_ == kNodeConnector && string(ast->val_) == "and";
@@ -686,8 +764,8 @@ dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext *context) {
   pSyntaxNode fromNode = selectNode->next_; //things after 'from', like 't1'
   pSyntaxNode whereNode = fromNode->next_; //things after 'where', like 'name = a' (may be null)
 
-  //记录时间
-  long time_start = clock();    //计时开始
+  //记录时间, wall clock time as the scan runs on several threads
+  auto time_start = std::chrono::steady_clock::now();    //计时开始
 
   // 1. from
   string fromTable = fromNode->val_; // from table name
@@ -737,36 +815,46 @@ dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext *context) {
   vector<Row*> result_rows;  // output of canAccelerate
   uint8_t is_accelerated = canAccelerate(whereNode, table_info, dbs_[current_db_]->catalog_mgr_, 
                                          result_rows);
-  if (!is_accelerated){
-    // traverse the table
-    TableIterator iter = table_info->GetTableHeap()->Begin(nullptr);
-    for (; !iter.isNull(); iter++) {
-      result_rows.push_back(iter.GetRow());
-    }
-  }
   bool no_filter = is_accelerated & 0b010 || whereNode == nullptr;
 
   // 2. where filter // todo: not sure about kTrue
-  for (auto &row : result_rows){
-    if (no_filter || GetResultOfNode(whereNode, *row, table_schema) == kTrue) {
+  auto select_row = [&](const auto &row, vector<vector<string>> &lines) {
+    if (no_filter || GetResultOfNode(whereNode, row, table_schema) == kTrue) {
       // 3. select
       vector<string> result_line;
-      std::vector<Field *> fields = row->GetFields();
       if (if_select_all){
-        for (size_t i = 0; i < fields.size(); i++) {
-          result_line.push_back(fields[i]->ToString(float_precision));
+        for (size_t i = 0; i < row.GetFieldCount(); i++) {
+          result_line.push_back(FieldOf(row, i).ToString(float_precision));
         }
       }else{
         for (auto &i : selectColumnIndexs){
-          result_line.push_back(fields[i]->ToString(float_precision));
+          result_line.push_back(FieldOf(row, i).ToString(float_precision));
         }
       }
-      select_result.push_back(result_line);
-      select_count++;
+      lines.push_back(std::move(result_line));
+    }
+  };
+  if (!is_accelerated){
+    // traverse the table on every core. the rows are filtered and projected in place in their pages, none is
+    // decoded into a Row. each worker has its lines, put together in the order of the table
+    size_t workers = ScanWorkers(table_info);
+    vector<vector<vector<string>>> worker_results(workers);
+    if (!ScanTable(table_info, dbs_[current_db_]->bpm_, workers, [&](size_t worker, const RowView &row) {
+      select_row(row, worker_results[worker]);
+    })) {
+      cout << "Error: Scan of table " << table_info->GetTableName() << " failed." << endl;
+      return DB_FAILED;
+    }
+    for (auto &lines : worker_results){
+      std::move(lines.begin(), lines.end(), back_inserter(select_result));
     }
   }
+  for (auto &row : result_rows){
+    select_row(*row, select_result);
+  }
+  select_count = select_result.size();
 
-  long time_end = clock(); // end timing
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - time_start; // end timing
 
   // old print:
   // // print the first line (column names) (if result not empty)
@@ -817,7 +905,7 @@ dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext *context) {
     cout<<endl;
   }
 
-  cout << select_count << " rows in set (" << (double)(time_end - time_start)/CLOCKS_PER_SEC  << " sec)" << endl;
+  cout << select_count << " rows in set (" << elapsed.count() << " sec)" << endl;
   
   return DB_SUCCESS;
 }
@@ -897,9 +985,20 @@ dberr_t ExecuteEngine::ExecuteInsert(pSyntaxNode ast, ExecuteContext *context) {
   }
   Row row(fields);
 
-  // 4. insert
+  // 4. insert, in a file together with the inserts around it
+  if (context->batch_inserts_) {
+    if (context->batch_table_ != table_info) {
+      FlushInsertBatch(context);
+      context->batch_table_ = table_info;
+    }
+    context->batch_rows_.emplace_back(row);
+    if (context->batch_rows_.size() >= static_cast<size_t>(INSERT_BATCH_SIZE)) {
+      return FlushInsertBatch(context);
+    }
+    return DB_SUCCESS;
+  }
   auto cat = dbs_[current_db_]->catalog_mgr_;
-  ret = cat->Insert(table_info, row, nullptr);
+  ret = cat->Insert(table_info, row, nullptr, context->bulk_strategy_.get());
   if (ret == DB_PK_DUPLICATE){
     cout << "Error: Primary key duplicate." << endl;
     return DB_FAILED;
@@ -916,6 +1015,34 @@ dberr_t ExecuteEngine::ExecuteInsert(pSyntaxNode ast, ExecuteContext *context) {
   return DB_SUCCESS;
 }
 
+dberr_t ExecuteEngine::FlushInsertBatch(ExecuteContext *context) {
+  if (context->batch_rows_.empty()) {
+    return DB_SUCCESS;
+  }
+  long time_start = clock();
+  vector<dberr_t> results;
+  dberr_t ret = dbs_[current_db_]->catalog_mgr_->InsertBatch(context->batch_table_, context->batch_rows_, nullptr,
+                                                              &results, context->bulk_strategy_.get());
+  size_t inserted = 0;
+  for (auto result : results) {
+    if (result == DB_PK_DUPLICATE){
+      cout << "Error: Primary key duplicate." << endl;
+    }else if (result == DB_UNI_KEY_DUPLICATE){
+      cout << "Error: Unique key duplicate." << endl;
+    }else if (result == DB_TUPLE_TOO_LARGE){
+      cout << "Error: Tuple too large." << endl;
+    }else{
+      inserted++;
+    }
+  }
+  context->batch_rows_.clear();
+  context->batch_table_ = nullptr;
+  long time_end = clock();
+  cout << "Query OK, " << inserted << " rows affected (" << (double)(time_end - time_start)/CLOCKS_PER_SEC << " sec)"
+       << endl;
+  return ret == DB_SUCCESS ? DB_SUCCESS : DB_FAILED;
+}
+
 dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext *context) {
 #ifdef ENABLE_EXECUTE_DEBUG
   LOG(INFO) << "ExecuteDelete" << std::endl;
@@ -946,13 +1073,14 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext *context) {
   uint8_t is_accelerated = canAccelerate(whereNode, table_info, cat, 
                                          result_rows);
   if (!is_accelerated){
-    // traverse the table
-    TableIterator iter = table_info->GetTableHeap()->Begin(nullptr);
-    for (; !iter.isNull(); iter++) {
-      result_rows.push_back(iter.GetRow());
+    // traverse the table on every core. the rows are filtered in place in their pages, only the ones passing are
+    // decoded
+    if (!ScanRows(table_info, dbs_[current_db_]->bpm_, whereNode, table_schema, result_rows)) {
+      cout << "Error: Scan of table " << table_info->GetTableName() << " failed." << endl;
+      return DB_FAILED;
     }
   }
-  bool no_filter = is_accelerated & 0b010 || whereNode == nullptr;
+  bool no_filter = !is_accelerated || is_accelerated & 0b010 || whereNode == nullptr;
 
   // 2. where filter // todo: not sure about kTrue
   for (auto &row : result_rows){
@@ -1004,13 +1132,14 @@ dberr_t ExecuteEngine::ExecuteUpdate(pSyntaxNode ast, ExecuteContext *context) {
   uint8_t is_accelerated = canAccelerate(whereNode, table_info, cat, 
                                          result_rows);
   if (!is_accelerated){
-    // traverse the table
-    TableIterator iter = table_info->GetTableHeap()->Begin(nullptr);
-    for (; !iter.isNull(); iter++) {
-      result_rows.push_back(iter.GetRow());
+    // traverse the table on every core. the rows are filtered in place in their pages, only the ones passing are
+    // decoded
+    if (!ScanRows(table_info, dbs_[current_db_]->bpm_, whereNode, table_schema, result_rows)) {
+      cout << "Error: Scan of table " << table_info->GetTableName() << " failed." << endl;
+      return DB_FAILED;
     }
   }
-  bool no_filter = is_accelerated & 0b010 || whereNode == nullptr;
+  bool no_filter = !is_accelerated || is_accelerated & 0b010 || whereNode == nullptr;
 
   // 2. where filter // todo: not sure about kTrue
   for (auto &old_row : result_rows){
@@ -1134,6 +1263,15 @@ dberr_t ExecuteEngine::ExecuteExecfile(pSyntaxNode ast, ExecuteContext *context)
   }
   const int buf_size = 1024;
   char cmd[buf_size];
+  // the inserts of the file are a bulk load, the table pages they fill go through a ring of frames
+  auto outer_strategy = context->bulk_strategy_;
+  if (outer_strategy == nullptr) {
+    context->bulk_strategy_ = std::make_shared<BufferAccessStrategy>();
+  }
+  // and go to the table and its indexes a batch at a time
+  bool outer_batch_inserts = context->batch_inserts_;
+  context->batch_inserts_ = true;
+  context->batch_rows_.reserve(INSERT_BATCH_SIZE);
   // repeat until EOF
   memset(cmd, 0, buf_size);
   while (1) {
@@ -1215,7 +1353,12 @@ dberr_t ExecuteEngine::ExecuteExecfile(pSyntaxNode ast, ExecuteContext *context)
       printf("%s\n", MinisqlParserGetErrorMessage());
     }
 
-    this->Execute(MinisqlGetParserRootNode(), context);
+    // the statements after the inserts see their rows
+    pSyntaxNode root = MinisqlGetParserRootNode();
+    if (root == nullptr || root->type_ != kNodeInsert) {
+      FlushInsertBatch(context);
+    }
+    this->Execute(root, context);
     // sleep(1); // probably not needed
     // clean memory after parse
     MinisqlParserFinish();
@@ -1229,6 +1372,9 @@ dberr_t ExecuteEngine::ExecuteExecfile(pSyntaxNode ast, ExecuteContext *context)
     }
   }
   cmdIn.close();
+  FlushInsertBatch(context);
+  context->batch_inserts_ = outer_batch_inserts;
+  context->bulk_strategy_ = outer_strategy;
   return DB_SUCCESS;
 }
 
@@ -1249,3 +1395,64 @@ dberr_t ExecuteEngine::ExecuteQuit(pSyntaxNode ast, ExecuteContext *context) {
   }
   return DB_SUCCESS;
 }
+
+dberr_t ExecuteEngine::ExecuteSetVariable(pSyntaxNode ast, ExecuteContext *context) {
+#ifdef ENABLE_EXECUTE_DEBUG
+  LOG(INFO) << "ExecuteSetVariable" << std::endl;
+#endif
+  string name = ast->child_->val_;
+  string value = ast->child_->next_->val_;
+  if (name != "buffer_pool_size") {
+    cout << "Error: Unknown variable " << name << "." << endl;
+    return DB_FAILED;
+  }
+  if (dbs_.find(current_db_) == dbs_.end()) {
+    cout << "Error: No database selected." << endl;
+    return DB_FAILED;
+  }
+  if (value.find_first_not_of("0123456789") != string::npos) {
+    cout << "Error: buffer_pool_size must be a number of frames." << endl;
+    return DB_FAILED;
+  }
+  size_t pool_size = stoul(value);
+  BufferPoolManager *bpm = dbs_[current_db_]->bpm_;
+  if (!budget_.SetPoolSize(bpm, pool_size)) {
+    cout << "Error: Cannot resize the buffer pool of " << current_db_ << " to " << pool_size
+         << " frames, the budget of all databases is " << budget_.GetBudget() << " frames." << endl;
+    return DB_FAILED;
+  }
+  if (pool_size == 0) {
+    cout << "Buffer pool of " << current_db_ << " is tuned automatically (" << bpm->GetPoolSize() << " frames)."
+         << endl;
+  } else {
+    cout << "Buffer pool of " << current_db_ << " resized to " << pool_size << " frames." << endl;
+  }
+  return DB_SUCCESS;
+}
+
+dberr_t ExecuteEngine::ExecuteVacuum(pSyntaxNode ast, ExecuteContext *context) {
+#ifdef ENABLE_EXECUTE_DEBUG
+  LOG(INFO) << "ExecuteVacuum" << std::endl;
+#endif
+  string tableName = ast->child_->val_;   //vacuum <表名>
+  if (dbs_.find(current_db_) == dbs_.end()) {
+    cout << "Error: No database selected." << endl;
+    return DB_FAILED;
+  }
+  TableInfo *tf = nullptr;
+  if (dbs_[current_db_]->catalog_mgr_->GetTable(tableName, tf) != DB_SUCCESS) {
+    cout << "Error: Can't find " << tableName << "." << endl;
+    return DB_TABLE_NOT_EXIST;
+  }
+  long time_start = clock();
+  VacuumStats stats;
+  if (dbs_[current_db_]->catalog_mgr_->Vacuum(tableName, nullptr, &stats) != DB_SUCCESS) {
+    cout << "Error: Can't vacuum " << tableName << "." << endl;
+    return DB_FAILED;
+  }
+  long time_end = clock();
+  cout << "Table " << tableName << " vacuumed: " << stats.pages_before_ << " pages -> " << stats.pages_after_
+       << " pages, " << stats.rows_moved_ << " rows moved, " << stats.pages_truncated_
+       << " pages returned to the file system. (" << (time_end - time_start)*1.0/CLOCKS_PER_SEC << " sec)" << endl;
+  return DB_SUCCESS;
+}
@@ -0,0 +1,60 @@
+#ifndef MINISQL_BUFFER_ACCESS_STRATEGY_H
+#define MINISQL_BUFFER_ACCESS_STRATEGY_H
+
+#include <mutex>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+class BufferPoolManager;
+
+/**
+ * BufferAccessStrategy keeps a bulk operation (a full scan, a mass insert, populating an index) from
+ * churning the whole buffer pool.
+ *
+ * The caller passes it to FetchPage/NewPage. A page that has to be brought into the pool then goes into
+ * the frame the strategy used ring_size pages ago, as long as that frame still holds the page put there
+ * and is unpinned, so the operation cycles through a small private ring of frames instead of evicting
+ * the working set of everybody else. Pages that are already in the pool are used as they are.
+ * A strategy can be shared by the caller and the prefetcher, but it belongs to one operation.
+ */
+class BufferAccessStrategy {
+  friend class BufferPoolManager;
+
+public:
+  explicit BufferAccessStrategy(size_t ring_size = BUFFER_ACCESS_RING_SIZE);
+
+  DISALLOW_COPY(BufferAccessStrategy)
+
+  /** @return the number of frames in the ring */
+  inline size_t GetRingSize() const { return ring_.size(); }
+
+  /** @return the number of times a frame of the ring was recycled */
+  size_t GetReuseCount();
+
+private:
+  struct Slot {
+    const BufferPoolManager *bpm_;  // pool owning the frame, nullptr if the slot is empty
+    frame_id_t frame_id_;
+    page_id_t page_id_;             // page put into the frame
+  };
+
+  /**
+   * @param[out] frame_id the frame in the current slot
+   * @param[out] page_id the page put into it
+   * @return false if the slot is empty or holds a frame of another pool
+   */
+  bool Current(const BufferPoolManager *bpm, frame_id_t *frame_id, page_id_t *page_id);
+
+  /** Remember the frame page_id went into in the current slot and move on to the next slot. */
+  void Put(const BufferPoolManager *bpm, frame_id_t frame_id, page_id_t page_id, bool recycled);
+
+private:
+  std::mutex latch_;
+  std::vector<Slot> ring_;
+  size_t current_{0};
+  size_t reuse_count_{0};
+};
+
+#endif  // MINISQL_BUFFER_ACCESS_STRATEGY_H
@@ -0,0 +1,116 @@
+#ifndef MINISQL_BUFFER_POOL_BUDGET_H
+#define MINISQL_BUFFER_POOL_BUDGET_H
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+/**
+ * BufferPoolBudget shares one memory budget, counted in frames, between the buffer pools of all open
+ * databases.
+ *
+ * Registered pools are resized online within the budget. A pool is either tuned automatically, where
+ * frames move towards the pools with a low hit ratio, or has a fixed size set with SetPoolSize. A pool
+ * never shrinks below the minimum pool size by auto tuning, and a fixed size is only granted if enough
+ * frames are spare or can be taken from the automatically tuned pools.
+ */
+class BufferPoolBudget {
+public:
+  /**
+   * @param budget_frames the number of frames all registered pools hold together
+   * @param min_pool_size the size auto tuning never shrinks a pool below
+   */
+  explicit BufferPoolBudget(size_t budget_frames, size_t min_pool_size = MIN_BUFFER_POOL_SIZE);
+
+  DISALLOW_COPY(BufferPoolBudget)
+
+  ~BufferPoolBudget();
+
+  /**
+   * @return a share (1 / BUFFER_POOL_CGROUP_SHARE) of the memory limit of the cgroup this process runs
+   * in, in frames, or DEFAULT_BUFFER_POOL_BUDGET if there is no limit
+   */
+  static size_t DetectBudget();
+
+  /** @return the number of frames a pool opened now should start with */
+  size_t InitialPoolSize();
+
+  /**
+   * Count the frames of bpm against the budget and tune it automatically. Other pools are shrunk if
+   * bpm does not fit in the spare frames.
+   */
+  void Register(BufferPoolManager *bpm);
+
+  /** Stop accounting bpm, call it before bpm is deleted. Its frames become spare. */
+  void Unregister(BufferPoolManager *bpm);
+
+  /**
+   * Resize bpm to pool_size frames and exclude it from auto tuning, or hand it back to auto tuning if
+   * pool_size is 0. Missing frames are taken from the spare ones first, then from automatically tuned pools.
+   * @return false if bpm is not registered or pool_size cannot be granted
+   */
+  bool SetPoolSize(BufferPoolManager *bpm, size_t pool_size);
+
+  /**
+   * One round of auto tuning: pools whose hit ratio since the last round is below BUFFER_POOL_GROW_HIT_RATIO
+   * grow, with spare frames or frames taken from pools that hit more often or were idle.
+   * @return the number of pools grown
+   */
+  size_t Rebalance();
+
+  /**
+   * Start a thread calling Rebalance every interval_ms.
+   */
+  void StartAutoTuning(uint32_t interval_ms = BUFFER_POOL_TUNE_INTERVAL_MS);
+
+  /**
+   * Stop the auto tuning thread (if any) and wait for it to exit.
+   */
+  void StopAutoTuning();
+
+  /** @return the number of frames of the budget */
+  size_t GetBudget() const { return budget_; }
+
+  /** @return the number of frames held by the registered pools */
+  size_t GetUsed();
+
+private:
+  struct PoolState {
+    BufferPoolManager *bpm_;
+    bool fixed_;          // size set by SetPoolSize, not tuned automatically
+    size_t last_hits_;    // counters at the last round of auto tuning
+    size_t last_misses_;
+  };
+
+  /** The caller must hold latch_. */
+  size_t UsedFrames() const;
+
+  /** The caller must hold latch_. @return the state of bpm, nullptr if it is not registered */
+  PoolState *FindPool(BufferPoolManager *bpm);
+
+  /**
+   * Shrink the donor pools, largest first, by up to frames frames altogether, taking at most max_share of
+   * a pool and keeping at least min_pool_size_ frames. The caller must hold latch_.
+   * @return the number of frames freed
+   */
+  size_t Reclaim(size_t frames, std::vector<PoolState *> donors, double max_share);
+
+  void AutoTuningLoop(uint32_t interval_ms);
+
+private:
+  size_t budget_;                             // frames shared by all pools
+  size_t min_pool_size_;
+  std::mutex latch_;                          // to protect pools_ and to serialize resizing
+  std::vector<PoolState> pools_;
+  std::thread tuner_;                         // auto tuning, if started
+  std::mutex tuner_mutex_;                    // to protect tuner_stop_
+  std::condition_variable tuner_cv_;
+  bool tuner_stop_{false};
+};
+
+#endif  // MINISQL_BUFFER_POOL_BUDGET_H
@@ -1,11 +1,21 @@
 #ifndef MINISQL_BUFFER_POOL_MANAGER_H
 #define MINISQL_BUFFER_POOL_MANAGER_H
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <list>
+#include <memory>
 #include <mutex>
-#include <unordered_map>
+#include <thread>
+#include <vector>
 
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/page_guard.h"
+#include "buffer/page_table.h"
 #include "page/page.h"
 #include "page/disk_file_meta_page.h"
 #include "storage/disk_manager.h"
@@ -13,24 +23,190 @@
 using namespace std;
 
 class BufferPoolManager {
+  // the parallel manager installs pages whose id was allocated before the shard is known
+  friend class ParallelBufferPoolManager;
+
 public:
-  explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager);
+  /** Reads the id of the next page in a page chain out of the raw content of a page. */
+  using NextPageIdFunc = page_id_t (*)(const char *page_data);
+
+  /**
+   * @param pool_size the number of frames the pool starts with
+   * @param max_pool_size the number of frames the pool can grow to with Resize, pool_size if 0.
+   *        Only the address space of the extra frames and their metadata is reserved until the pool grows.
+   */
+  explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager,
+                             ReplacerType replacer_type = DEFAULT_REPLACER_TYPE, size_t max_pool_size = 0);
+
+  virtual ~BufferPoolManager();
+
+  /**
+   * @param strategy if not nullptr, a page that is not in the pool is read into a frame of its ring
+   */
+  virtual Page *FetchPage(page_id_t page_id, BufferAccessStrategy *strategy = nullptr);
+
+  virtual bool UnpinPage(page_id_t page_id, bool is_dirty);
+
+  virtual bool FlushPage(page_id_t page_id);
+
+  /**
+   * @param strategy if not nullptr, the new page is put into a frame of its ring
+   */
+  virtual Page *NewPage(page_id_t &page_id, BufferAccessStrategy *strategy = nullptr);
+
+  virtual bool DeletePage(page_id_t page_id);
 
-  ~BufferPoolManager();
+  /**
+   * Fetch a page for reading, it is unpinned clean when the guard is released.
+   * The guard is empty if the page could not be brought into the pool.
+   */
+  ReadPageGuard FetchPageRead(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) {
+    return {this, FetchPage(page_id, strategy)};
+  }
 
-  Page *FetchPage(page_id_t page_id);
+  /**
+   * Fetch a page for writing, it is unpinned dirty when the guard is released.
+   */
+  WritePageGuard FetchPageWrite(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) {
+    return {this, FetchPage(page_id, strategy)};
+  }
+
+  /**
+   * Allocate a new page like NewPage, it is unpinned dirty when the guard is released.
+   */
+  WritePageGuard NewPageGuarded(page_id_t &page_id, BufferAccessStrategy *strategy = nullptr) {
+    return {this, NewPage(page_id, strategy)};
+  }
 
-  bool UnpinPage(page_id_t page_id, bool is_dirty);
+  /**
+   * Allocate a new page like NewPage, from the run of contiguous pages the disk manager reserves for owner
+   * (a table heap, a B+ tree), see DiskManager::AllocatePage.
+   */
+  Page *NewPageFor(const void *owner, page_id_t &page_id, BufferAccessStrategy *strategy = nullptr);
 
-  bool FlushPage(page_id_t page_id);
+  WritePageGuard NewPageGuardedFor(const void *owner, page_id_t &page_id, BufferAccessStrategy *strategy = nullptr) {
+    return {this, NewPageFor(owner, page_id, strategy)};
+  }
 
-  Page *NewPage(page_id_t &page_id);
+  /**
+   * Allocate count new pages with consecutive page ids, contiguous in the file, and pin them all.
+   * @param[out] pages the new pages, in page id order
+   * @return false, allocating nothing, if count is more than an extent holds or the pages do not fit into the pool
+   */
+  bool NewPages(size_t count, std::vector<Page *> &pages, BufferAccessStrategy *strategy = nullptr);
 
-  bool DeletePage(page_id_t page_id);
+  /**
+   * Free the pages reserved for owner and not used yet, e.g. when its table is dropped.
+   */
+  void ReleasePages(const void *owner) { disk_manager_->ReleasePages(owner); }
 
-  bool IsPageFree(page_id_t page_id);
+  /**
+   * Shrink the files by their empty extents at the end, see DiskManager::TruncateFreeExtents.
+   * Waits for the background write in flight, if any.
+   * @return the number of pages the files shrank by
+   */
+  virtual size_t TruncateFreeExtents();
+
+  /**
+   * Give a new table heap or index a file of its own if file per object is on, see DiskManager::CreateTablespace.
+   */
+  void CreateTablespace(const void *owner, uint32_t tablespace_id) {
+    disk_manager_->CreateTablespace(owner, tablespace_id);
+  }
+
+  /**
+   * Put the new pages of a table heap or index loaded from disk into the file of page_id, one of its pages.
+   */
+  void OpenTablespace(const void *owner, page_id_t page_id) { disk_manager_->OpenTablespace(owner, page_id); }
+
+  /**
+   * If owner has a file of its own, drop its pages from the pool without writing them back and unlink the file.
+   * @return false if the pages of owner are in the database file, they have to be deleted one by one
+   */
+  bool DropTablespace(const void *owner);
+
+  virtual bool IsPageFree(page_id_t page_id);
+
+  virtual bool CheckAllUnpinned();
+
+  /**
+   * Checkpoint: write every dirty page back to disk, in page id order, then let the disk manager make
+   * them durable according to its durability policy.
+   */
+  virtual void FlushAllPages();
+
+  /**
+   * Start a thread that keeps at least target_clean_frames frames free or clean and unpinned, so the
+   * request path rarely has to write back a dirty victim itself. Dirty unpinned pages are written in
+   * page id order. The thread wakes up every interval_ms, or earlier when a victim had to be written.
+   */
+  virtual void StartBackgroundWriter(size_t target_clean_frames, uint32_t interval_ms = BG_WRITER_INTERVAL_MS);
+
+  /**
+   * Stop the background writer thread (if any) and wait for it to exit.
+   */
+  virtual void StopBackgroundWriter();
+
+  /**
+   * Asynchronously load pages into unpinned frames, so a later FetchPage is a hit.
+   * Pages already in the pool are skipped. This is only a hint and may be dropped.
+   */
+  void Prefetch(const std::vector<page_id_t> &page_ids);
+
+  /**
+   * Asynchronously load up to distance pages of a page chain, starting at page_id and following
+   * next_page_id (e.g. TablePage::NextPageIdOf) until it returns INVALID_PAGE_ID.
+   * The pages go into the ring of strategy if it is not nullptr, the request keeps it alive.
+   */
+  void Prefetch(page_id_t page_id, size_t distance, NextPageIdFunc next_page_id,
+                std::shared_ptr<BufferAccessStrategy> strategy = nullptr);
 
-  bool CheckAllUnpinned();
+  /** @return the number of pages loaded by Prefetch */
+  virtual size_t GetPrefetchCount() { return prefetch_count_; }
+
+  /**
+   * Grow or shrink the pool online, up to GetMaxPoolSize() frames.
+   * Growing only adds free frames. Shrinking removes the frames at the end of the pool: their pages are
+   * written back if dirty and dropped, and their memory is given back to the kernel.
+   * @return false (and nothing changes) if the size is out of range or a frame to remove is pinned
+   */
+  virtual bool Resize(size_t pool_size);
+
+  /** @return the number of frames managed by this buffer pool */
+  virtual size_t GetPoolSize() { return pool_size_; }
+
+  /** @return the number of frames the pool can be resized to at most */
+  virtual size_t GetMaxPoolSize() { return max_pool_size_; }
+
+  /** @return the number of FetchPage calls served from the pool */
+  virtual size_t GetHitCount() { return hit_count_; }
+
+  /** @return the number of FetchPage calls that had to read the page from disk */
+  virtual size_t GetMissCount() { return miss_count_; }
+
+protected:
+  /**
+   * Used by subclasses that do not own any frame themselves (e.g. ParallelBufferPoolManager).
+   */
+  explicit BufferPoolManager(DiskManager *disk_manager);
+
+  /**
+   * If page_id is in the pool, read the id of the next page of its chain.
+   * @param[out] next the id read by next_page_id (INVALID_PAGE_ID if nullptr) from the page
+   * @param[out] write_backs if the page is not in the pool, what PrefetchInstall needs to know
+   * @return true if the page is in the pool
+   */
+  virtual bool PrefetchLookup(page_id_t page_id, NextPageIdFunc next_page_id, page_id_t *next,
+                              size_t *write_backs);
+
+  /**
+   * Load the content of page_id read from disk into an unpinned frame, unless the page was brought into the
+   * pool, or written back from it (as a victim, by a flush or by the background writer), since PrefetchLookup
+   * returned write_backs: the content read may be older than the one on disk.
+   * @return false if no frame could be taken
+   */
+  virtual bool PrefetchInstall(page_id_t page_id, const char *data, size_t write_backs,
+                               BufferAccessStrategy *strategy);
 
 private:
   /**
@@ -43,15 +219,123 @@ private:
    */
   void DeallocatePage(page_id_t page_id);
 
+  /**
+   * Take a frame from the free list, or evict a victim chosen by the replacer (writing it back if dirty).
+   * The caller must hold latch_.
+   * @return false if all frames are pinned
+   */
+  bool AcquireFrame(frame_id_t *frame_id);
+
+  /**
+   * Take the frame in the current slot of the ring of strategy, if it still holds the page the strategy
+   * put there and nobody uses it (writing the page back if dirty). The caller must hold latch_ and call
+   * strategy->Put once the frame got its new page.
+   * @return false if the frame can not be recycled, AcquireFrame has to be used
+   */
+  bool AcquireRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id);
+
+  /**
+   * Construct the metadata of the frames up to num_frames and make room for them in the structures indexed by
+   * frame id or holding a page per frame. The caller must hold latch_.
+   */
+  void GrowFrames(size_t num_frames);
+
+  /**
+   * Bring an already allocated page into a zeroed, pinned frame.
+   * @return nullptr if all frames are pinned
+   */
+  virtual Page *NewPageWithId(page_id_t page_id, BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * Drop every page of a tablespace from the pool, pinned or dirty or not. Waits for the background write in
+   * flight, if any.
+   */
+  virtual void DiscardTablespacePages(uint32_t tablespace_id);
+
+  /**
+   * Write every dirty page back to disk, in page id order, without a checkpoint of the disk manager.
+   * The caller must hold write_back_latch_.
+   */
+  void FlushDirtyPages();
+
+  /**
+   * Add the dirty pages in the pool to pages, counted as written back. The caller must hold latch_ until they
+   * are written.
+   */
+  void CollectDirtyPages(std::vector<Page *> &pages);
+
+  /**
+   * Write pages back with one DiskManager::WritePages, neighbouring pages in one system call, and mark them
+   * clean. The caller must hold the latches of the pools of the pages.
+   */
+  void WriteDirtyPages(const std::vector<Page *> &pages);
+
+  void BackgroundWriterLoop(uint32_t interval_ms);
+
+  /**
+   * One round of the background writer.
+   * @return the number of pages written
+   */
+  size_t BackgroundFlush();
+
+  /** Count a page written back, remembering its page id. The caller must hold latch_. */
+  void RecordWriteBack(page_id_t page_id);
+
+  /**
+   * The caller must hold latch_.
+   * @return true if page_id may have been written back since write_backs_ was write_backs
+   */
+  bool WrittenBackSince(page_id_t page_id, size_t write_backs);
+
+  void PrefetchLoop();
+
+  void StopPrefetcher();
+
+  struct PrefetchRequest;
+
+  /**
+   * Follow the chains of the requests, reading the pages missing from the pool asynchronously.
+   */
+  void PrefetchBatch(std::vector<PrefetchRequest> &requests);
+
 
 private:
   size_t pool_size_;                                        // number of pages in buffer pool
-  Page *pages_;                                             // array of pages
+  size_t max_pool_size_;                                    // number of frames reserved for Resize
+  FrameArena arena_;                                        // page data of all frames, aligned
+  Page *pages_;                                             // array of pages, i.e. the frame metadata
+  size_t num_frames_{0};                                    // frames whose metadata is constructed
   DiskManager *disk_manager_;                               // pointer to the disk manager.
-  std::unordered_map<page_id_t, frame_id_t> page_table_;    // to keep track of pages
+  PageTable page_table_;                                    // to keep track of pages
   Replacer *replacer_;                                      // to find an unpinned page for replacement
   std::list<frame_id_t> free_list_;                         // to find a free page for replacement
   recursive_mutex latch_;                                   // to protect shared data structure
+  std::atomic<size_t> hit_count_{0};                        // FetchPage hits, read without latch_
+  std::atomic<size_t> miss_count_{0};                       // FetchPage misses, read without latch_
+  std::thread bg_writer_;                                   // background writer, if started
+  std::mutex bg_mutex_;                                     // to protect the two fields below
+  std::condition_variable bg_cv_;                           // to wake up or stop the background writer
+  bool bg_stop_{false};
+  size_t bg_target_clean_{0};                               // frames the background writer keeps clean
+  std::vector<bool> flushing_;                              // frames being written by the background writer
+  // held by the background writer from the snapshot of a batch until it is on disk, and by the other writes and
+  // deletes of pages, so an older snapshot never lands on disk after them. Taken before latch_
+  std::mutex write_back_latch_;
+  static constexpr size_t WRITE_BACK_HISTORY = 256;        // holds a batch of the background writer
+  size_t write_backs_{0};                                   // pages written back, see PrefetchInstall
+  page_id_t written_back_pages_[WRITE_BACK_HISTORY];        // the last of them
+  struct PrefetchRequest {
+    page_id_t page_id_;
+    size_t distance_;
+    NextPageIdFunc next_page_id_;
+    std::shared_ptr<BufferAccessStrategy> strategy_;
+  };
+  std::thread prefetcher_;                                  // started by the first Prefetch
+  std::mutex prefetch_mutex_;                               // to protect the two fields below
+  std::condition_variable prefetch_cv_;
+  std::deque<PrefetchRequest> prefetch_queue_;
+  bool prefetch_stop_{false};
+  std::atomic<size_t> prefetch_count_{0};                   // pages loaded by the prefetcher
 };
 
 #endif  // MINISQL_BUFFER_POOL_MANAGER_H
@@ -0,0 +1,48 @@
+#ifndef MINISQL_FRAME_ARENA_H
+#define MINISQL_FRAME_ARENA_H
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+/**
+ * FrameArena is the memory holding the content of all frames of a buffer pool.
+ *
+ * It is one anonymous mapping, so every frame is PAGE_SIZE aligned (as O_DIRECT requires), and
+ * frames are contiguous instead of interleaved with the frame metadata kept in the Page objects.
+ * Mappings of at least one huge page are aligned to HUGE_PAGE_SIZE and advised with MADV_HUGEPAGE,
+ * so a large pool is covered by a few TLB entries.
+ * The mapping only reserves address space: a frame takes memory when it is first used, and gives it
+ * back to the kernel when it is released, so a resizable pool can reserve its maximum size up front.
+ */
+class FrameArena {
+public:
+  DISALLOW_COPY(FrameArena)
+
+  explicit FrameArena(size_t num_frames);
+
+  ~FrameArena();
+
+  /** @return the PAGE_SIZE bytes of frame_id */
+  inline char *GetFrame(frame_id_t frame_id) { return data_ + static_cast<size_t>(frame_id) * PAGE_SIZE; }
+
+  /**
+   * Give the memory of count frames starting at first back to the kernel, the frames read as zeros
+   * afterwards and take memory again when they are next written.
+   */
+  void Release(frame_id_t first, size_t count);
+
+  /** @return true if the kernel accepted the huge page advice */
+  inline bool IsHugePageAdvised() const { return huge_page_advised_; }
+
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+private:
+  char *data_{nullptr};       // first frame, aligned
+  void *mapping_{nullptr};    // start of the mapping, before alignment
+  size_t mapping_size_{0};
+  bool huge_page_advised_{false};
+};
+
+#endif  // MINISQL_FRAME_ARENA_H
@@ -0,0 +1,72 @@
+#ifndef MINISQL_LRU_K_REPLACER_H
+#define MINISQL_LRU_K_REPLACER_H
+
+#include <list>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+using namespace std;
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * The victim is the evictable frame whose K-th most recent access is the oldest. Frames with fewer
+ * than K recorded accesses have an infinite backward K-distance and are always evicted first, oldest
+ * access first. A page touched once by a full table scan therefore never pushes out pages that are
+ * hit again and again, such as the inner pages of a B+ tree.
+ *
+ * Back-to-back accesses to the same frame (e.g. a table iterator fetching the same page once per row)
+ * are correlated references and only refresh the latest access instead of adding to the history.
+ */
+class LRUKReplacer : public Replacer {
+public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of accesses kept per frame
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = LRU_K_REPLACER_K);
+
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+private:
+  struct FrameEntry {
+    list<size_t> history_;  // timestamps of the last (at most) k accesses, oldest first
+    bool evictable_{false};
+  };
+
+  /** @return the queue an evictable frame belongs to, decided by the length of its history */
+  set<pair<size_t, frame_id_t>> &QueueOf(const FrameEntry &entry) {
+    return entry.history_.size() < k_ ? history_queue_ : cache_queue_;
+  }
+
+  void Enqueue(frame_id_t frame_id, const FrameEntry &entry);
+
+  void Dequeue(frame_id_t frame_id, const FrameEntry &entry);
+
+private:
+  size_t k_;
+  size_t current_timestamp_{0};
+  frame_id_t last_accessed_{INVALID_FRAME_ID};
+  unordered_map<frame_id_t, FrameEntry> frames_;
+  set<pair<size_t, frame_id_t>> history_queue_;  // evictable frames with less than k accesses
+  set<pair<size_t, frame_id_t>> cache_queue_;    // evictable frames with k accesses
+};
+
+#endif  // MINISQL_LRU_K_REPLACER_H
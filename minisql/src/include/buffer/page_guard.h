@@ -0,0 +1,81 @@
+#ifndef MINISQL_PAGE_GUARD_H
+#define MINISQL_PAGE_GUARD_H
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "page/page.h"
+
+class BufferPoolManager;
+
+/**
+ * ReadPageGuard keeps a page pinned for as long as it lives and unpins it clean when it goes out of scope.
+ *
+ * Guards are move-only, so exactly one of them owns the pin. They only manage the pin count and the dirty
+ * flag, taking the page latch is still up to the caller.
+ */
+class ReadPageGuard {
+public:
+  ReadPageGuard() = default;
+
+  /** Adopt a page already pinned through bpm, page can be nullptr for an empty guard */
+  ReadPageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+
+  DISALLOW_COPY(ReadPageGuard)
+
+  ReadPageGuard(ReadPageGuard &&that) noexcept;
+
+  ReadPageGuard &operator=(ReadPageGuard &&that) noexcept;
+
+  ~ReadPageGuard() { Drop(); }
+
+  /** Unpin the page now, the guard is empty afterwards */
+  void Drop();
+
+  inline bool IsValid() const { return page_ != nullptr; }
+
+  inline page_id_t PageId() const { return page_->GetPageId(); }
+
+  inline Page *GetPage() const { return page_; }
+
+  inline const char *GetData() const { return page_->GetData(); }
+
+private:
+  BufferPoolManager *bpm_{nullptr};
+  Page *page_{nullptr};
+};
+
+/**
+ * WritePageGuard keeps a page pinned for as long as it lives and unpins it dirty when it goes out of scope.
+ */
+class WritePageGuard {
+public:
+  WritePageGuard() = default;
+
+  /** Adopt a page already pinned through bpm, page can be nullptr for an empty guard */
+  WritePageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+
+  DISALLOW_COPY(WritePageGuard)
+
+  WritePageGuard(WritePageGuard &&that) noexcept;
+
+  WritePageGuard &operator=(WritePageGuard &&that) noexcept;
+
+  ~WritePageGuard() { Drop(); }
+
+  /** Unpin the page as dirty now, the guard is empty afterwards */
+  void Drop();
+
+  inline bool IsValid() const { return page_ != nullptr; }
+
+  inline page_id_t PageId() const { return page_->GetPageId(); }
+
+  inline Page *GetPage() const { return page_; }
+
+  inline char *GetData() const { return page_->GetData(); }
+
+private:
+  BufferPoolManager *bpm_{nullptr};
+  Page *page_{nullptr};
+};
+
+#endif  // MINISQL_PAGE_GUARD_H
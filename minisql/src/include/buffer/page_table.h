@@ -0,0 +1,79 @@
+#ifndef MINISQL_PAGE_TABLE_H
+#define MINISQL_PAGE_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "common/config.h"
+
+/**
+ * PageTable maps the ids of the pages held by a buffer pool to their frames.
+ *
+ * It is an open addressing hash table with linear probing. The capacity is a power of two of at
+ * least twice the number of frames, so the load factor never exceeds 1/2 and a probe sequence always
+ * ends at an empty slot. Erase shifts the following entries back instead of leaving tombstones.
+ * Only Grow allocates after construction.
+ */
+class PageTable {
+public:
+  /**
+   * @param num_frames the maximum number of entries, i.e. the pool size
+   */
+  explicit PageTable(size_t num_frames);
+
+  ~PageTable();
+
+  PageTable(const PageTable &) = delete;
+
+  PageTable &operator=(const PageTable &) = delete;
+
+  /**
+   * @param[out] frame_id the frame holding page_id, untouched if not found
+   * @return true if page_id is in the table
+   */
+  bool Find(page_id_t page_id, frame_id_t *frame_id) const;
+
+  /**
+   * Insert or overwrite the mapping of page_id.
+   * @return false if the table already holds num_frames other pages
+   */
+  bool Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * @return false if page_id is not in the table
+   */
+  bool Erase(page_id_t page_id);
+
+  /**
+   * Make room for num_frames entries, rehashing into a larger array if needed. Never shrinks.
+   */
+  void Grow(size_t num_frames);
+
+  /** @return the number of pages in the table */
+  size_t Size() const { return size_; }
+
+private:
+  struct Slot {
+    page_id_t page_id_;    // INVALID_PAGE_ID if the slot is empty
+    frame_id_t frame_id_;
+  };
+
+  /** @return the home slot of page_id (Fibonacci hashing spreads the consecutive page ids) */
+  size_t Home(page_id_t page_id) const {
+    return static_cast<size_t>((static_cast<uint32_t>(page_id) * 2654435769u) >> (32 - shift_)) & mask_;
+  }
+
+  size_t Probe(page_id_t page_id) const;
+
+  /** Allocate empty slots for num_frames entries. */
+  void Allocate(size_t num_frames);
+
+private:
+  Slot *slots_;
+  size_t mask_;         // capacity - 1
+  uint32_t shift_;      // log2(capacity)
+  size_t max_size_;     // num_frames
+  size_t size_{0};
+};
+
+#endif  // MINISQL_PAGE_TABLE_H
@@ -0,0 +1,93 @@
+#ifndef MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
+#define MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
+
+#include <mutex>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+
+/**
+ * ParallelBufferPoolManager partitions the frames into several BufferPoolManager shards.
+ * A page always lives in shard (page_id % num_instances), and every shard has its own latch,
+ * page table, free list and replacer, so threads touching different shards never contend.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+public:
+  /**
+   * @param num_instances number of shards
+   * @param pool_size number of frames in each shard
+   * @param max_pool_size number of frames each shard can be resized to, pool_size if 0
+   */
+  explicit ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                                     ReplacerType replacer_type = DEFAULT_REPLACER_TYPE, size_t max_pool_size = 0);
+
+  ~ParallelBufferPoolManager() override;
+
+  Page *FetchPage(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) override;
+
+  bool UnpinPage(page_id_t page_id, bool is_dirty) override;
+
+  bool FlushPage(page_id_t page_id) override;
+
+  Page *NewPage(page_id_t &page_id, BufferAccessStrategy *strategy = nullptr) override;
+
+  bool DeletePage(page_id_t page_id) override;
+
+  bool IsPageFree(page_id_t page_id) override;
+
+  bool CheckAllUnpinned() override;
+
+  void FlushAllPages() override;
+
+  /** Waits for the background writes of all shards, they share the files. */
+  size_t TruncateFreeExtents() override;
+
+  /** Every shard gets its own writer, keeping its share of target_clean_frames clean. */
+  void StartBackgroundWriter(size_t target_clean_frames, uint32_t interval_ms = BG_WRITER_INTERVAL_MS) override;
+
+  void StopBackgroundWriter() override;
+
+  /** The frames are split evenly across the shards, either every shard is resized or none is. */
+  bool Resize(size_t pool_size) override;
+
+  size_t GetPoolSize() override { return num_instances_ * pool_size_; }
+
+  size_t GetMaxPoolSize() override { return num_instances_ * instances_[0]->GetMaxPoolSize(); }
+
+  size_t GetHitCount() override;
+
+  size_t GetPrefetchCount() override;
+
+  size_t GetMissCount() override;
+
+private:
+  /** The page id decides the shard. */
+  Page *NewPageWithId(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) override {
+    return GetInstance(page_id)->NewPageWithId(page_id, strategy);
+  }
+
+  /** Every shard may hold pages of the tablespace. */
+  void DiscardTablespacePages(uint32_t tablespace_id) override {
+    for (auto instance : instances_) {
+      instance->DiscardTablespacePages(tablespace_id);
+    }
+  }
+
+  /** Pages are looked up in and loaded into their own shard, the prefetcher of this object only drives the chains. */
+  bool PrefetchLookup(page_id_t page_id, NextPageIdFunc next_page_id, page_id_t *next,
+                      size_t *write_backs) override;
+
+  bool PrefetchInstall(page_id_t page_id, const char *data, size_t write_backs,
+                       BufferAccessStrategy *strategy) override;
+
+  /** @return the shard responsible for page_id */
+  BufferPoolManager *GetInstance(page_id_t page_id) { return instances_[page_id % num_instances_]; }
+
+private:
+  size_t num_instances_;                        // number of shards
+  size_t pool_size_;                            // number of frames in each shard
+  DiskManager *disk_manager_;                   // shared by all shards
+  std::vector<BufferPoolManager *> instances_;  // the shards
+};
+
+#endif  // MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
@@ -32,6 +32,19 @@ public:
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Records that the page held by a frame was accessed (fetched or newly created).
+   * Policies that only look at unpin order can ignore it.
+   * @param frame_id the id of the accessed frame
+   */
+  virtual void RecordAccess(frame_id_t frame_id) {}
+
+  /**
+   * Forgets a frame whose page was deleted, including any access history kept for it.
+   * @param frame_id the id of the frame to remove
+   */
+  virtual void Remove(frame_id_t frame_id) { Pin(frame_id); }
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
 };
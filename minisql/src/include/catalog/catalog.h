@@ -65,6 +65,16 @@ private:
   std::map<index_id_t, page_id_t> index_meta_pages_;
 };
 
+/**
+ * What CatalogManager::Vacuum did to a table.
+ */
+struct VacuumStats {
+  size_t pages_before_{0};     // pages of the table heap
+  size_t pages_after_{0};
+  size_t rows_moved_{0};
+  size_t pages_truncated_{0};  // pages cut off the end of the database files
+};
+
 /**
  * Catalog manager
  *
@@ -125,12 +135,24 @@ public:
     
   // new: insert with checking primary key & unique
   // ret: DB_PK_DUPLICATE, DB_UNI_KEY_DUPLICATE, DB_TUPLE_TOO_LARGE, DB_SUCCESS
-  dberr_t Insert(TableInfo* &tf, Row &row, Transaction *txn);
+  dberr_t Insert(TableInfo* &tf, Row &row, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
+
+  // new: insert many rows at once, with the same checks as Insert, rows breaking a key are left out
+  // the table pages are filled one after the other (TableHeap::InsertTuples), each index gets its keys in order
+  // results: if not nullptr, the result of each row, as Insert returns it
+  // ret: DB_SUCCESS if all rows were inserted, else the result of the first row left out
+  dberr_t InsertBatch(TableInfo* &tf, std::vector<Row> &rows, Transaction *txn,
+                      std::vector<dberr_t> *results = nullptr, BufferAccessStrategy *strategy = nullptr);
 
   dberr_t Update(TableInfo* &tf, Row &old_row, Row &row, Transaction *txn);
 
   dberr_t Delete(TableInfo* &tf, Row &row, Transaction *txn);
 
+  // new: compact the heap of a table after deletes (TableHeap::Vacuum) while maintaining indexes, then give the
+  // free extents at the end of the file back to the file system
+  // ret: DB_TABLE_NOT_EXIST, DB_SUCCESS
+  dberr_t Vacuum(const std::string &table_name, Transaction *txn, VacuumStats *stats = nullptr);
+
 private:
   dberr_t FlushCatalogMetaPage() const;
 
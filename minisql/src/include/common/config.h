@@ -5,8 +5,6 @@
 #include <cstring>
 
 
-// new: using clock replacer (rather than LRU replacer)
-#define USING_CLOCK_REPLACER
 // new: if CMake in Release mode, enable this
 #define SUPPORT_RELEASE_VERSION
 
@@ -20,12 +18,63 @@ static constexpr int META_PAGE_ID = 0;               // physical page id of the
 static constexpr int CATALOG_META_PAGE_ID = 0;       // logical page id of the catalog meta data
 static constexpr int INDEX_ROOTS_PAGE_ID = 1;        // logical page id of the index roots
 
-static constexpr int PAGE_SIZE = 4096;               // size of a data page in byte
+// new: page size is chosen at configure time, e.g. cmake -DMINISQL_PAGE_SIZE=16384
+#ifndef MINISQL_PAGE_SIZE
+#define MINISQL_PAGE_SIZE 4096
+#endif
+static constexpr int PAGE_SIZE = MINISQL_PAGE_SIZE;  // size of a data page in byte
+static_assert(PAGE_SIZE == 4096 || PAGE_SIZE == 8192 || PAGE_SIZE == 16384 || PAGE_SIZE == 32768,
+              "PAGE_SIZE must be 4, 8, 16 or 32 KB");
 static constexpr int DEFAULT_BUFFER_POOL_SIZE = 2048;// default size of buffer pool
+static constexpr int DEFAULT_BUFFER_POOL_INSTANCES = 1;// default number of buffer pool shards
+static constexpr int LRU_K_REPLACER_K = 2;           // history depth of the LRU-K replacer
+static constexpr int BG_WRITER_CLEAN_FRAMES_RATIO = 16;// background writer keeps 1/16 of the frames clean
+static constexpr int BG_WRITER_INTERVAL_MS = 100;    // background writer wake up interval
+static constexpr int DEFAULT_PREFETCH_DISTANCE = 8;  // pages read ahead by table heap and index iterators
+static constexpr int BUFFER_ACCESS_RING_SIZE = 32;   // frames recycled by a bulk scan or load
+static constexpr int BUFFER_ACCESS_RING_POOL_SHARE = 16;// the ring of a parallel scan takes at most 1/16 of the frames
+static constexpr int DEFAULT_BUFFER_POOL_BUDGET = 8 * DEFAULT_BUFFER_POOL_SIZE;// frames shared by all databases
+static constexpr int BUFFER_POOL_CGROUP_SHARE = 2;   // without a budget flag, use 1/2 of the cgroup memory limit
+static constexpr int MIN_BUFFER_POOL_SIZE = 64;      // auto tuning never shrinks a pool below this
+static constexpr int BUFFER_POOL_TUNE_INTERVAL_MS = 1000;// auto tuning looks at the hit ratios this often
+static constexpr double BUFFER_POOL_GROW_HIT_RATIO = 0.95;// pools missing more often than this get more frames
+static constexpr int ASYNC_IO_QUEUE_DEPTH = 64;      // reads and writes of a disk file in flight at once
+static constexpr int ASYNC_IO_THREADS = 4;           // I/O threads when the kernel has no io_uring
+static constexpr int PAGE_RUN_MIN_SIZE = 8;          // contiguous pages first reserved for a table or index
+static constexpr int PAGE_RUN_MAX_SIZE = 64;         // reserved runs double up to this many pages
+static constexpr bool DEFAULT_FILE_PER_OBJECT = false;// every table heap and index in a file of its own
+static constexpr int TABLESPACE_PAGE_FLAG = 1 << 30;  // set in the page ids of pages in a tablespace file
+static constexpr int TABLESPACE_PAGE_BITS = 20;      // low bits of such a page id, the page in its segment
+static constexpr uint32_t TABLESPACE_SEGMENTS = 1u << (30 - TABLESPACE_PAGE_BITS);// segments the tablespaces share
+static constexpr int INSERT_BATCH_SIZE = 4096;       // inserts of an executed file applied at once
+static constexpr int PARALLEL_SCAN_MIN_PAGES = 64;   // pages a parallel scan worker gets at least
 
 static constexpr uint32_t FIELD_NULL_LEN = UINT32_MAX;
 static constexpr uint32_t VARCHAR_MAX_LEN = PAGE_SIZE / 2;    // max length of varchar
 
+// page replacement policy of a buffer pool, chosen when the storage engine is created
+enum class ReplacerType {
+  LRU_REPLACER = 0, CLOCK_REPLACER, LRU_K_REPLACER
+};
+static constexpr ReplacerType DEFAULT_REPLACER_TYPE = ReplacerType::CLOCK_REPLACER;
+
+// when the disk manager forces written pages to the device (fdatasync):
+// never (left to the OS), at the end of each checkpoint, or after every page written
+enum class DurabilityPolicy {
+  NONE = 0, SYNC_ON_CHECKPOINT, SYNC_EVERY_WRITE
+};
+static constexpr DurabilityPolicy DEFAULT_DURABILITY_POLICY = DurabilityPolicy::SYNC_ON_CHECKPOINT;
+
+// how the disk manager reads a database file: pread, or memcpy out of a read-only mapping of the file
+// (for read-mostly databases, the kernel page cache does the caching). Writes always use pwrite.
+// DIRECT opens the file with O_DIRECT, pages bypass the kernel page cache (for a buffer pool sized to most of RAM).
+enum class DiskIOMode {
+  PREAD = 0, MMAP, DIRECT
+};
+static constexpr DiskIOMode DEFAULT_DISK_IO_MODE = DiskIOMode::PREAD;
+static constexpr uint64_t DISK_MMAP_RESERVE = 1ULL << 36;// address space mapped for a database file in MMAP mode
+static constexpr int DIRECT_IO_ALIGNMENT = 4096;     // alignment of memory, offsets and sizes of O_DIRECT I/O
+
 // static std::string DB_META_FILE = "minisql.meta.db";
 
 using page_id_t = int32_t;
@@ -5,6 +5,7 @@
 #include <string>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/parallel_buffer_pool_manager.h"
 #include "catalog/catalog.h"
 #include "common/config.h"
 #include "common/dberr.h"
@@ -12,16 +13,35 @@
 
 class DBStorageEngine {
 public:
+  /**
+   * @param max_buffer_pool_size the number of frames the buffer pool can be resized to, buffer_pool_size if 0
+   * @param durability when the disk manager forces written pages to the device
+   * @param io_mode how the disk manager reads the database file, e.g. MMAP for read-mostly databases
+   * @param file_per_object whether new tables and indexes get a file of their own, see DiskManager
+   */
   explicit DBStorageEngine(std::string db_name, bool init = true,
-                           uint32_t buffer_pool_size = DEFAULT_BUFFER_POOL_SIZE)
+                           uint32_t buffer_pool_size = DEFAULT_BUFFER_POOL_SIZE,
+                           uint32_t buffer_pool_instances = DEFAULT_BUFFER_POOL_INSTANCES,
+                           ReplacerType replacer_type = DEFAULT_REPLACER_TYPE, uint32_t max_buffer_pool_size = 0,
+                           DurabilityPolicy durability = DEFAULT_DURABILITY_POLICY,
+                           DiskIOMode io_mode = DEFAULT_DISK_IO_MODE,
+                           bool file_per_object = DEFAULT_FILE_PER_OBJECT)
           : db_file_name_(std::move(db_name)), init_(init) {
     // Init database file if needed
     if (init_) {
-      remove(db_file_name_.c_str());
+      DiskManager::RemoveFiles(db_file_name_);
     }
     // Initialize components
-    disk_mgr_ = new DiskManager(db_file_name_);
-    bpm_ = new BufferPoolManager(buffer_pool_size, disk_mgr_);
+    disk_mgr_ = new DiskManager(db_file_name_, durability, io_mode);
+    disk_mgr_->SetFilePerObject(file_per_object);
+    if (buffer_pool_instances > 1) {
+      // split the frames evenly across the shards
+      bpm_ = new ParallelBufferPoolManager(buffer_pool_instances, buffer_pool_size / buffer_pool_instances, disk_mgr_,
+                                           replacer_type, max_buffer_pool_size / buffer_pool_instances);
+    } else {
+      bpm_ = new BufferPoolManager(buffer_pool_size, disk_mgr_, replacer_type, max_buffer_pool_size);
+    }
+    bpm_->StartBackgroundWriter(buffer_pool_size / BG_WRITER_CLEAN_FRAMES_RATIO);
     catalog_mgr_ = new CatalogManager(bpm_, nullptr, nullptr, init);
     // Allocate static page for db storage engine
     if (init) {
@@ -1,8 +1,11 @@
 #ifndef MINISQL_EXECUTE_ENGINE_H
 #define MINISQL_EXECUTE_ENGINE_H
 
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
+#include "buffer/buffer_pool_budget.h"
 #include "common/dberr.h"
 #include "common/instance.h"
 #include "transaction/transaction.h"
@@ -20,6 +23,10 @@ extern "C" {
 struct ExecuteContext {
   bool flag_quit_{false};
   Transaction *txn_{nullptr};
+  std::shared_ptr<BufferAccessStrategy> bulk_strategy_{nullptr};  // new: set while a file is executed
+  bool batch_inserts_{false};  // new: inserts are collected and applied with CatalogManager::InsertBatch
+  TableInfo *batch_table_{nullptr};
+  std::vector<Row> batch_rows_;
 };
 
 /**
@@ -27,10 +34,16 @@ struct ExecuteContext {
  */
 class ExecuteEngine {
 public:
-  ExecuteEngine();
+  /**
+   * @param buffer_pool_budget frames shared by the buffer pools of all databases,
+   *        BufferPoolBudget::DetectBudget() if 0
+   */
+  explicit ExecuteEngine(size_t buffer_pool_budget = 0);
 
   ~ExecuteEngine() {
+    budget_.StopAutoTuning();
     for (auto it : dbs_) {
+      budget_.Unregister(it.second->bpm_);
       delete it.second;
     }
   }
@@ -53,6 +66,9 @@ private:
   uint8_t canAccelerate(pSyntaxNode whereNode, TableInfo* &table_info, CatalogManager* &cat,
                       vector<Row*> &result);
 
+  /** new: open a database with a buffer pool that is resized within budget_ */
+  DBStorageEngine *OpenDatabase(const std::string &db_name, bool init);
+
   dberr_t ExecuteCreateDatabase(pSyntaxNode ast, ExecuteContext *context);
 
   dberr_t ExecuteDropDatabase(pSyntaxNode ast, ExecuteContext *context);
@@ -91,7 +107,17 @@ private:
 
   dberr_t ExecuteQuit(pSyntaxNode ast, ExecuteContext *context);
 
+  /** new: SET variable = value, for now only buffer_pool_size of the current database (0 for auto tuning) */
+  dberr_t ExecuteSetVariable(pSyntaxNode ast, ExecuteContext *context);
+
+  /** new: VACUUM table, compact its pages after deletes and give free extents back to the file system */
+  dberr_t ExecuteVacuum(pSyntaxNode ast, ExecuteContext *context);
+
+  /** new: insert the rows collected by ExecuteInsert while a file is executed */
+  dberr_t FlushInsertBatch(ExecuteContext *context);
+
 private:
+  BufferPoolBudget budget_;  /** memory shared by the buffer pools of all databases */
   [[maybe_unused]] std::unordered_map<std::string, DBStorageEngine *> dbs_;  /** all opened databases */
   [[maybe_unused]] std::string current_db_;  /** current database */
 };
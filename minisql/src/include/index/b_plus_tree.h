@@ -1,6 +1,7 @@
 #ifndef MINISQL_B_PLUS_TREE_H
 #define MINISQL_B_PLUS_TREE_H
 
+#include <fstream>
 #include <queue>
 #include <string>
 #include <vector>
@@ -47,15 +48,27 @@ public:
   // return the value associated with a given key
   bool GetValue(const KeyType &key, std::vector<ValueType> &result, Transaction *transaction = nullptr);
 
+  // new: look up keys sorted in ascending order, found[i] tells whether keys[i] is in the tree
+  void LookupSorted(const std::vector<KeyType> &keys, std::vector<bool> &found, Transaction *transaction = nullptr);
+
+  // new: insert pairs sorted by key, returns the number inserted (duplicate keys are skipped)
+  size_t InsertSorted(const std::vector<MappingType> &entries, Transaction *transaction = nullptr);
+
   INDEXITERATOR_TYPE Begin();
 
   INDEXITERATOR_TYPE Begin(const KeyType &key);
 
   INDEXITERATOR_TYPE End();
 
+  // number of leaves iterators read ahead, 0 to disable
+  void SetPrefetchDistance(size_t prefetch_distance) { prefetch_distance_ = prefetch_distance; }
+
   // expose for test purpose
   B_PLUS_TREE_LEAF_PAGE_TYPE *FindLeafPage(const KeyType &key, bool leftMost = false);
 
+  // new: find the leaf like FindLeafPage, the leaf stays pinned until the guard is released
+  ReadPageGuard FindLeafPageRead(const KeyType &key, bool leftMost = false);
+
   // used to check whether all pages are unpinned
   bool Check();
 
@@ -68,7 +81,7 @@ public:
     }
     out << "digraph G {" << std::endl;
     Page *root_page = buffer_pool_manager_->FetchPage(root_page_id_);
-    BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(root_page);
+    BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(root_page->GetData());
     ToGraph(node, buffer_pool_manager_, out);
     out << "}" << std::endl;
   }
@@ -84,6 +97,9 @@ private:
 
   bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
 
+  // compare a key to the last key of a leaf, an empty leaf is below every key
+  int CompareToLast(const LeafPage *leaf, const KeyType &key) const;
+
   void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
                         Transaction *transaction = nullptr);
 
@@ -116,6 +132,7 @@ private:
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  size_t prefetch_distance_{DEFAULT_PREFETCH_DISTANCE};
 };
 
 #endif  // MINISQL_B_PLUS_TREE_H
@@ -20,6 +20,10 @@ public:
   // new: scan range key with compare type
   dberr_t ScanKey(const Row &key, const int8_t compareType, std::vector<RowId> &result, Transaction *txn) override;
 
+  dberr_t ScanKeys(const std::vector<Row *> &keys, std::vector<bool> &found, Transaction *txn) override;
+
+  dberr_t InsertEntries(const std::vector<Row *> &keys, const std::vector<RowId> &row_ids, Transaction *txn) override;
+
   dberr_t Destroy() override;
 
   INDEXITERATOR_TYPE GetBeginIterator();
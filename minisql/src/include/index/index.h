@@ -22,6 +22,13 @@ public:
 
   virtual dberr_t ScanKey(const Row &key, const int8_t compareType, std::vector<RowId> &result, Transaction *txn) = 0;
 
+  // new: look up keys sorted in ascending order, found[i] tells whether keys[i] is in the index
+  virtual dberr_t ScanKeys(const std::vector<Row *> &keys, std::vector<bool> &found, Transaction *txn) = 0;
+
+  // new: insert entries with keys sorted in ascending order
+  virtual dberr_t InsertEntries(const std::vector<Row *> &keys, const std::vector<RowId> &row_ids,
+                                Transaction *txn) = 0;
+
   virtual dberr_t Destroy() = 0;
 
 protected:
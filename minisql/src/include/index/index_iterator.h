@@ -1,6 +1,7 @@
 #ifndef MINISQL_INDEX_ITERATOR_H
 #define MINISQL_INDEX_ITERATOR_H
 
+#include "buffer/page_guard.h"
 #include "page/b_plus_tree_leaf_page.h"
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
@@ -9,9 +10,9 @@ INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
 public:
   // you may define your own constructor based on your member variables
-  explicit IndexIterator(B_PLUS_TREE_LEAF_PAGE_TYPE *leaf, int index, BufferPoolManager *bpm);
-
-  ~IndexIterator();
+  // the iterator keeps the leaf of leaf_guard pinned while it points into it, an empty guard is the end
+  explicit IndexIterator(ReadPageGuard leaf_guard, int index, BufferPoolManager *bpm,
+                         size_t prefetch_distance = DEFAULT_PREFETCH_DISTANCE);
 
   /** Return the key/value pair this iterator is currently pointing at. */
   const MappingType &operator*();
@@ -28,10 +29,16 @@ public:
   bool operator!=(const IndexIterator &itr) const;
 
 private:
+  // called when the iterator enters a leaf, keeps the following leaves on their way into the pool
+  void ReadAhead();
+
   // add your own private member variables here
+  ReadPageGuard leaf_guard_;
   B_PLUS_TREE_LEAF_PAGE_TYPE *leaf_;
   BufferPoolManager *bpm_;
   int index_;
+  size_t prefetch_distance_;     // 0 disables read-ahead
+  size_t leaves_until_prefetch_{0};
 };
 
 
@@ -51,6 +51,9 @@ public:
   // insert and delete methods
   int Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
 
+  // new: append a key greater than all keys of the page, without searching its place
+  void Append(const KeyType &key, const ValueType &value) { CopyLastFrom(MappingType(key, value)); }
+
   bool Lookup(const KeyType &key, ValueType &value, const KeyComparator &comparator) const;
 
   int RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator);
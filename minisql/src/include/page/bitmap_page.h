@@ -2,6 +2,7 @@
 #define MINISQL_BITMAP_PAGE_H
 
 #include <bitset>
+#include <cstring>
 
 #include "common/macros.h"
 #include "common/config.h"
@@ -20,6 +21,14 @@ public:
    */
   bool AllocatePage(uint32_t &page_offset);
 
+  /**
+   * Allocate count free pages next to each other, the first fit at or above page_offset.
+   *
+   * @param page_offset where the search starts, set to the index in extent of the first page of the run
+   * @return true if a run of count free pages was found
+   */
+  bool AllocateRun(uint32_t count, uint32_t &page_offset);
+
   /**
    * @return true if successfully de-allocate a page.
    */
@@ -39,6 +48,13 @@ private:
    * @return true if a bit is 0, false if 1.
    */
   bool IsPageFreeLow(uint32_t byte_index, uint8_t bit_index) const;
+
+  /**
+   * Search the bitmap a 64-bit word at a time.
+   *
+   * @return the lowest free page at or above page_offset, GetMaxSupportedSize() if there is none
+   */
+  uint32_t FindFreePage(uint32_t page_offset) const;
  
   /** Note: need to update if modify page structure. */
   static constexpr size_t MAX_CHARS = PageSize - 2 * sizeof(uint32_t);
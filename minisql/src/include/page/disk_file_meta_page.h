@@ -1,14 +1,45 @@
 #ifndef MINISQL_DISK_FILE_META_PAGE_H
 #define MINISQL_DISK_FILE_META_PAGE_H
 
+#include <algorithm>
 #include <cstdint>
 
 #include "page/bitmap_page.h"
 
-static constexpr page_id_t MAX_VALID_PAGE_ID = (PAGE_SIZE - 8) / 4 * BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
+// physical page ids are page_id_t as well, so the file holds as many whole extents as leave them valid, and logical
+// page ids stay below TABLESPACE_PAGE_FLAG, which marks the pages of tablespace files
+static constexpr page_id_t MAX_VALID_PAGE_ID =
+        std::min((INT32_MAX - 1) / (BitmapPage<PAGE_SIZE>::GetMaxSupportedSize() + 1),
+                 TABLESPACE_PAGE_FLAG / BitmapPage<PAGE_SIZE>::GetMaxSupportedSize()) *
+        BitmapPage<PAGE_SIZE>::GetMaxSupportedSize() - 1;
 
+static constexpr uint32_t DISK_FILE_MAGIC_NUM = 0x4C51534D;  // "MSQL"
+
+/**
+ * The meta page is the first physical page of a database file. It starts with a magic number and the page size
+ * the file was created with, both at fixed offsets so they can be checked whatever PAGE_SIZE the reader uses.
+ *
+ * It has room for the used page counts of EXTENTS_PER_META_PAGE extents. The counts of the extents after them are
+ * in overflow meta pages, data pages chained from the last word of the meta page (see DiskFileMetaOverflowPage).
+ */
 class DiskFileMetaPage {
 public:
+  static constexpr uint32_t EXTENTS_PER_META_PAGE = (PAGE_SIZE - 4 * sizeof(uint32_t) - sizeof(page_id_t)) / 4;
+
+  /** Stamp the meta page of a new file */
+  void Init() {
+    magic_num_ = DISK_FILE_MAGIC_NUM;
+    page_size_ = PAGE_SIZE;
+  }
+
+  uint32_t GetMagicNum() {
+    return magic_num_;
+  }
+
+  uint32_t GetPageSize() {
+    return page_size_;
+  }
+
   uint32_t GetExtentNums() {
     return num_extents_;
   }
@@ -17,17 +48,52 @@ public:
     return num_allocated_pages_;
   }
 
+  /**
+   * @return the used page count of an extent counted in this page
+   */
   uint32_t GetExtentUsedPage(uint32_t extent_id) {
-    if (extent_id >= num_extents_) {
+    if (extent_id >= num_extents_ || extent_id >= EXTENTS_PER_META_PAGE) {
       return 0;
     }
     return extent_used_page_[extent_id];
   }
 
+  /**
+   * @return logical page id of the first overflow meta page, 0 if there is none (page 0 is the catalog meta page)
+   */
+  page_id_t GetNextMetaPageId() {
+    return *reinterpret_cast<page_id_t *>(reinterpret_cast<char *>(this) + PAGE_SIZE - sizeof(page_id_t));
+  }
+
+  void SetNextMetaPageId(page_id_t page_id) {
+    *reinterpret_cast<page_id_t *>(reinterpret_cast<char *>(this) + PAGE_SIZE - sizeof(page_id_t)) = page_id;
+  }
+
 public:
+  uint32_t magic_num_{0};
+  uint32_t page_size_{0};
   uint32_t num_allocated_pages_{0};
   uint32_t num_extents_{0};   // each extent consists with a bit map and BIT_MAP_SIZE pages
   uint32_t extent_used_page_[0];
 };
 
+/**
+ * An overflow meta page: the used page counts of the next EXTENTS_PER_PAGE extents, and the logical page id of the
+ * next overflow meta page (0 if none) in its last word.
+ */
+class DiskFileMetaOverflowPage {
+public:
+  static constexpr uint32_t EXTENTS_PER_PAGE = (PAGE_SIZE - sizeof(page_id_t)) / 4;
+
+  page_id_t GetNextMetaPageId() { return next_meta_page_id_; }
+
+  void SetNextMetaPageId(page_id_t page_id) { next_meta_page_id_ = page_id; }
+
+public:
+  uint32_t extent_used_page_[EXTENTS_PER_PAGE];
+  page_id_t next_meta_page_id_;
+};
+
+static_assert(sizeof(DiskFileMetaOverflowPage) == PAGE_SIZE);
+
 #endif //MINISQL_DISK_FILE_META_PAGE_H
@@ -0,0 +1,73 @@
+#ifndef MINISQL_FREE_SPACE_MAP_PAGE_H
+#define MINISQL_FREE_SPACE_MAP_PAGE_H
+
+#include <cstdint>
+
+#include "common/config.h"
+
+/**
+ * A table heap keeps a chain of these pages as its free space map: one entry per page of the heap, in the order
+ * of the page chain, with the free space of the page as a category of CATEGORY_SIZE bytes. The first page of the
+ * heap holds the id of the first map page.
+ *
+ * Format (size in byte):
+ *  ---------------------------------------------------------------------------------------------------
+ * | NextPageId (4) | EntryCount (4) | PageId_1 (4) | ... | PageId_n (4) | Category_1 (1) | ... | ... |
+ *  ---------------------------------------------------------------------------------------------------
+ */
+class FreeSpaceMapPage {
+public:
+  static constexpr uint32_t MAX_ENTRY_COUNT = (PAGE_SIZE - 8) / (sizeof(page_id_t) + 1);
+
+  static constexpr uint32_t CATEGORY_SIZE = PAGE_SIZE / 256;
+
+  void Init() {
+    next_page_id_ = INVALID_PAGE_ID;
+    count_ = 0;
+  }
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  uint32_t GetEntryCount() const { return count_; }
+
+  bool IsFull() const { return count_ == MAX_ENTRY_COUNT; }
+
+  /** Drop all entries, the next page id stays. */
+  void Clear() { count_ = 0; }
+
+  /**
+   * @return false if the page is full
+   */
+  bool Append(page_id_t page_id, uint8_t category);
+
+  page_id_t GetPageId(uint32_t entry) const { return page_ids_[entry]; }
+
+  uint8_t GetCategory(uint32_t entry) const { return categories_[entry]; }
+
+  void SetCategory(uint32_t entry, uint8_t category) { categories_[entry] = category; }
+
+  /**
+   * @return the first entry of at least min_category, -1 if there is none
+   */
+  int Find(uint8_t min_category) const;
+
+  uint8_t GetMaxCategory() const;
+
+  /** @return the category of a page with free_space bytes left, rounded down */
+  static uint8_t CategoryOf(uint32_t free_space);
+
+  /** @return the lowest category of a page sure to have space_needed bytes left */
+  static uint8_t CategoryFor(uint32_t space_needed);
+
+private:
+  page_id_t next_page_id_;
+  uint32_t count_;
+  page_id_t page_ids_[MAX_ENTRY_COUNT];
+  uint8_t categories_[MAX_ENTRY_COUNT];
+};
+
+static_assert(sizeof(FreeSpaceMapPage) <= PAGE_SIZE);
+
+#endif //MINISQL_FREE_SPACE_MAP_PAGE_H
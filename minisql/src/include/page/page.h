@@ -3,6 +3,7 @@
 
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <shared_mutex>
 
 #include "common/config.h"
@@ -12,6 +13,7 @@
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
+ * The data itself lives in the frame arena of the buffer pool, so an array of pages is compact frame metadata.
  */
 class Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
@@ -20,8 +22,11 @@ class Page {
 public:
   DISALLOW_COPY(Page)
 
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor of a standalone page, which owns its zeroed data. */
+  Page() : owned_data_(new char[PAGE_SIZE]{}) { data_ = owned_data_.get(); }
+
+  /** Constructor of a buffer pool frame, data is the (zeroed) frame memory in the frame arena. */
+  explicit Page(char *data) : data_(data) {}
 
   /** Default destructor. */
   ~Page() = default;
@@ -68,8 +73,8 @@ private:
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
+  /** The actual data that is stored within a page, PAGE_SIZE bytes in the frame arena. */
+  char *data_{nullptr};
   /** The ID of this page. */
   page_id_t page_id_ = INVALID_PAGE_ID;
   /** The pin count of this page. */
@@ -78,6 +83,8 @@ private:
   bool is_dirty_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** The data of a standalone page, nullptr for buffer pool frames. */
+  std::unique_ptr<char[]> owned_data_;
 };
 
 #endif  // MINISQL_PAGE_H
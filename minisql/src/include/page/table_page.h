@@ -12,9 +12,11 @@
  *  ----------------------------------------------------------------------------
  *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer(4) |
  *  ----------------------------------------------------------------------------
- *  ----------------------------------------------------------------
- *  | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
- *  ----------------------------------------------------------------
+ *  ---------------------------------------------------------------------------------
+ *  | TupleCount (4) | FsmPageId (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
+ *  ---------------------------------------------------------------------------------
+ *
+ *  FsmPageId is the first page of the free space map of the heap, only set in its first page.
  **/
 
 #include <cstring>
@@ -44,6 +46,27 @@ public:
     memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
   }
 
+  page_id_t GetFsmPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_FSM_PAGE_ID); }
+
+  void SetFsmPageId(page_id_t fsm_page_id) {
+    memcpy(GetData() + OFFSET_FSM_PAGE_ID, &fsm_page_id, sizeof(page_id_t));
+  }
+
+  /** @return the next page id stored in the raw content of a table page, used by read-ahead */
+  static page_id_t NextPageIdOf(const char *page_data) {
+    return *reinterpret_cast<const page_id_t *>(page_data + OFFSET_NEXT_PAGE_ID);
+  }
+
+  /** @return true if a tuple of serialized_size bytes passes the space check of InsertTuple */
+  bool CanHoldTuple(uint32_t serialized_size) { return GetFreeSpaceRemaining() >= SpaceFor(serialized_size); }
+
+  /** @return the free space InsertTuple takes for a tuple of serialized_size bytes, its slot included */
+  static uint32_t SpaceFor(uint32_t serialized_size) { return serialized_size + SIZE_TUPLE; }
+
+  uint32_t GetFreeSpaceRemaining() {
+    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
+  }
+
   bool InsertTuple(Row &row, Schema *schema, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
 
   bool MarkDelete(const RowId &rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
@@ -61,6 +84,23 @@ public:
 
   bool GetNextTupleRid(const RowId &cur_rid, RowId *next_rid);
 
+  /**
+   * @return the serialized tuple in the slot, nullptr if the slot holds none. The tuple is read in place, it is
+   *         only valid while the page is pinned.
+   */
+  const char *GetTupleData(uint32_t slot_num) {
+    if (slot_num >= GetTupleCount() || IsDeleted(GetTupleSize(slot_num))) {
+      return nullptr;
+    }
+    return GetData() + GetTupleOffsetAtSlot(slot_num);
+  }
+
+  /** @return true if no slot holds a tuple, not even one marked deleted */
+  bool IsEmpty();
+
+  /** Drop the empty slots at the end of the slot array, the row ids of the tuples stay the same. */
+  void TrimSlots();
+
 private:
   uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
 
@@ -72,10 +112,6 @@ private:
 
   void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
 
-  uint32_t GetFreeSpaceRemaining() {
-    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
-  }
-
   uint32_t GetTupleOffsetAtSlot(uint32_t slot_num) {
     return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_OFFSET + SIZE_TUPLE * slot_num);
   }
@@ -101,14 +137,15 @@ private:
 private:
   static_assert(sizeof(page_id_t) == 4);
   static constexpr uint64_t DELETE_MASK = (1U << (8 * sizeof(uint32_t) - 1));
-  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
+  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 28;
   static constexpr size_t SIZE_TUPLE = 8;
   static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
   static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
   static constexpr size_t OFFSET_FREE_SPACE = 16;
   static constexpr size_t OFFSET_TUPLE_COUNT = 20;
-  static constexpr size_t OFFSET_TUPLE_OFFSET = 24;
-  static constexpr size_t OFFSET_TUPLE_SIZE = 28;
+  static constexpr size_t OFFSET_FSM_PAGE_ID = 24;
+  static constexpr size_t OFFSET_TUPLE_OFFSET = 28;
+  static constexpr size_t OFFSET_TUPLE_SIZE = 32;
 
 public:
   static constexpr size_t SIZE_MAX_ROW = PAGE_SIZE - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE;
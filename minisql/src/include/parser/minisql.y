@@ -1,5 +1,6 @@
 %{
   #include <stdio.h>
+  #include <strings.h>
   #include "parser/parser.h"
 
   extern char *yytext;
@@ -27,7 +28,7 @@
 %type <syntax_node> sql_select select_columns column_values column_value operator
 %type <syntax_node> connector where_conditions where_condition
 %type <syntax_node> sql_insert sql_delete sql_update update_values update_value
-%type <syntax_node> sql_quit sql_exec_file
+%type <syntax_node> sql_quit sql_exec_file sql_set_variable sql_vacuum
 
 %%
 
@@ -58,6 +59,8 @@ sql:
   | sql_trx_rollback { $$ = $1; }
   | sql_quit { $$ = $1; }
   | sql_exec_file { $$ = $1; }
+  | sql_set_variable { $$ = $1; }
+  | sql_vacuum { $$ = $1; }
   ;
 
 sql_create_database:
@@ -393,6 +396,26 @@ sql_exec_file:
   }
   ;
 
+sql_set_variable:
+  SET IDENTIFIER EQ NUMBER {
+    $$ = CreateSyntaxNode(kNodeSetVariable, NULL);
+    SyntaxNodeAddChildren($$, $2);
+    SyntaxNodeAddChildren($$, $4);
+  }
+  ;
+
+/* vacuum is no keyword of the lexer, it comes in as an identifier */
+sql_vacuum:
+  IDENTIFIER IDENTIFIER {
+    if (strcasecmp($1->val_, "vacuum") != 0) {
+      yyerror("syntax error");
+      YYERROR;
+    }
+    $$ = CreateSyntaxNode(kNodeVacuum, NULL);
+    SyntaxNodeAddChildren($$, $2);
+  }
+  ;
+
 %%
 int yyerror(char* error) {
 	MinisqlParserSetError(error);
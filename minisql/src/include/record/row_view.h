@@ -0,0 +1,61 @@
+#ifndef MINISQL_ROW_VIEW_H
+#define MINISQL_ROW_VIEW_H
+
+#include <vector>
+
+#include "common/rowid.h"
+#include "record/field.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * Read only view of a row serialized in the format of Row, e.g. a tuple in a table page. Nothing is copied or
+ * allocated per row: the fields are decoded from the bytes when asked for, and the offsets of the fields before
+ * are found on the way and kept for the next field asked for.
+ *
+ * A view of a tuple is only valid while its page is pinned. A scan points one view at tuple after tuple with
+ * Reset, the offsets keep their storage.
+ */
+class RowView {
+public:
+  explicit RowView(Schema *schema) : schema_(schema) {}
+
+  RowView(Schema *schema, const char *data, RowId rid) : schema_(schema) { Reset(data, rid); }
+
+  /**
+   * Point the view at another serialized row.
+   */
+  void Reset(const char *data, RowId rid);
+
+  inline RowId GetRowId() const { return rid_; }
+
+  inline uint32_t GetFieldCount() const { return field_count_; }
+
+  bool IsNull(uint32_t idx) const;
+
+  /**
+   * @return the field, a char field points into the serialized row and does not own its data
+   */
+  Field GetField(uint32_t idx) const;
+
+  /**
+   * Decode the whole row, for rows kept after the page is unpinned.
+   * @return a new row owned by the caller
+   */
+  Row *ToRow() const;
+
+private:
+  /**
+   * @return the offset of the field in the serialized row, the offsets up to it are decoded once
+   */
+  uint32_t OffsetOf(uint32_t idx) const;
+
+private:
+  Schema *schema_;
+  const char *data_{nullptr};
+  RowId rid_{};
+  uint32_t field_count_{0};
+  mutable std::vector<uint32_t> offsets_;  // offsets of the fields decoded so far
+};
+
+#endif  // MINISQL_ROW_VIEW_H
@@ -0,0 +1,87 @@
+#ifndef MINISQL_ASYNC_IO_H
+#define MINISQL_ASYNC_IO_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sys/types.h>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+/**
+ * One asynchronous read or write of len_ bytes at offset_ of the file.
+ */
+struct AsyncIORequest {
+  bool write_;
+  int64_t offset_;
+  char *data_;
+  size_t len_;
+  std::function<void(ssize_t result)> callback_;  // bytes transferred, or -errno
+};
+
+/**
+ * AsyncIO keeps up to queue_depth reads and writes of one file descriptor in flight.
+ *
+ * It uses io_uring through raw system calls if the kernel has it, and a small pool of threads doing
+ * pread/pwrite otherwise. Callbacks run on an I/O thread of the backend: they must be short and must not
+ * submit I/O themselves, as a full queue would never drain.
+ */
+class AsyncIO {
+public:
+  enum class Backend {
+    IO_URING = 0, THREAD_POOL
+  };
+
+  /**
+   * @param use_io_uring false to use the thread pool even if the kernel has io_uring
+   */
+  static std::unique_ptr<AsyncIO> Create(int fd, size_t queue_depth = ASYNC_IO_QUEUE_DEPTH, bool use_io_uring = true);
+
+  /** Waits for the I/O in flight. */
+  virtual ~AsyncIO() = default;
+
+  /**
+   * Start the requests, in order. Blocks while queue_depth I/Os are in flight.
+   */
+  virtual void Submit(std::vector<AsyncIORequest> &requests) = 0;
+
+  virtual Backend GetBackend() const = 0;
+};
+
+/**
+ * Counts the I/Os of a batch that are still in flight, so the submitter can wait for their callbacks.
+ */
+class IOWaitGroup {
+public:
+  IOWaitGroup() = default;
+
+  DISALLOW_COPY(IOWaitGroup)
+
+  void Add(size_t count = 1) {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    count_ += count;
+  }
+
+  void Done() {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    if (--count_ == 0) {
+      cv_.notify_all();
+    }
+  }
+
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return count_ == 0; });
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  size_t count_{0};
+};
+
+#endif  // MINISQL_ASYNC_IO_H
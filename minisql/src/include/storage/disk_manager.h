@@ -2,14 +2,19 @@
 #define DISK_MGR_H
 
 #include <atomic>
-#include <fstream>
-#include <iostream>
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
+#include <sys/uio.h>
+#include <vector>
 #include "common/config.h"
 #include "common/macros.h"
 #include "page/bitmap_page.h"
 #include "page/disk_file_meta_page.h"
+#include "storage/async_io.h"
 
 /**
  * DiskManager takes care of the allocation and de allocation of pages within a database. It performs the reading and
@@ -18,10 +23,52 @@
  * Disk page storage format: (Free Page BitMap Size = PAGE_SIZE * 8, we note it as N)
  * | Meta Page | Free Page BitMap 1 | Page 1 | Page 2 | ....
  *      | Page N | Free Page BitMap 2 | Page N+1 | ... | Page 2N | ... |
+ *
+ * Offsets in the file are 64-bit, a file holds up to MAX_VALID_PAGE_ID + 1 pages. The used page counts of the extents
+ * that do not fit into the meta page are kept in overflow meta pages (see DiskFileMetaPage).
+ *
+ * The bitmap pages are cached in memory and written back by Checkpoint and Close together with the meta page, so
+ * allocating and freeing pages does no I/O.
+ *
+ * Pages are read and written with positional I/O (pread/pwrite) on one file descriptor, so reading and writing data
+ * pages does not take the latch. The size of the file is kept in memory instead of asking the file system per read.
+ * Data pages can also be read and written asynchronously, many at a time (see AsyncIO).
+ *
+ * Tables and indexes take their pages from runs of contiguous pages reserved for them (AllocatePage with an owner),
+ * so the pages of one object stay next to each other in the file even when several objects grow at the same time.
+ * The space of a run is preallocated with fallocate. The unused pages of the runs are given back by Close.
+ *
+ * In DiskIOMode::MMAP the file is mapped read-only once, with room to grow up to DISK_MMAP_RESERVE bytes, and pages
+ * are copied out of the mapping instead of read. Writes still use pwrite, the mapping sees them through the page cache.
+ *
+ * In DiskIOMode::DIRECT the file is opened with O_DIRECT, pages go between the device and the buffer pool frames
+ * without a copy in the kernel page cache. Pages in memory not aligned to DIRECT_IO_ALIGNMENT are copied through an
+ * aligned buffer. PREAD is used if the file system does not support O_DIRECT.
+ *
+ * With file per object (SetFilePerObject) every table heap and index gets a file of its own, a tablespace: the file
+ * of tablespace n is db_file.n, handled by a DiskManager of its own. The page ids of its pages have
+ * TABLESPACE_PAGE_FLAG set, the bits above TABLESPACE_PAGE_BITS pick a segment and the bits below the page in it.
+ * A segment covers SEGMENT_PAGES pages of one tablespace file, a tablespace gets one more each time its file grows
+ * past the ones it has. The segment map is kept in db_file.segments, so tablespace ids are not limited by the bits
+ * of a page id and one tablespace can grow into all TABLESPACE_SEGMENTS segments. Dropping the object unlinks the
+ * file and frees its segments, the pages of different files are read and written without a latch in common, and a
+ * scan of the object reads one file front to back.
  */
 class DiskManager {
 public:
-  explicit DiskManager(const std::string &db_file);
+  /**
+   * Called once an asynchronous page read or write is done, ok is false on an I/O error.
+   * Runs on an I/O thread, see AsyncIO.
+   */
+  using IOCallback = std::function<void(bool ok)>;
+
+  /**
+   * @param durability when written pages are forced to the device, see DurabilityPolicy
+   * @param io_mode how pages are read, see DiskIOMode. PREAD is used if the file can not be mapped, or opened
+   *        with O_DIRECT.
+   */
+  explicit DiskManager(const std::string &db_file, DurabilityPolicy durability = DEFAULT_DURABILITY_POLICY,
+                       DiskIOMode io_mode = DEFAULT_DISK_IO_MODE);
 
   ~DiskManager() {
     if (!closed) {
@@ -41,12 +88,120 @@ public:
    */
   void WritePage(page_id_t logical_page_id, const char *page_data);
 
+  /**
+   * Write many pages at once, in the order of their position in the file. Pages next to each other in the file
+   * are written by one pwritev. With SYNC_EVERY_WRITE the file is synced once, after the last page.
+   * @param pages logical page id and content of each page, sorted by the call
+   */
+  void WritePages(std::vector<std::pair<page_id_t, const char *>> &pages);
+
+  /**
+   * Queue an asynchronous read of a data page, started by the next SubmitBatch. page_data must stay valid
+   * until callback is called. A page past the end of the file is zeroed and its callback called right away.
+   */
+  void ReadPageAsync(page_id_t logical_page_id, char *page_data, IOCallback callback);
+
+  /**
+   * Queue an asynchronous write of a data page, started by the next SubmitBatch. page_data must stay valid
+   * until callback is called. With SYNC_EVERY_WRITE the page is synced before callback is called.
+   */
+  void WritePageAsync(page_id_t logical_page_id, const char *page_data, IOCallback callback);
+
+  /**
+   * Start every read and write queued so far (by any thread). Blocks while ASYNC_IO_QUEUE_DEPTH I/Os are
+   * in flight.
+   * @return the number of I/Os started
+   */
+  size_t SubmitBatch();
+
+  /**
+   * Replace the asynchronous I/O backend, after waiting for the I/O in flight. By default it is created on first
+   * use with ASYNC_IO_QUEUE_DEPTH and io_uring if the kernel has it.
+   * @param use_io_uring false to use the thread pool backend
+   */
+  void ConfigureAsyncIO(size_t queue_depth, bool use_io_uring = true);
+
+  /**
+   * @return the asynchronous I/O backend in use, creating it if needed
+   */
+  AsyncIO::Backend GetAsyncIOBackend();
+
+  /**
+   * Write the meta page and, unless the durability policy is NONE, force everything written so far to the
+   * device. Called by the buffer pool at the end of a checkpoint (FlushAllPages).
+   */
+  void Checkpoint();
+
   /**
    * Get next free page from disk
-   * @return logical page id of allocated page
+   * @return logical page id of allocated page, INVALID_PAGE_ID if the file is full
    */
   page_id_t AllocatePage();
 
+  /**
+   * Get the next page of the run reserved for owner, e.g. a table heap, reserving a new run when it is used up.
+   * Runs start with PAGE_RUN_MIN_SIZE pages and double with every run up to PAGE_RUN_MAX_SIZE, a new run is put
+   * right behind the previous one if there is room.
+   * @return logical page id of allocated page
+   */
+  page_id_t AllocatePage(const void *owner);
+
+  /**
+   * Allocate count pages with consecutive logical page ids, all in one extent, so they are contiguous in the file.
+   * @param near if valid, the run is put at or above it if its extent has room. If it is a page of a tablespace the
+   *        run is taken from the file of the tablespace.
+   * @return logical page id of the first page, INVALID_PAGE_ID if count is 0 or more than an extent holds
+   */
+  page_id_t AllocateRun(uint32_t count, page_id_t near = INVALID_PAGE_ID);
+
+  /**
+   * Free the pages of the run of owner not handed out yet, e.g. once its table is dropped.
+   */
+  void ReleasePages(const void *owner);
+
+  /**
+   * Change the size of the runs reserved from now on, 1 allocates the pages of every owner one at a time.
+   */
+  void ConfigurePageRuns(uint32_t min_size, uint32_t max_size);
+
+  /**
+   * In file per object mode, put the pages owner allocates from now on into tablespace tablespace_id, created if
+   * it does not exist. Otherwise, or for tablespace 0, they stay in the database file.
+   */
+  void CreateTablespace(const void *owner, uint32_t tablespace_id);
+
+  /**
+   * Put the pages owner allocates from now on into the file page_id is in, e.g. for a table heap loaded from disk
+   * with its first page. Works whether file per object is on or not.
+   */
+  void OpenTablespace(const void *owner, page_id_t page_id);
+
+  /**
+   * @return the tablespace the pages of owner go to, 0 for the database file
+   */
+  uint32_t GetTablespaceId(const void *owner);
+
+  /**
+   * Close and unlink the file of a tablespace, with every page in it. Its pages must not be in a buffer pool any
+   * more, see BufferPoolManager::DropTablespace.
+   */
+  void DropTablespace(uint32_t tablespace_id);
+
+  /**
+   * Give the table heaps and indexes created from now on a file of their own, or not (the default).
+   */
+  void SetFilePerObject(bool file_per_object) { file_per_object_ = file_per_object; }
+
+  inline bool IsFilePerObject() const { return file_per_object_; }
+
+  /**
+   * Cut the free pages at the end of the file off the file, of the database file and of every open tablespace,
+   * e.g. after a vacuum freed the last pages of a table. Empty extents at the end are dropped from the meta page,
+   * the file then ends with the last allocated page of the last extent left.
+   * @return the number of pages the files shrank by
+   */
+  size_t TruncateFreeExtents();
+
   /**
    * Free this page and reset bit map
    */
@@ -70,13 +225,86 @@ public:
     return meta_data_;
   }
 
+  /**
+   * @return the number of pages written so far, meta page and bitmap pages excluded
+   */
+  inline size_t GetNumWrites() const { return num_writes_; }
+
+  /**
+   * @return the number of fdatasync calls so far
+   */
+  inline size_t GetNumSyncs() const { return num_syncs_; }
+
+  inline DurabilityPolicy GetDurabilityPolicy() const { return durability_; }
+
+  inline DiskIOMode GetIOMode() const { return io_mode_; }
+
+  /**
+   * @return memory for num_pages pages aligned to DIRECT_IO_ALIGNMENT, so in DiskIOMode::DIRECT it is read and
+   *         written without a copy
+   */
+  static std::unique_ptr<char[], void (*)(void *)> AllocatePageBuffer(size_t num_pages);
+
+  /**
+   * Remove a database file and the files of its tablespaces.
+   */
+  static void RemoveFiles(const std::string &db_file);
+
+  /**
+   * @return the tablespace of the heap of a table in file per object mode, 0 if table_id is too large for one
+   */
+  static uint32_t TableTablespaceId(table_id_t table_id) {
+    return table_id < UINT32_MAX / 2 ? 2 * table_id + 1 : 0;
+  }
+
+  /**
+   * @return the tablespace of an index in file per object mode, 0 if index_id is too large for one
+   */
+  static uint32_t IndexTablespaceId(index_id_t index_id) {
+    return index_id < UINT32_MAX / 2 ? 2 * index_id + 2 : 0;
+  }
+
+  static bool IsTablespacePage(page_id_t page_id) { return page_id >= 0 && (page_id & TABLESPACE_PAGE_FLAG) != 0; }
+
+  /**
+   * @return the tablespace a page is in, 0 for the database file or a segment no tablespace has
+   */
+  uint32_t TablespaceOf(page_id_t page_id);
+
   static constexpr size_t BITMAP_SIZE = BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
 
+  // pages of a tablespace file a segment covers, whole extents, so a run of pages never spans two segments
+  static constexpr page_id_t SEGMENT_PAGES = (1 << TABLESPACE_PAGE_BITS) / BITMAP_SIZE * BITMAP_SIZE;
+  static_assert(SEGMENT_PAGES > 0, "an extent does not fit into a segment");
+
 private:
   /**
    * Helper function to get disk file size
    */
-  int GetFileSize(const std::string &file_name);
+  int64_t GetFileSize(const std::string &file_name);
+
+  /**
+   * Switch the file descriptor to O_DIRECT.
+   * @return false, leaving it as it is, if the file system does not support O_DIRECT
+   */
+  bool EnableDirectIO();
+
+  /**
+   * @return whether page I/O from or to data has to be copied through aligned memory
+   */
+  bool NeedsBounce(const char *data) const {
+    return io_mode_ == DiskIOMode::DIRECT && reinterpret_cast<uintptr_t>(data) % DIRECT_IO_ALIGNMENT != 0;
+  }
+
+  /**
+   * fdatasync the file, the caller decides whether the durability policy asks for it
+   */
+  void Sync();
+
+  /**
+   * Grow the cached file size to cover a page written up to end
+   */
+  void GrowFileSize(int64_t end);
 
   /**
    * Read physical page from disk
@@ -88,19 +316,149 @@ private:
    */
   void WritePhysicalPage(page_id_t physical_page_id, const char *page_data);
 
+  /**
+   * Write count pages to the physical pages starting at physical_page_id, with as few pwritev calls as possible.
+   * Changes iov.
+   */
+  void WritePhysicalPages(page_id_t physical_page_id, struct iovec *iov, int count);
+
   /**
    * Map logical page id to physical page id
    */
   page_id_t MapPageId(page_id_t logical_page_id);
 
+  /**
+   * @return the physical page id of the bitmap page of an extent
+   */
+  page_id_t BitmapPhysicalPageId(uint32_t extent_id);
+
+  /**
+   * @return the file of a tablespace
+   */
+  std::string TablespaceFileName(uint32_t tablespace_id) const {
+    return file_name_ + "." + std::to_string(tablespace_id);
+  }
+
+  /**
+   * @return the disk manager of a tablespace, opening its file on first use. nullptr if the file does not exist
+   *         and create is false, e.g. for a write back racing with the drop of its object.
+   */
+  std::shared_ptr<DiskManager> GetTablespace(uint32_t tablespace_id, bool create);
+
+  static uint32_t SegmentOf(page_id_t page_id) { return (page_id & ~TABLESPACE_PAGE_FLAG) >> TABLESPACE_PAGE_BITS; }
+
+  static page_id_t SegmentOffset(page_id_t page_id) { return page_id & ((1 << TABLESPACE_PAGE_BITS) - 1); }
+
+  /**
+   * @return the disk manager of the tablespace a page is in, as GetTablespace without create, and the page id of
+   *         the page in its file. nullptr if the segment of the page is free, e.g. as its object was dropped.
+   */
+  std::shared_ptr<DiskManager> GetTablespaceOf(page_id_t page_id, page_id_t *local_page_id);
+
+  /**
+   * @return the page id of page local_page_id of the file of tablespace_id, giving the tablespace the segments up to
+   *         the one of the page. INVALID_PAGE_ID if no segment is free.
+   */
+  page_id_t TablespacePageId(uint32_t tablespace_id, page_id_t local_page_id);
+
+  std::string SegmentFileName() const { return file_name_ + ".segments"; }
+
+  /**
+   * Write the segment map to its file. The caller must hold tablespace_latch_ exclusively.
+   */
+  void WriteSegments();
+
+  /**
+   * @return the disk managers of the tablespaces open so far
+   */
+  std::vector<std::shared_ptr<DiskManager>> OpenTablespaces();
+
+  /**
+   * Ask the file system for the space of count contiguous pages, so they are laid out together on the device.
+   * Only a hint, ignored if the file system can not do it.
+   */
+  void Preallocate(page_id_t logical_page_id, uint32_t count);
+
+  /**
+   * @return the used page count of an extent, in the meta page or an overflow meta page. The caller must hold
+   *         db_io_latch_.
+   */
+  uint32_t &ExtentUsedPages(uint32_t extent_id);
+
+  /**
+   * Add an empty extent at the end of the file. The caller must hold db_io_latch_.
+   * @return false if the file can not hold another extent
+   */
+  bool AddExtent(uint32_t *extent_id);
+
+  /**
+   * Write the meta page and the overflow meta pages. The caller must hold db_io_latch_.
+   */
+  void WriteMetaPages();
+
+  /**
+   * @return the cached bitmap page of an extent, read from disk on first use. The caller must hold db_io_latch_.
+   */
+  BitmapPage<PAGE_SIZE> *GetBitmap(uint32_t extent_id);
+
+  /**
+   * Write back the bitmap pages changed since the last call. The caller must hold db_io_latch_.
+   */
+  void FlushBitmaps();
+
 private:
-  // stream to write db file
-  std::fstream db_io_;
+  // file descriptor of the db file
+  int db_fd_{-1};
   std::string file_name_;
-  // with multiple buffer pool instances, need to protect file access
+  DurabilityPolicy durability_;
+  DiskIOMode io_mode_;
+  // the read-only mapping of the file in MMAP mode
+  char *map_{nullptr};
+  // bytes in the file, only grows
+  std::atomic<int64_t> file_size_{0};
+  // protects the meta page and the bitmap pages, data pages are read and written without it
   std::recursive_mutex db_io_latch_;
-  bool closed{false};
+  // bitmap pages of the extents, loaded on first use
+  std::vector<std::unique_ptr<char[]>> bitmaps_;
+  std::vector<bool> bitmap_dirty_;
+  // every extent below it is full
+  uint32_t first_free_extent_{0};
+  // pages reserved for an owner and not handed out yet
+  struct PageRun {
+    page_id_t next_page_id_{INVALID_PAGE_ID};
+    uint32_t remaining_{0};
+    uint32_t size_{0};
+  };
+  std::unordered_map<const void *, PageRun> page_runs_;
+  uint32_t page_run_min_size_{PAGE_RUN_MIN_SIZE};
+  uint32_t page_run_max_size_{PAGE_RUN_MAX_SIZE};
+  // the last page id AddExtent may cover, lower for the file of a tablespace
+  page_id_t max_page_id_{MAX_VALID_PAGE_ID};
+  bool file_per_object_{DEFAULT_FILE_PER_OBJECT};
+  // the pages index_ * SEGMENT_PAGES onwards of a tablespace file, a free segment has tablespace_id_ 0
+  struct Segment {
+    uint32_t tablespace_id_{0};
+    uint32_t index_{0};
+  };
+  // protects the fields below. Shared for the lookup of every page I/O of a tablespace, exclusive to open, create
+  // or drop one, or give it a segment.
+  std::shared_mutex tablespace_latch_;
+  std::unordered_map<uint32_t, std::shared_ptr<DiskManager>> tablespaces_;
+  std::unordered_map<const void *, uint32_t> tablespace_owners_;
+  // the segment map as in its file, and the segments of each tablespace in the order of its file
+  Segment segments_[TABLESPACE_SEGMENTS];
+  std::unordered_map<uint32_t, std::vector<uint32_t>> tablespace_segments_;
+  std::atomic<bool> closed{false};
+  std::atomic<size_t> num_writes_{0};
+  std::atomic<size_t> num_syncs_{0};
+  // asynchronous I/O, created on first use
+  std::mutex async_latch_;
+  std::unique_ptr<AsyncIO> async_io_;
+  std::vector<AsyncIORequest> async_queued_;
   char meta_data_[PAGE_SIZE];
+  // the chain of overflow meta pages, logical page id and content
+  std::vector<page_id_t> meta_overflow_page_ids_;
+  std::vector<std::unique_ptr<char[]>> meta_overflow_pages_;
 };
 
 #endif
\ No newline at end of file
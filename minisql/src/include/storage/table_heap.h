@@ -1,8 +1,16 @@
 #ifndef MINISQL_TABLE_HEAP_H
 #define MINISQL_TABLE_HEAP_H
 
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
+#include "page/free_space_map_page.h"
 #include "page/table_page.h"
+#include "record/row_view.h"
 #include "storage/table_iterator.h"
 #include "transaction/log_manager.h"
 #include "transaction/lock_manager.h"
@@ -11,10 +19,15 @@ class TableHeap {
   friend class TableIterator;
 
 public:
+  /**
+   * @param tablespace_id the file of the heap in file per object mode (DiskManager::TableTablespaceId),
+   *        0 for the database file
+   */
   static TableHeap *Create(BufferPoolManager *buffer_pool_manager, Schema *schema, Transaction *txn,
-                           LogManager *log_manager, LockManager *lock_manager, MemHeap *heap) {
+                           LogManager *log_manager, LockManager *lock_manager, MemHeap *heap,
+                           uint32_t tablespace_id = 0) {
     void *buf = heap->Allocate(sizeof(TableHeap));
-    return new(buf) TableHeap(buffer_pool_manager, schema, txn, log_manager, lock_manager);
+    return new(buf) TableHeap(buffer_pool_manager, schema, txn, log_manager, lock_manager, tablespace_id);
   }
 
   static TableHeap *Create(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
@@ -26,12 +39,25 @@ public:
   ~TableHeap() {}
 
   /**
-   * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
+   * Insert a tuple into the table, into a page the free space map finds room in, or into a new page at the end
+   * of the heap. If the tuple is too large (>= page_size), return false.
    * @param[in/out] row Tuple Row to insert, the rid of the inserted tuple is wrapped in object row
    * @param[in] txn The transaction performing the insert
+   * @param[in] strategy if not nullptr, a page added to the heap goes into the ring of strategy, so a bulk
+   *            load writes its pages back instead of filling the buffer pool with them
    * @return true iff the insert is successful
    */
-  bool InsertTuple(Row &row, Transaction *txn);
+  bool InsertTuple(Row &row, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * Insert tuples in their order, holding the free space map latch for the whole batch. The page they go to stays
+   * pinned until it is full, no page latch is taken. A tuple too large for a page, or one no page could be
+   * allocated for, gets INVALID_ROWID as row id, the others the rid they were inserted at.
+   * @param[in/out] rows tuples to insert
+   * @param[in] strategy as for InsertTuple
+   * @return the number of tuples inserted
+   */
+  size_t InsertTuples(const std::vector<Row *> &rows, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
@@ -78,9 +104,117 @@ public:
   void FreeHeap();
 
   /**
+   * Called by Vacuum for every tuple it moves. row holds the tuple and its old row id.
+   */
+  using MoveCallback = std::function<void(const Row &row, const RowId &new_rid)>;
+
+  /**
+   * Compact the heap after deletes: the tuples of the last pages are moved into the free space of the first ones,
+   * pages left empty are unlinked from the page chain and freed, and so are the pages reserved for the heap and not
+   * used yet. The first page always stays.
+   * @param on_move called for every moved tuple, e.g. to point the indexes of the table to its new row id
+   * @param[out] pages_before, pages_after the length of the page chain
+   * @return the number of tuples moved
+   */
+  size_t Vacuum(Transaction *txn, const MoveCallback &on_move, size_t *pages_before = nullptr,
+                size_t *pages_after = nullptr);
+
+  /**
+   * @param strategy if not nullptr, the scan only recycles the frames of its ring instead of filling the
+   *        buffer pool, e.g. a full scan of a large table
    * @return the begin iterator of this table
    */
-  TableIterator Begin(Transaction *txn);
+  TableIterator Begin(Transaction *txn, std::shared_ptr<BufferAccessStrategy> strategy = nullptr);
+
+  /**
+   * Scan of the heap a page at a time. Next pins the next page holding tuples, once, and makes its live tuples the
+   * current batch, as row ids and as views into the page. The views are valid until the next call of Next or the
+   * end of the scan, GetRow decodes a tuple to keep it longer. No page latch is taken, the heap must not be changed
+   * while a page of it is held.
+   */
+  class PageScan {
+  public:
+    /**
+     * @param strategy as for Begin
+     */
+    explicit PageScan(TableHeap *table_heap, Transaction *txn,
+                      std::shared_ptr<BufferAccessStrategy> strategy = nullptr);
+
+    /**
+     * Release the current page and move to the next one holding tuples.
+     * @return false past the last page, or if the next page could not be fetched (IsFailed)
+     */
+    bool Next();
+
+    /**
+     * @return whether the last Next stopped as a page could not be fetched, e.g. with every frame of the buffer pool
+     *         pinned, instead of at the end of the heap
+     */
+    inline bool IsFailed() const { return failed_; }
+
+    inline page_id_t GetPageId() const { return page_id_; }
+
+    inline size_t GetTupleCount() const { return rids_.size(); }
+
+    inline const std::vector<RowId> &GetRowIds() const { return rids_; }
+
+    inline const RowView &GetView(size_t idx) const { return views_[idx]; }
+
+    /**
+     * @return the tuple decoded into a new row owned by the caller
+     */
+    inline Row *GetRow(size_t idx) const { return views_[idx].ToRow(); }
+
+  private:
+    TableHeap *table_heap_;
+    [[maybe_unused]] Transaction *txn_;
+    std::shared_ptr<BufferAccessStrategy> strategy_;
+    ReadPageGuard guard_;
+    page_id_t page_id_{INVALID_PAGE_ID};
+    page_id_t next_page_id_;
+    size_t pages_until_prefetch_{0};  // pages left until the next read-ahead request
+    bool failed_{false};
+    std::vector<RowId> rids_;
+    std::vector<RowView> views_;  // only the first GetTupleCount() are of the current page
+  };
+
+  /**
+   * Visit the tuples of the heap in place, each as a view into its page, without decoding them into rows, through
+   * a PageScan. visit must not change the heap and must not keep the view after it returns.
+   * @param strategy as for Begin
+   * @return false if a page could not be fetched, the tuples after it were not visited
+   */
+  bool Scan(const std::function<void(const RowView &)> &visit, Transaction *txn,
+            std::shared_ptr<BufferAccessStrategy> strategy = nullptr);
+
+  /**
+   * Called by ParallelScan for every tuple, on the thread of the worker visiting it.
+   */
+  using ParallelScanCallback = std::function<void(size_t worker, const RowView &row)>;
+
+  /**
+   * Visit the tuples of the heap in place like Scan, on num_workers threads. The page directory is cut into
+   * num_workers ranges of consecutive pages, worker w scans the w-th, so the tuples visited by worker 0, then by
+   * worker 1 and so on are in the order of the page chain. Worker 0 runs on the calling thread, which returns when
+   * all of them are done. A heap of fewer than PARALLEL_SCAN_MIN_PAGES pages per worker gets fewer workers.
+   * visit is called concurrently and must not change the heap.
+   * @param strategy as for Begin, shared by the workers
+   * @return false if a page could not be fetched, e.g. with every frame of the buffer pool pinned. All the workers
+   *         stop then, the tuples visited are only part of the heap.
+   */
+  bool ParallelScan(size_t num_workers, const ParallelScanCallback &visit, Transaction *txn,
+                    std::shared_ptr<BufferAccessStrategy> strategy = nullptr);
+
+  /**
+   * @return the number of workers ParallelScan runs when asked for num_workers, for the heap as it is now
+   */
+  size_t GetParallelScanWorkers(size_t num_workers);
+
+  /**
+   * @return the page directory of the heap: the ids of its pages in the order of the page chain, as kept by the
+   *         free space map on disk
+   */
+  std::vector<page_id_t> GetPageIds();
 
   /**
    * @return the end iterator of this table
@@ -92,23 +226,30 @@ public:
    */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /**
+   * @param prefetch_distance number of pages iterators read ahead along the page chain, 0 to disable
+   */
+  inline void SetPrefetchDistance(size_t prefetch_distance) { prefetch_distance_ = prefetch_distance; }
+
 private:
   /**
    * create table heap and initialize first page
    */
   explicit TableHeap(BufferPoolManager *buffer_pool_manager, Schema *schema, Transaction *txn,
-                     LogManager *log_manager, LockManager *lock_manager) :
+                     LogManager *log_manager, LockManager *lock_manager, uint32_t tablespace_id) :
           buffer_pool_manager_(buffer_pool_manager),
           schema_(schema),
           log_manager_(log_manager),
           lock_manager_(lock_manager) {
+    buffer_pool_manager->CreateTablespace(this, tablespace_id);
     // first page is fetch by buffer_pool_manager
     page_id_t first_page_id;
-    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager->NewPage(first_page_id));
-    ASSERT(page != nullptr, "Create new page failed!");
-    page->Init(first_page_id, INVALID_PAGE_ID, log_manager_, txn);
-    buffer_pool_manager_->UnpinPage(first_page_id, true);
+    WritePageGuard guard = buffer_pool_manager->NewPageGuardedFor(this, first_page_id);
+    ASSERT(guard.IsValid(), "Create new page failed!");
+    reinterpret_cast<TablePage *>(guard.GetPage())->Init(first_page_id, INVALID_PAGE_ID, log_manager_, txn);
     this->first_page_id_ = first_page_id;
+    guard.Drop();
+    RebuildFreeSpaceMap({first_page_id});
   };
 
   /**
@@ -120,7 +261,51 @@ private:
             first_page_id_(first_page_id),
             schema_(schema),
             log_manager_(log_manager),
-            lock_manager_(lock_manager) {}
+            lock_manager_(lock_manager) {
+    buffer_pool_manager->OpenTablespace(this, first_page_id);
+  }
+
+  /**
+   * Add a new page at the end of the page chain.
+   * @param[out] page_id the id of the new page
+   * @return the guard of the new page, not valid if no page could be allocated
+   */
+  WritePageGuard AppendPage(page_id_t &page_id, Transaction *txn, BufferAccessStrategy *strategy);
+
+  /**
+   * Read the free space map of a loaded heap, once. A heap without one gets it built from its page chain.
+   */
+  void LoadFreeSpaceMap();
+
+  /**
+   * Write the free space map anew, for the pages of the heap in the order of the page chain, which become the page
+   * directory. The map pages of the heap are reused, the ones left over are freed.
+   */
+  void RebuildFreeSpaceMap(const std::vector<page_id_t> &page_ids);
+
+  /**
+   * @return a page of the heap with free space of at least min_category, INVALID_PAGE_ID if there is none
+   */
+  page_id_t FindFreeSpace(uint8_t min_category);
+
+  /**
+   * Set the entry of the page to its free space after an insert, update or delete.
+   */
+  void UpdateFreeSpace(page_id_t page_id, TablePage *page);
+
+  /**
+   * Add the entry of a page appended to the page chain, and the page to the page directory.
+   * @return false, changing nothing, if the free space map is full and no page could be allocated for more entries
+   */
+  bool AppendFreeSpace(page_id_t page_id, TablePage *page);
+
+  /**
+   * @return num_workers, cut down so that every worker of a parallel scan of num_pages pages gets at least
+   *         PARALLEL_SCAN_MIN_PAGES of them, at least 1
+   */
+  static size_t ParallelScanWorkers(size_t num_workers, size_t num_pages) {
+    return std::max<size_t>(1, std::min(num_workers, num_pages / PARALLEL_SCAN_MIN_PAGES));
+  }
 
 private:
   BufferPoolManager *buffer_pool_manager_;
@@ -128,6 +313,14 @@ private:
   Schema *schema_;
   [[maybe_unused]] LogManager *log_manager_;
   [[maybe_unused]] LockManager *lock_manager_;
+  size_t prefetch_distance_{DEFAULT_PREFETCH_DISTANCE};
+  std::recursive_mutex fsm_latch_;  // guards the free space map and the end of the page chain
+  bool fsm_loaded_{false};
+  page_id_t last_page_id_{INVALID_PAGE_ID};
+  std::vector<page_id_t> fsm_page_ids_;
+  std::vector<uint8_t> fsm_max_categories_;  // no entry of a map page is above, entries may be below
+  std::unordered_map<page_id_t, uint32_t> fsm_entries_;  // page of the heap to its entry in the map
+  std::vector<page_id_t> page_directory_;  // the entries of the map in order, the pages of the heap
 };
 
 #endif  // MINISQL_TABLE_HEAP_H
@@ -1,6 +1,9 @@
 #ifndef MINISQL_TABLE_ITERATOR_H
 #define MINISQL_TABLE_ITERATOR_H
 
+#include <memory>
+
+#include "buffer/buffer_access_strategy.h"
 #include "common/rowid.h"
 #include "record/row.h"
 #include "page/table_page.h"
@@ -10,7 +13,7 @@
 class TableHeap;
 class TablePage;
 
-//End(): page=nullptr  row=last row of last page
+//End(): row=nullptr
 class TableIterator {
 
 public:
@@ -24,6 +27,9 @@ public:
 
   explicit TableIterator(TableHeap *th);
 
+  // new: pages brought into the pool by the scan go into the ring of strategy if it is not nullptr
+  explicit TableIterator(TableHeap *th, Transaction *txn, std::shared_ptr<BufferAccessStrategy> strategy);
+
   virtual ~TableIterator();
 
   bool operator==(const TableIterator &itr) const;
@@ -38,9 +44,9 @@ public:
 
   Row *operator->();
 
-  // new: get row pointer
+  // new: get row pointer, the row belongs to the iterator and its copies
   Row* GetRow() {
-    return row;
+    return row.get();
   }
 
   TableIterator &operator++();
@@ -48,10 +54,21 @@ public:
   TableIterator operator++(int);
 
 private:
-  Transaction *txn;
+  // new: move to the first row of page_id or of the pages after it, row is nullptr past the last page
+  void NextPage(page_id_t page_id);
+
+  // new: called when the iterator enters a page, keeps the following pages on their way into the pool
+  void ReadAhead(page_id_t next_page_id);
+
+  // new: make the tuple at rid in the page, pinned by the caller, the current row
+  void ReadTuple(TablePage *page, const RowId &rid);
+
+private:
+  Transaction *txn{nullptr};
   TableHeap *table_heap;
-  TablePage *page;
-  Row *row{nullptr};
+  std::shared_ptr<BufferAccessStrategy> strategy;  // shared with the read-ahead requests
+  std::shared_ptr<Row> row;  // shared with the copies of the iterator, freed when the last one moves on
+  size_t pages_until_prefetch{0};  // pages left until the next read-ahead request
   // add your own private member variables here
 };
 
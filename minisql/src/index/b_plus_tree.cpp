@@ -14,41 +14,44 @@ BPLUSTREE_TYPE::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_ma
           comparator_(comparator),
           leaf_max_size_(leaf_max_size),
           internal_max_size_(internal_max_size) {
-  IndexRootsPage *index_roots_page = reinterpret_cast<IndexRootsPage *>(
-                                        buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData()
-                                        );
+  ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(INDEX_ROOTS_PAGE_ID);
+  auto index_roots_page = reinterpret_cast<IndexRootsPage *>(guard.GetPage()->GetData());
   bool ret = index_roots_page->GetRootId(index_id_, &root_page_id_);
   if (ret == false) {
     root_page_id_ = INVALID_PAGE_ID;
   }
-  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
+  // an empty tree has no page telling its file, it is found by the index id
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    buffer_pool_manager_->CreateTablespace(this, DiskManager::IndexTablespaceId(index_id_));
+  } else {
+    buffer_pool_manager_->OpenTablespace(this, root_page_id_);
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Destroy() {
-  // destroy by traversing the tree
-  DestroyChilds(root_page_id_);
+  // destroy by traversing the tree, unless it is in a file of its own
+  if (!buffer_pool_manager_->DropTablespace(this)) {
+    DestroyChilds(root_page_id_);
+  }
   root_page_id_ = INVALID_PAGE_ID;
   UpdateRootPageId();
+  buffer_pool_manager_->ReleasePages(this);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::DestroyChilds(page_id_t node_pid) {
-  Page *node_page = buffer_pool_manager_->FetchPage(node_pid);
-  BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(node_page);
-  // end traversing when the node is a leaf
-  if (node->IsLeafPage()) {
-    buffer_pool_manager_->UnpinPage(node_pid, true);
-    buffer_pool_manager_->DeletePage(node_pid);
-    return;
-  }
-  // recursive
-  for (int i = 0; i < node->GetSize(); i++) {
-    InternalPage* inter = reinterpret_cast<InternalPage *>(node);
-    page_id_t child_pid = inter->ValueAt(i);
-    DestroyChilds(child_pid);
+  ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(node_pid);
+  auto node = reinterpret_cast<const BPlusTreePage *>(guard.GetData());
+  // recursive, traversing ends when the node is a leaf
+  if (!node->IsLeafPage()) {
+    auto inter = reinterpret_cast<const InternalPage *>(node);
+    for (int i = 0; i < inter->GetSize(); i++) {
+      DestroyChilds(inter->ValueAt(i));
+    }
   }
-  buffer_pool_manager_->UnpinPage(node_pid, true);
+  // the page is going away, no need to write it back
+  guard.Drop();
   buffer_pool_manager_->DeletePage(node_pid);
 }
 
@@ -70,20 +73,48 @@ bool BPLUSTREE_TYPE::IsEmpty() const {
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> &result, Transaction *transaction) {
-  LeafPage *leaf = FindLeafPage(key);
-  if (leaf == nullptr) 
+  ReadPageGuard guard = FindLeafPageRead(key);
+  if (!guard.IsValid())
   { // not found
     return false;
   }
+  auto leaf = reinterpret_cast<const LeafPage *>(guard.GetData());
   ValueType value;
   bool ifNoError = leaf->Lookup(key, value, comparator_);
   // append to result vector
   if (ifNoError)
     result.push_back(value);
-  buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
   return ifNoError;
 }
 
+/*
+ * Point query for keys sorted in ascending order. Keys following each other
+ * mostly fall into the same leaf, it is kept pinned while it surely holds the
+ * next key: a leaf found for some key holds every greater key up to its last
+ * key, and the last leaf all greater keys. A key past the last key is known
+ * to be missing without a search, as in a load appending to the tree.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::LookupSorted(const std::vector<KeyType> &keys, std::vector<bool> &found, Transaction *transaction) {
+  found.assign(keys.size(), false);
+  ReadPageGuard guard;
+  const LeafPage *leaf = nullptr;
+  for (size_t i = 0; i < keys.size(); i++) {
+    int to_last = leaf == nullptr ? 1 : CompareToLast(leaf, keys[i]);
+    if (leaf == nullptr || (to_last > 0 && leaf->GetNextPageId() != INVALID_PAGE_ID)) {
+      guard = FindLeafPageRead(keys[i]);
+      if (!guard.IsValid()) {
+        // empty tree
+        return;
+      }
+      leaf = reinterpret_cast<const LeafPage *>(guard.GetData());
+      to_last = CompareToLast(leaf, keys[i]);
+    }
+    ValueType value;
+    found[i] = to_last == 0 || (to_last < 0 && leaf->Lookup(keys[i], value, comparator_));
+  }
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
@@ -112,7 +143,7 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
   // ask for new page from buffer pool manager
   page_id_t new_root_pid;
-  Page *new_root_page = buffer_pool_manager_->NewPage(new_root_pid);
+  Page *new_root_page = buffer_pool_manager_->NewPageFor(this, new_root_pid);
   if (new_root_page == nullptr) {
     throw std::bad_alloc();
   }
@@ -165,6 +196,69 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
   return true;
 }
 
+/*
+ * Insert key & value pairs sorted by key. The leaf of a key stays pinned for
+ * the following keys while it surely holds them, as in LookupSorted, and keys
+ * past its last key are appended without a search. A full leaf is split like
+ * in InsertIntoLeaf and the next key searched from the root again.
+ * @return: the number of pairs inserted, duplicate keys are skipped
+ */
+INDEX_TEMPLATE_ARGUMENTS
+size_t BPLUSTREE_TYPE::InsertSorted(const std::vector<MappingType> &entries, Transaction *transaction) {
+  size_t inserted = 0;
+  LeafPage *leaf_page = nullptr;
+  bool dirty = false;
+  for (auto &entry : entries) {
+    int to_last = leaf_page == nullptr ? 1 : CompareToLast(leaf_page, entry.first);
+    if (leaf_page != nullptr && to_last > 0 && leaf_page->GetNextPageId() != INVALID_PAGE_ID) {
+      buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), dirty);
+      leaf_page = nullptr;
+    }
+    if (leaf_page == nullptr) {
+      if (IsEmpty()) {
+        StartNewTree(entry.first, entry.second);
+        inserted++;
+        continue;
+      }
+      leaf_page = FindLeafPage(entry.first);
+      dirty = false;
+      to_last = CompareToLast(leaf_page, entry.first);
+    }
+    ValueType value_discard;
+    if (to_last == 0 || (to_last < 0 && leaf_page->Lookup(entry.first, value_discard, comparator_))) {
+      continue;
+    }
+    inserted++;
+    if (to_last > 0) {
+      leaf_page->Append(entry.first, entry.second);
+    } else {
+      leaf_page->Insert(entry.first, entry.second, comparator_);
+    }
+    dirty = true;
+    if (leaf_page->GetSize() <= leaf_page->GetMaxSize()) {
+      continue;
+    }
+    // split leaf page
+    LeafPage *new_leaf = Split(leaf_page);
+    InsertIntoParent(leaf_page, new_leaf->KeyAt(0), new_leaf);
+    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
+    buffer_pool_manager_->UnpinPage(new_leaf->GetPageId(), true);
+    leaf_page = nullptr;
+  }
+  if (leaf_page != nullptr) {
+    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), dirty);
+  }
+  return inserted;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::CompareToLast(const LeafPage *leaf, const KeyType &key) const {
+  if (leaf->GetSize() == 0) {
+    return 1;
+  }
+  return comparator_(key, leaf->KeyAt(leaf->GetSize() - 1));
+}
+
 /*
  * Split input page and return newly created page.
  * Using template N to represent either internal page or leaf page.
@@ -177,7 +271,7 @@ template<typename N>
 N *BPLUSTREE_TYPE::Split(N *node) {
   // ask for new page from buffer pool manager
   page_id_t new_page_id;
-  Page *new_page = buffer_pool_manager_->NewPage(new_page_id);
+  Page *new_page = buffer_pool_manager_->NewPageFor(this, new_page_id);
   if (new_page == nullptr) {
       throw std::bad_alloc();
   }
@@ -211,7 +305,7 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
   if (old_node->IsRootPage()) {
     // old_node is root
     page_id_t new_root_pid;
-    Page *new_root_page = buffer_pool_manager_->NewPage(new_root_pid);
+    Page *new_root_page = buffer_pool_manager_->NewPageFor(this, new_root_pid);
     if (new_root_page == nullptr) {
         throw std::bad_alloc();
     }
@@ -464,8 +558,7 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
   KeyType placeholder = KeyType();
-  auto left_most_leaf = FindLeafPage(placeholder, true);
-  return INDEXITERATOR_TYPE(left_most_leaf, 0, buffer_pool_manager_);
+  return INDEXITERATOR_TYPE(FindLeafPageRead(placeholder, true), 0, buffer_pool_manager_, prefetch_distance_);
 }
 
 /*
@@ -475,12 +568,12 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
-  LeafPage *leaf = FindLeafPage(key);
+  ReadPageGuard guard = FindLeafPageRead(key);
   int index = 0;
-  if (leaf != nullptr) {
-    index = leaf->KeyIndex(key, comparator_);
+  if (guard.IsValid()) {
+    index = reinterpret_cast<const LeafPage *>(guard.GetData())->KeyIndex(key, comparator_);
   }
-  return INDEXITERATOR_TYPE(leaf, index, buffer_pool_manager_);
+  return INDEXITERATOR_TYPE(std::move(guard), index, buffer_pool_manager_, prefetch_distance_);
 }
 
 /*
@@ -490,7 +583,7 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::End() {
-  INDEXITERATOR_TYPE iter_end(nullptr, 0, buffer_pool_manager_);
+  INDEXITERATOR_TYPE iter_end(ReadPageGuard(), 0, buffer_pool_manager_);
   return iter_end;
 }
 
@@ -504,34 +597,40 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::End() {
  */
 INDEX_TEMPLATE_ARGUMENTS
 B_PLUS_TREE_LEAF_PAGE_TYPE *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
-  if (IsEmpty()) {
+  ReadPageGuard guard = FindLeafPageRead(key, leftMost);
+  if (!guard.IsValid()) {
     return nullptr;
   }
-  // state init: currently on root
-  page_id_t node_pid = root_page_id_;
-  auto node_page = GetPageWithPid(node_pid);
-  BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(node_page->GetData());
+  // the caller may modify the leaf, it takes its own pin and decides whether the leaf is dirty
+  return reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(GetPageWithPid(guard.PageId())->GetData());
+}
 
+/*
+ * Same search as FindLeafPage, internal pages are only read and unpinned clean.
+ * Note: the child is pinned before its parent is released.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+ReadPageGuard BPLUSTREE_TYPE::FindLeafPageRead(const KeyType &key, bool leftMost) {
+  if (IsEmpty()) {
+    return {};
+  }
+  // state init: currently on root
+  ReadPageGuard guard(buffer_pool_manager_, GetPageWithPid(root_page_id_));
+  auto node = reinterpret_cast<const BPlusTreePage *>(guard.GetData());
   while (!node->IsLeafPage()) {
     // get next
-    InternalPage *internalPage = static_cast<InternalPage *>(node);
+    auto internalPage = static_cast<const InternalPage *>(node);
     page_id_t next_pid;
     if (leftMost) {
       next_pid = internalPage->ValueAt(0);
     } else {
       next_pid = internalPage->Lookup(key, comparator_);
     }
-    // temp store
-    Page *last_page = node_page;
-    // state transfer
-    node_pid = next_pid;
-    node_page = GetPageWithPid(next_pid);
-    node = reinterpret_cast<BPlusTreePage *>(node_page->GetData());
-    // unpin last page
-    buffer_pool_manager_->UnpinPage(last_page->GetPageId(), false);
-  }
-  // node pinned and returned
-  return static_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(node);
+    // state transfer, the last page is unpinned by the move
+    guard = ReadPageGuard(buffer_pool_manager_, GetPageWithPid(next_pid));
+    node = reinterpret_cast<const BPlusTreePage *>(guard.GetData());
+  }
+  return guard;
 }
 
 /*
@@ -544,14 +643,12 @@ B_PLUS_TREE_LEAF_PAGE_TYPE *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, boo
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
-  IndexRootsPage *index_roots_page = reinterpret_cast<IndexRootsPage *>(
-                                      buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData()
-                                      );
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(INDEX_ROOTS_PAGE_ID);
+  auto index_roots_page = reinterpret_cast<IndexRootsPage *>(guard.GetData());
   bool ret = index_roots_page->Update(index_id_, root_page_id_);
   if (!ret) {
     index_roots_page->Insert(index_id_, root_page_id_);
   }
-  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
 }
 
 /**
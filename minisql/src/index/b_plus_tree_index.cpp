@@ -84,6 +84,31 @@ dberr_t BPLUSTREE_INDEX_TYPE::ScanKey(const Row &key, const int8_t compareType,
   return DB_SUCCESS;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t BPLUSTREE_INDEX_TYPE::ScanKeys(const vector<Row *> &keys, vector<bool> &found, Transaction *txn) {
+  vector<KeyType> index_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    index_keys[i].SerializeFromKey(*keys[i], key_schema_);
+  }
+  container_.LookupSorted(index_keys, found, txn);
+  return DB_SUCCESS;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t BPLUSTREE_INDEX_TYPE::InsertEntries(const vector<Row *> &keys, const vector<RowId> &row_ids,
+                                            Transaction *txn) {
+  vector<MappingType> entries(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    ASSERT(row_ids[i].Get() != INVALID_ROWID.Get(), "Invalid row id for index insert.");
+    entries[i].first.SerializeFromKey(*keys[i], key_schema_);
+    entries[i].second = row_ids[i];
+  }
+  if (container_.InsertSorted(entries, txn) != entries.size()) {
+    return DB_FAILED;
+  }
+  return DB_SUCCESS;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 dberr_t BPLUSTREE_INDEX_TYPE::Destroy() {
   container_.Destroy();
@@ -2,14 +2,12 @@
 #include "index/generic_key.h"
 #include "index/index_iterator.h"
 
-INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE::IndexIterator(B_PLUS_TREE_LEAF_PAGE_TYPE *leaf, int index, BufferPoolManager *bpm)
-  :leaf_(leaf), bpm_(bpm), index_(index) {}
-
-INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE::~IndexIterator() {
-    if (leaf_ != nullptr) {
-        bpm_->UnpinPage(leaf_->GetPageId(), false);
-        bpm_->UnpinPage(leaf_->GetPageId(), false);
-    }
+INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE::IndexIterator(ReadPageGuard leaf_guard, int index, BufferPoolManager *bpm,
+                                                           size_t prefetch_distance)
+  :leaf_guard_(std::move(leaf_guard)), bpm_(bpm), index_(index), prefetch_distance_(prefetch_distance) {
+  leaf_ = leaf_guard_.IsValid() ? reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(leaf_guard_.GetPage()->GetData())
+                                : nullptr;
+  ReadAhead();
 }
 
 INDEX_TEMPLATE_ARGUMENTS const MappingType &INDEXITERATOR_TYPE::operator*() {
@@ -25,19 +23,36 @@ INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
   if (index_ >= leaf_->GetSize()) {
     index_ = 0;
     page_id_t next_page_id = leaf_->GetNextPageId();
-    bpm_->UnpinPage(leaf_->GetPageId(), false);
     if (next_page_id == INVALID_PAGE_ID) {
       // end of iteration
+      leaf_guard_.Drop();
       leaf_ = nullptr;
     } else {
-      // update leaf to next_page
-      Page *next_page = bpm_->FetchPage(next_page_id);
-      leaf_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(next_page->GetData());
+      // update leaf to next_page, the last leaf is unpinned by the move
+      leaf_guard_ = bpm_->FetchPageRead(next_page_id);
+      leaf_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(leaf_guard_.GetPage()->GetData());
+      ReadAhead();
     }
   }
   return *this;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::ReadAhead() {
+  if (leaf_ == nullptr || prefetch_distance_ == 0 || leaf_->GetNextPageId() == INVALID_PAGE_ID) {
+    return;
+  }
+  // the prefetcher walks the leaf chain itself, so only ask again when half of the window is consumed
+  if (leaves_until_prefetch_ > 0) {
+    leaves_until_prefetch_--;
+    return;
+  }
+  bpm_->Prefetch(leaf_->GetNextPageId(), prefetch_distance_, [](const char *page_data) {
+    return reinterpret_cast<const B_PLUS_TREE_LEAF_PAGE_TYPE *>(page_data)->GetNextPageId();
+  });
+  leaves_until_prefetch_ = prefetch_distance_ / 2;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 bool INDEXITERATOR_TYPE::operator==(const IndexIterator &itr) const {
   return leaf_ == itr.leaf_ && index_ == itr.index_ && bpm_ == itr.bpm_;
@@ -34,13 +34,26 @@ void InputCommand(char *input, const int len) {
   getchar();        // remove enter
 }
 
+// new: --buffer_pool_budget=<MB> caps the memory of the buffer pools of all databases together,
+// without it the budget follows the cgroup memory limit
+size_t ParseBufferPoolBudget(int argc, char **argv) {
+  const string flag = "--buffer_pool_budget=";
+  for (int i = 1; i < argc; i++) {
+    string arg = argv[i];
+    if (arg.compare(0, flag.size(), flag) == 0) {
+      return stoull(arg.substr(flag.size())) * 1024 * 1024 / PAGE_SIZE;
+    }
+  }
+  return 0;
+}
+
 int main(int argc, char **argv) {
   InitGoogleLog(argv[0]);
   // command buffer
   const int buf_size = 1024;
   char cmd[buf_size];
   // execute engine
-  ExecuteEngine engine;
+  ExecuteEngine engine(ParseBufferPoolBudget(argc, argv));
   // for print syntax tree
   // string prefix = "stree_"; // for test
   string prefix = "syntax_tree_";
@@ -1,4 +1,7 @@
 #include "page/bitmap_page.h"
+
+#include <algorithm>
+
 //0 for allocated,and 1 for free
 template<size_t PageSize>
 bool BitmapPage<PageSize>::AllocatePage(uint32_t &page_offset) {
@@ -12,24 +15,37 @@ bool BitmapPage<PageSize>::AllocatePage(uint32_t &page_offset) {
   uint32_t byte_index = page_offset / 8;
   uint32_t bit_index = page_offset % 8;
   this->bytes[byte_index] |= (1<<bit_index) ;
-  
-  for(uint32_t i = 0;i < MAX_CHARS;i++)
-  {
-    if(this->bytes[i]<0xff)
-    {
-      for(uint32_t j = 0;j < 8;j++)
-      {
-        uint32_t bit_judge = bytes[i]>>j & 1;
-        if(bit_judge == 0)
-        {
-          next_free_page_ = i*8+j;
-          break;
-        }
-      }
-      break;
+
+  // every page below the one just taken is allocated, the next free one is above it
+  next_free_page_ = FindFreePage(page_offset + 1);
+  return true;
+}
+
+template<size_t PageSize>
+bool BitmapPage<PageSize>::AllocateRun(uint32_t count, uint32_t &page_offset) {
+  // every page below next_free_page_ is allocated
+  uint32_t first = FindFreePage(std::max(page_offset, next_free_page_));
+  while (count > 0 && first + count <= GetMaxSupportedSize()) {
+    uint32_t end = first + 1;
+    while (end < first + count && IsPageFree(end)) {
+      end++;
+    }
+    if (end < first + count) {
+      // page end is allocated, no run can start at or below it
+      first = FindFreePage(end + 1);
+      continue;
     }
+    for (uint32_t i = first; i < end; i++) {
+      bytes[i / 8] |= (1 << (i % 8));
+    }
+    page_allocated_ += count;
+    if (first == next_free_page_) {
+      next_free_page_ = FindFreePage(end);
+    }
+    page_offset = first;
+    return true;
   }
-  return true;
+  return false;
 }
 
 template<size_t PageSize>
@@ -42,25 +58,50 @@ bool BitmapPage<PageSize>::DeAllocatePage(uint32_t page_offset) {
   bytes[byte_index] -= (1<<bit_index);
 
   page_allocated_ --;
-  for(uint32_t i = 0;i < MAX_CHARS;i++)
-  {
-    if(this->bytes[i]<0xff)
-    {
-      for(uint32_t j = 0;j < 8;j++)
-      {
-        uint32_t bit_judge = bytes[i]>>j & 1;
-        if(bit_judge == 0)
-        {
-          next_free_page_ = i*8+j;
-          break;
-        }
-      }
-      break;
-    }
+  // keep pointing at the lowest free page
+  if (page_offset < next_free_page_) {
+    next_free_page_ = page_offset;
   }
   return true;
 }
 
+template<size_t PageSize>
+uint32_t BitmapPage<PageSize>::FindFreePage(uint32_t page_offset) const {
+  uint32_t byte_index = page_offset / 8;
+  if (byte_index >= MAX_CHARS) {
+    return GetMaxSupportedSize();
+  }
+  // the rest of the first byte, whole bytes up to a word boundary, then whole words
+  uint32_t free_bits = static_cast<uint8_t>(~bytes[byte_index]) >> (page_offset % 8) << (page_offset % 8);
+  if (free_bits != 0) {
+    return byte_index * 8 + __builtin_ctz(free_bits);
+  }
+  byte_index++;
+  for (; byte_index < MAX_CHARS && byte_index % sizeof(uint64_t) != 0; byte_index++) {
+    if (bytes[byte_index] != 0xff) {
+      return byte_index * 8 + __builtin_ctz(static_cast<uint8_t>(~bytes[byte_index]));
+    }
+  }
+  for (; byte_index + sizeof(uint64_t) <= MAX_CHARS; byte_index += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, bytes + byte_index, sizeof(uint64_t));
+    if (word == ~0ULL) {
+      continue;
+    }
+    // the byte order of the word does not matter, only which byte has a free bit
+    while (bytes[byte_index] == 0xff) {
+      byte_index++;
+    }
+    return byte_index * 8 + __builtin_ctz(static_cast<uint8_t>(~bytes[byte_index]));
+  }
+  for (; byte_index < MAX_CHARS; byte_index++) {
+    if (bytes[byte_index] != 0xff) {
+      return byte_index * 8 + __builtin_ctz(static_cast<uint8_t>(~bytes[byte_index]));
+    }
+  }
+  return GetMaxSupportedSize();
+}
+
 template<size_t PageSize>
 bool BitmapPage<PageSize>::IsPageFree(uint32_t page_offset) const {
   uint32_t byte_index = page_offset / 8;
@@ -104,4 +145,13 @@ template
 class BitmapPage<2048>;
 
 template
-class BitmapPage<4096>;
\ No newline at end of file
+class BitmapPage<4096>;
+
+template
+class BitmapPage<8192>;
+
+template
+class BitmapPage<16384>;
+
+template
+class BitmapPage<32768>;
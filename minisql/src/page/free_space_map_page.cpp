@@ -0,0 +1,38 @@
+#include "page/free_space_map_page.h"
+
+#include <algorithm>
+
+bool FreeSpaceMapPage::Append(page_id_t page_id, uint8_t category) {
+  if (IsFull()) {
+    return false;
+  }
+  page_ids_[count_] = page_id;
+  categories_[count_] = category;
+  count_++;
+  return true;
+}
+
+int FreeSpaceMapPage::Find(uint8_t min_category) const {
+  for (uint32_t i = 0; i < count_; i++) {
+    if (categories_[i] >= min_category) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+uint8_t FreeSpaceMapPage::GetMaxCategory() const {
+  uint8_t max_category = 0;
+  for (uint32_t i = 0; i < count_; i++) {
+    max_category = std::max(max_category, categories_[i]);
+  }
+  return max_category;
+}
+
+uint8_t FreeSpaceMapPage::CategoryOf(uint32_t free_space) {
+  return static_cast<uint8_t>(std::min<uint32_t>(free_space / CATEGORY_SIZE, UINT8_MAX));
+}
+
+uint8_t FreeSpaceMapPage::CategoryFor(uint32_t space_needed) {
+  return static_cast<uint8_t>(std::min<uint32_t>((space_needed + CATEGORY_SIZE - 1) / CATEGORY_SIZE, UINT8_MAX));
+}
@@ -6,6 +6,7 @@ void TablePage::Init(page_id_t page_id, page_id_t prev_id, LogManager *log_mgr,
   SetNextPageId(INVALID_PAGE_ID);
   SetFreeSpacePointer(PAGE_SIZE);
   SetTupleCount(0);
+  SetFsmPageId(INVALID_PAGE_ID);
 }
 
 bool TablePage::InsertTuple(Row &row, Schema *schema, Transaction *txn,
@@ -188,3 +189,20 @@ bool TablePage::GetNextTupleRid(const RowId &cur_rid, RowId *next_rid) {
   next_rid->Set(INVALID_PAGE_ID, 0);
   return false;
 }
+
+bool TablePage::IsEmpty() {
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    if (GetTupleSize(i) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void TablePage::TrimSlots() {
+  uint32_t tuple_count = GetTupleCount();
+  while (tuple_count > 0 && GetTupleSize(tuple_count - 1) == 0) {
+    tuple_count--;
+  }
+  SetTupleCount(tuple_count);
+}
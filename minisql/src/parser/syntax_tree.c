@@ -169,6 +169,10 @@ const char *GetSyntaxNodeTypeStr(SyntaxNodeType type) {
       return "kNodeTrxCommit";
     case kNodeTrxRollback:
       return "kNodeTrxRollback";
+    case kNodeSetVariable:
+      return "kNodeSetVariable";
+    case kNodeVacuum:
+      return "kNodeVacuum";
     default:
       return "error type";
   }
@@ -62,6 +62,7 @@ uint32_t Row::SerializeTo(char *buf, Schema *schema) const {
       ofs += field->SerializeTo(buf+ofs);             // 3 - fields
     }
   }
+  delete[] null_bitmap;
   return ofs;
 }
 
@@ -91,6 +92,7 @@ uint32_t Row::DeserializeFrom(char *buf, Schema *schema) {
                                   &temp_field, IsBitSetOfChars(null_bitmap, i), heap_);  
     this->fields_.push_back(temp_field);
   }
+  delete[] null_bitmap;
   return ofs;
 }
 
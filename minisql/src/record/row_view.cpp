@@ -0,0 +1,61 @@
+#include "record/row_view.h"
+
+void RowView::Reset(const char *data, RowId rid) {
+  data_ = data;
+  rid_ = rid;
+  field_count_ = MACH_READ_UINT32(data);
+  offsets_.clear();
+  // the fields start after the field count and the null bitmap
+  offsets_.push_back(sizeof(uint32_t) + field_count_ / 8 + 1);
+}
+
+bool RowView::IsNull(uint32_t idx) const {
+  ASSERT(idx < field_count_, "Failed to access field");
+  const char *null_bitmap = data_ + sizeof(uint32_t);
+  return (null_bitmap[idx / 8] & (1 << (idx % 8))) != 0;
+}
+
+Field RowView::GetField(uint32_t idx) const {
+  TypeId type = schema_->GetColumn(idx)->GetType();
+  if (IsNull(idx)) {
+    return Field(type);
+  }
+  const char *buf = data_ + OffsetOf(idx);
+  switch (type) {
+    case kTypeInt:
+      return Field(type, MACH_READ_FROM(int32_t, buf));
+    case kTypeFloat:
+      return Field(type, MACH_READ_FROM(float_t, buf));
+    case kTypeChar:
+      return Field(type, const_cast<char *>(buf + sizeof(uint32_t)), MACH_READ_UINT32(buf), false);
+    default:
+      LOG(ERROR) << "Unknown field type " << type << "." << endl;
+      return Field(type);
+  }
+}
+
+Row *RowView::ToRow() const {
+  auto row = new Row(rid_);
+  row->DeserializeFrom(const_cast<char *>(data_), schema_);
+  return row;
+}
+
+uint32_t RowView::OffsetOf(uint32_t idx) const {
+  ASSERT(idx < field_count_, "Failed to access field");
+  while (offsets_.size() <= idx) {
+    uint32_t prev = offsets_.size() - 1;
+    uint32_t size = 0;
+    if (!IsNull(prev)) {
+      switch (schema_->GetColumn(prev)->GetType()) {
+        case kTypeChar:
+          size = sizeof(uint32_t) + MACH_READ_UINT32(data_ + offsets_[prev]);
+          break;
+        default:
+          size = Type::GetTypeSize(schema_->GetColumn(prev)->GetType());
+          break;
+      }
+    }
+    offsets_.push_back(offsets_[prev] + size);
+  }
+  return offsets_[idx];
+}
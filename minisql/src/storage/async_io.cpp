@@ -0,0 +1,353 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <thread>
+#include <unistd.h>
+
+#include "glog/logging.h"
+#include "storage/async_io.h"
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#define MINISQL_HAVE_IO_URING
+#endif
+
+namespace {
+
+/**
+ * Runs every request with a blocking pread/pwrite on one of a few threads.
+ */
+class ThreadPoolAsyncIO : public AsyncIO {
+public:
+  ThreadPoolAsyncIO(int fd, size_t queue_depth, size_t num_threads) : fd_(fd), queue_depth_(queue_depth) {
+    for (size_t i = 0; i < num_threads; i++) {
+      threads_.emplace_back(&ThreadPoolAsyncIO::WorkerLoop, this);
+    }
+  }
+
+  ~ThreadPoolAsyncIO() override {
+    {
+      std::scoped_lock<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto &thread : threads_) {
+      thread.join();
+    }
+  }
+
+  void Submit(std::vector<AsyncIORequest> &requests) override {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (auto &request : requests) {
+      done_cv_.wait(lock, [this] { return queue_.size() + active_ < queue_depth_; });
+      queue_.push_back(std::move(request));
+      cv_.notify_one();
+    }
+  }
+
+  Backend GetBackend() const override { return Backend::THREAD_POOL; }
+
+private:
+  void WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      // the queue is drained before stopping
+      cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      AsyncIORequest request = std::move(queue_.front());
+      queue_.pop_front();
+      active_++;
+      lock.unlock();
+      size_t done = 0;
+      ssize_t result = 0;
+      while (done < request.len_) {
+        ssize_t n = request.write_
+                    ? pwrite(fd_, request.data_ + done, request.len_ - done, request.offset_ + done)
+                    : pread(fd_, request.data_ + done, request.len_ - done, request.offset_ + done);
+        if (n < 0 && errno == EINTR) {
+          continue;
+        }
+        if (n <= 0) {
+          result = n < 0 ? -errno : 0;
+          break;
+        }
+        done += n;
+      }
+      request.callback_(done > 0 ? static_cast<ssize_t>(done) : result);
+      lock.lock();
+      active_--;
+      done_cv_.notify_all();
+    }
+  }
+
+private:
+  int fd_;
+  size_t queue_depth_;
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;                       // to protect the fields below
+  std::condition_variable cv_;             // to wake up the workers
+  std::condition_variable done_cv_;        // to wake up a submitter waiting for room in the queue
+  std::deque<AsyncIORequest> queue_;
+  size_t active_{0};                       // requests taken by a worker
+  bool stop_{false};
+};
+
+#ifdef MINISQL_HAVE_IO_URING
+
+/**
+ * Submits the requests to an io_uring and reaps the completions on one thread. The submission queue has a
+ * single producer (under mutex_) and the completion queue a single consumer (the reaper thread), which is
+ * all the synchronization the rings need besides the acquire/release of their head and tail.
+ */
+class IoUringAsyncIO : public AsyncIO {
+public:
+  /**
+   * @return nullptr if io_uring can not be set up, e.g. the kernel does not have it
+   */
+  static std::unique_ptr<AsyncIO> Create(int fd, size_t queue_depth) {
+    std::unique_ptr<IoUringAsyncIO> io(new IoUringAsyncIO(fd));
+    if (!io->Setup(queue_depth)) {
+      return nullptr;
+    }
+    io->reaper_ = std::thread(&IoUringAsyncIO::ReaperLoop, io.get());
+    return io;
+  }
+
+  ~IoUringAsyncIO() override {
+    if (reaper_.joinable()) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return in_flight_ == 0; });
+      // a no-op without a request tells the reaper to exit
+      io_uring_sqe *sqe = NextSqe();
+      sqe->opcode = IORING_OP_NOP;
+      CommitSqes(1);
+      lock.unlock();
+      reaper_.join();
+    }
+    if (sqes_ != MAP_FAILED && sqes_ != nullptr) {
+      munmap(sqes_, sqes_size_);
+    }
+    if (cq_ptr_ != sq_ptr_ && cq_ptr_ != MAP_FAILED && cq_ptr_ != nullptr) {
+      munmap(cq_ptr_, cq_map_size_);
+    }
+    if (sq_ptr_ != MAP_FAILED && sq_ptr_ != nullptr) {
+      munmap(sq_ptr_, sq_map_size_);
+    }
+    if (ring_fd_ >= 0) {
+      close(ring_fd_);
+    }
+  }
+
+  void Submit(std::vector<AsyncIORequest> &requests) override {
+    std::vector<PendingIO *> failed;
+    int error = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    unsigned queued = 0;
+    for (auto &request : requests) {
+      if (in_flight_ + queued >= queue_depth_) {
+        // start what is queued before waiting for room
+        in_flight_ += CommitSqes(queued, &failed, &error);
+        queued = 0;
+        cv_.wait(lock, [this] { return in_flight_ < queue_depth_; });
+      }
+      auto *pending = new PendingIO{std::move(request), {}};
+      pending->iov_.iov_base = pending->request_.data_;
+      pending->iov_.iov_len = pending->request_.len_;
+      io_uring_sqe *sqe = NextSqe(queued);
+      sqe->opcode = pending->request_.write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+      sqe->fd = fd_;
+      sqe->addr = reinterpret_cast<uint64_t>(&pending->iov_);
+      sqe->len = 1;
+      sqe->off = pending->request_.offset_;
+      sqe->user_data = reinterpret_cast<uint64_t>(pending);
+      queued++;
+    }
+    in_flight_ += CommitSqes(queued, &failed, &error);
+    lock.unlock();
+    // the requests the kernel did not take never reach the reaper, they fail here
+    for (auto pending : failed) {
+      pending->request_.callback_(-error);
+      delete pending;
+    }
+  }
+
+  Backend GetBackend() const override { return Backend::IO_URING; }
+
+private:
+  struct PendingIO {
+    AsyncIORequest request_;
+    iovec iov_;
+  };
+
+  explicit IoUringAsyncIO(int fd) : fd_(fd) {}
+
+  bool Setup(size_t queue_depth) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    // the exit no-op needs a free entry, the kernel rounds the number of entries up to a power of two
+    ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, static_cast<unsigned>(queue_depth + 1), &params));
+    if (ring_fd_ < 0) {
+      return false;
+    }
+    queue_depth_ = std::min<size_t>(queue_depth, params.sq_entries - 1);
+    if (queue_depth_ == 0) {
+      return false;
+    }
+    sq_map_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_map_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      sq_map_size_ = cq_map_size_ = std::max(sq_map_size_, cq_map_size_);
+    }
+    sq_ptr_ = mmap(nullptr, sq_map_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                   IORING_OFF_SQ_RING);
+    if (sq_ptr_ == MAP_FAILED) {
+      return false;
+    }
+    cq_ptr_ = single_mmap ? sq_ptr_ : mmap(nullptr, cq_map_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                           ring_fd_, IORING_OFF_CQ_RING);
+    if (cq_ptr_ == MAP_FAILED) {
+      return false;
+    }
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe *>(mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                             ring_fd_, IORING_OFF_SQES));
+    if (sqes_ == MAP_FAILED) {
+      return false;
+    }
+    auto *sq = static_cast<char *>(sq_ptr_);
+    sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    auto *cq = static_cast<char *>(cq_ptr_);
+    cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  /** @return the entry after the offset entries already filled but not committed, zeroed */
+  io_uring_sqe *NextSqe(unsigned offset = 0) {
+    unsigned index = (*sq_tail_ + offset) & sq_mask_;
+    io_uring_sqe *sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(io_uring_sqe));
+    sq_array_[index] = index;
+    return sqe;
+  }
+
+  /**
+   * Publish the count entries filled by NextSqe and submit them to the kernel. If the kernel fails, the entries it
+   * did not take are taken back out of the submission queue, so no later io_uring_enter submits them.
+   * @param[out] failed the requests of the entries taken back
+   * @param[out] error the errno of the failure, untouched if there is none
+   * @return the number of entries submitted
+   */
+  unsigned CommitSqes(unsigned count, std::vector<PendingIO *> *failed = nullptr, int *error = nullptr) {
+    if (count == 0) {
+      return 0;
+    }
+    __atomic_store_n(sq_tail_, *sq_tail_ + count, __ATOMIC_RELEASE);
+    unsigned submitted = 0;
+    while (submitted < count) {
+      long ret = syscall(__NR_io_uring_enter, ring_fd_, count - submitted, 0, 0, nullptr, 0);
+      if (ret < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY)) {
+        continue;
+      }
+      if (ret < 0) {
+        int enter_error = errno;
+        LOG(ERROR) << "io_uring_enter failed: " << strerror(enter_error);
+        // the kernel only takes entries in an io_uring_enter submitting them, and those run under mutex_
+        unsigned tail = *sq_tail_ - (count - submitted);
+        for (unsigned i = tail; failed != nullptr && i != *sq_tail_; i++) {
+          failed->push_back(reinterpret_cast<PendingIO *>(sqes_[sq_array_[i & sq_mask_]].user_data));
+        }
+        __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+        if (error != nullptr) {
+          *error = enter_error;
+        }
+        return submitted;
+      }
+      submitted += ret;
+    }
+    return submitted;
+  }
+
+  void ReaperLoop() {
+    while (true) {
+      long ret = syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+      if (ret < 0 && errno != EINTR) {
+        LOG(ERROR) << "io_uring_enter failed: " << strerror(errno);
+      }
+      unsigned head = *cq_head_;
+      unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      size_t completed = 0;
+      bool stop = false;
+      for (; head != tail; head++) {
+        io_uring_cqe &cqe = cqes_[head & cq_mask_];
+        auto *pending = reinterpret_cast<PendingIO *>(cqe.user_data);
+        if (pending == nullptr) {
+          stop = true;
+          continue;
+        }
+        pending->request_.callback_(cqe.res);
+        delete pending;
+        completed++;
+      }
+      __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+      if (completed > 0) {
+        std::scoped_lock<std::mutex> lock(mutex_);
+        in_flight_ -= completed;
+        cv_.notify_all();
+      }
+      if (stop) {
+        return;
+      }
+    }
+  }
+
+private:
+  int fd_;
+  int ring_fd_{-1};
+  size_t queue_depth_{0};
+  void *sq_ptr_{nullptr};
+  void *cq_ptr_{nullptr};
+  size_t sq_map_size_{0};
+  size_t cq_map_size_{0};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+  unsigned *sq_tail_{nullptr};
+  unsigned sq_mask_{0};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned cq_mask_{0};
+  io_uring_cqe *cqes_{nullptr};
+  std::thread reaper_;
+  std::mutex mutex_;                       // to protect the submission queue and in_flight_
+  std::condition_variable cv_;             // signaled when I/Os complete
+  size_t in_flight_{0};
+};
+
+#endif  // MINISQL_HAVE_IO_URING
+
+}  // namespace
+
+std::unique_ptr<AsyncIO> AsyncIO::Create(int fd, size_t queue_depth, bool use_io_uring) {
+#ifdef MINISQL_HAVE_IO_URING
+  if (use_io_uring) {
+    auto io = IoUringAsyncIO::Create(fd, queue_depth);
+    if (io != nullptr) {
+      return io;
+    }
+    LOG(WARNING) << "io_uring is not available, using " << ASYNC_IO_THREADS << " I/O threads.";
+  }
+#endif
+  return std::make_unique<ThreadPoolAsyncIO>(fd, queue_depth, ASYNC_IO_THREADS);
+}
@@ -1,127 +1,885 @@
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <dirent.h>
+#include <fcntl.h>
 #include <stdexcept>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #include "glog/logging.h"
 #include "page/bitmap_page.h"
 #include "storage/disk_manager.h"
 
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+DiskManager::DiskManager(const std::string &db_file, DurabilityPolicy durability, DiskIOMode io_mode)
+        : file_name_(db_file), durability_(durability), io_mode_(io_mode) {
   std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw std::exception();
+  // the segments of the tablespaces, a database without the file has none
+  if (int segment_fd = open(SegmentFileName().c_str(), O_RDONLY); segment_fd >= 0) {
+    ssize_t n = pread(segment_fd, segments_, sizeof(segments_), 0);
+    close(segment_fd);
+    if (n != static_cast<ssize_t>(sizeof(segments_))) {
+      LOG(ERROR) << "Can not open " << db_file << ": " << SegmentFileName() << " is truncated";
+      throw std::runtime_error("can not open " + db_file + ": " + SegmentFileName() + " is truncated");
+    }
+    for (uint32_t segment = 0; segment < TABLESPACE_SEGMENTS; segment++) {
+      if (segments_[segment].tablespace_id_ != 0) {
+        std::vector<uint32_t> &owned = tablespace_segments_[segments_[segment].tablespace_id_];
+        owned.resize(std::max<size_t>(owned.size(), segments_[segment].index_ + 1));
+        owned[segments_[segment].index_] = segment;
+      }
+    }
+  }
+  // create the file if it does not exist
+  db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  if (db_fd_ < 0) {
+    LOG(ERROR) << "Can not open " << db_file << ": " << strerror(errno);
+    throw std::exception();
+  }
+  file_size_ = GetFileSize(file_name_);
+  if (io_mode_ == DiskIOMode::DIRECT && !EnableDirectIO()) {
+    io_mode_ = DiskIOMode::PREAD;
+  }
+  if (io_mode_ == DiskIOMode::MMAP) {
+    // only the address space is reserved, pages past the end of the file are never touched
+    void *map = mmap(nullptr, DISK_MMAP_RESERVE, PROT_READ, MAP_SHARED | MAP_NORESERVE, db_fd_, 0);
+    if (map == MAP_FAILED) {
+      LOG(WARNING) << "Can not map " << db_file << ", reading it with pread: " << strerror(errno);
+      io_mode_ = DiskIOMode::PREAD;
+    } else {
+      map_ = static_cast<char *>(map);
     }
   }
+  auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  if (file_size_ <= 0) {
+    // new file, record the page size it is written with
+    memset(meta_data_, 0, PAGE_SIZE);
+    meta_page->Init();
+    WritePhysicalPage(META_PAGE_ID, meta_data_);
+    return;
+  }
   ReadPhysicalPage(META_PAGE_ID, meta_data_);
+  // the first two fields do not depend on the page size, a file of another build is refused before anything else
+  if (meta_page->GetMagicNum() != DISK_FILE_MAGIC_NUM || meta_page->GetPageSize() != PAGE_SIZE) {
+    if (map_ != nullptr) {
+      munmap(map_, DISK_MMAP_RESERVE);
+      map_ = nullptr;
+    }
+    close(db_fd_);
+    db_fd_ = -1;
+    closed = true;
+    std::string reason = meta_page->GetMagicNum() != DISK_FILE_MAGIC_NUM
+                         ? "it is not a database file"
+                         : "it was created with page size " + std::to_string(meta_page->GetPageSize()) +
+                           ", this build uses " + std::to_string(PAGE_SIZE);
+    LOG(ERROR) << "Can not open " << db_file << ": " << reason;
+    throw std::runtime_error("can not open " + db_file + ": " + reason);
+  }
+  for (page_id_t page_id = meta_page->GetNextMetaPageId(); page_id != 0;) {
+    auto page = std::make_unique<char[]>(PAGE_SIZE);
+    ReadPhysicalPage(MapPageId(page_id), page.get());
+    meta_overflow_page_ids_.push_back(page_id);
+    page_id = reinterpret_cast<DiskFileMetaOverflowPage *>(page.get())->GetNextMetaPageId();
+    meta_overflow_pages_.push_back(std::move(page));
+  }
 }
 
 void DiskManager::Close() {
+  for (auto &tablespace : OpenTablespaces()) {
+    tablespace->Close();
+  }
+  {
+    std::scoped_lock<std::shared_mutex> lock(tablespace_latch_);
+    tablespaces_.clear();
+  }
   std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   if (!closed) {
-    db_io_.close();
-    closed = true;
+    {
+      // start what is queued and wait for everything in flight
+      std::scoped_lock<std::mutex> async_lock(async_latch_);
+      if (!async_queued_.empty()) {
+        if (async_io_ == nullptr) {
+          async_io_ = AsyncIO::Create(db_fd_);
+        }
+        async_io_->Submit(async_queued_);
+        async_queued_.clear();
+      }
+      async_io_.reset();
+      // page I/O from now on is dropped
+      closed = true;
+    }
+    // pages reserved and never used are free again in the file
+    for (auto &[owner, run] : page_runs_) {
+      for (; run.remaining_ > 0; run.remaining_--) {
+        DeAllocatePage(run.next_page_id_++);
+      }
+    }
+    page_runs_.clear();
+    FlushBitmaps();
+    WriteMetaPages();
+    if (durability_ != DurabilityPolicy::NONE) {
+      Sync();
+    }
+    if (map_ != nullptr) {
+      munmap(map_, DISK_MMAP_RESERVE);
+      map_ = nullptr;
+    }
+    close(db_fd_);
+    db_fd_ = -1;
   }
 }
 
 void DiskManager::ReadPage(page_id_t logical_page_id, char *page_data) {
+  // data pages are never touched by the meta page or bitmap code, no latch needed
   ASSERT(logical_page_id >= 0, "Invalid page id.");
+  if (IsTablespacePage(logical_page_id)) {
+    page_id_t local_page_id;
+    auto tablespace = GetTablespaceOf(logical_page_id, &local_page_id);
+    if (tablespace == nullptr) {
+      memset(page_data, 0, PAGE_SIZE);
+      return;
+    }
+    tablespace->ReadPage(local_page_id, page_data);
+    return;
+  }
+  if (closed) {
+    memset(page_data, 0, PAGE_SIZE);
+    return;
+  }
   ReadPhysicalPage(MapPageId(logical_page_id), page_data);
 }
 
 void DiskManager::WritePage(page_id_t logical_page_id, const char *page_data) {
   ASSERT(logical_page_id >= 0, "Invalid page id.");
+  if (IsTablespacePage(logical_page_id)) {
+    // the file is gone if its object was dropped
+    page_id_t local_page_id;
+    if (auto tablespace = GetTablespaceOf(logical_page_id, &local_page_id)) {
+      tablespace->WritePage(local_page_id, page_data);
+    }
+    return;
+  }
+  // a buffer pool deleted after Close flushes its pages into the void
+  if (closed) {
+    return;
+  }
   WritePhysicalPage(MapPageId(logical_page_id), page_data);
+  num_writes_++;
+  if (durability_ == DurabilityPolicy::SYNC_EVERY_WRITE) {
+    Sync();
+  }
+}
+
+void DiskManager::WritePages(std::vector<std::pair<page_id_t, const char *>> &pages) {
+  if (closed) {
+    return;
+  }
+  // MapPageId only skips the bitmap pages, page id order is file order. The pages of the tablespaces sort after the
+  // ones of the database file, by segment, and go to their files as batches of their own.
+  std::sort(pages.begin(), pages.end());
+  auto tablespace_pages = std::find_if(pages.begin(), pages.end(),
+                                       [](const auto &page) { return IsTablespacePage(page.first); });
+  for (auto begin = tablespace_pages; begin != pages.end();) {
+    uint32_t segment = SegmentOf(begin->first);
+    auto end = std::find_if(begin, pages.end(),
+                            [segment](const auto &page) { return SegmentOf(page.first) != segment; });
+    page_id_t local_page_id;
+    if (auto tablespace = GetTablespaceOf(begin->first, &local_page_id)) {
+      // the pages of a segment are in the same order in the file
+      page_id_t segment_start = local_page_id - SegmentOffset(begin->first);
+      std::vector<std::pair<page_id_t, const char *>> batch;
+      for (auto page = begin; page != end; page++) {
+        batch.emplace_back(segment_start + SegmentOffset(page->first), page->second);
+      }
+      tablespace->WritePages(batch);
+    }
+    begin = end;
+  }
+  size_t num_pages = tablespace_pages - pages.begin();
+  std::vector<struct iovec> iov;
+  for (size_t i = 0; i < num_pages;) {
+    ASSERT(pages[i].first >= 0, "Invalid page id.");
+    page_id_t physical_page_id = MapPageId(pages[i].first);
+    if (NeedsBounce(pages[i].second)) {
+      WritePhysicalPage(physical_page_id, pages[i].second);
+      i++;
+      continue;
+    }
+    iov.clear();
+    do {
+      iov.push_back({const_cast<char *>(pages[i + iov.size()].second), PAGE_SIZE});
+    } while (i + iov.size() < num_pages && iov.size() < IOV_MAX &&
+             MapPageId(pages[i + iov.size()].first) == physical_page_id + static_cast<page_id_t>(iov.size()) &&
+             !NeedsBounce(pages[i + iov.size()].second));
+    WritePhysicalPages(physical_page_id, iov.data(), iov.size());
+    i += iov.size();
+  }
+  num_writes_ += num_pages;
+  if (durability_ == DurabilityPolicy::SYNC_EVERY_WRITE && num_pages > 0) {
+    Sync();
+  }
+}
+
+void DiskManager::ReadPageAsync(page_id_t logical_page_id, char *page_data, IOCallback callback) {
+  ASSERT(logical_page_id >= 0, "Invalid page id.");
+  if (IsTablespacePage(logical_page_id)) {
+    page_id_t local_page_id;
+    auto tablespace = GetTablespaceOf(logical_page_id, &local_page_id);
+    if (tablespace == nullptr) {
+      memset(page_data, 0, PAGE_SIZE);
+      callback(true);
+      return;
+    }
+    tablespace->ReadPageAsync(local_page_id, page_data, std::move(callback));
+    return;
+  }
+  if (NeedsBounce(page_data)) {
+    // read into aligned memory of its own, copied out once done
+    std::shared_ptr<char[]> bounce = AllocatePageBuffer(1);
+    ReadPageAsync(logical_page_id, bounce.get(), [bounce, page_data, callback = std::move(callback)](bool ok) {
+      if (ok) {
+        memcpy(page_data, bounce.get(), PAGE_SIZE);
+      }
+      callback(ok);
+    });
+    return;
+  }
+  page_id_t physical_page_id = MapPageId(logical_page_id);
+  int64_t offset = static_cast<int64_t>(physical_page_id) * PAGE_SIZE;
+  if (closed || offset >= file_size_) {
+    memset(page_data, 0, PAGE_SIZE);
+    callback(!closed);
+    return;
+  }
+  if (map_ != nullptr) {
+    // a copy out of the mapping gains nothing from an I/O thread
+    ReadPhysicalPage(physical_page_id, page_data);
+    callback(true);
+    return;
+  }
+  auto done = [this, physical_page_id, page_data, callback = std::move(callback)](ssize_t result) {
+    if (result < 0) {
+      LOG(ERROR) << "I/O error while reading: " << strerror(static_cast<int>(-result));
+      callback(false);
+      return;
+    }
+    if (result < PAGE_SIZE) {
+      // the page starts before the end of the file, so this is a partial read: finish the page synchronously
+      ReadPhysicalPage(physical_page_id, page_data);
+    }
+    callback(true);
+  };
+  std::scoped_lock<std::mutex> lock(async_latch_);
+  async_queued_.push_back({false, offset, page_data, PAGE_SIZE, std::move(done)});
+}
+
+void DiskManager::WritePageAsync(page_id_t logical_page_id, const char *page_data, IOCallback callback) {
+  ASSERT(logical_page_id >= 0, "Invalid page id.");
+  if (IsTablespacePage(logical_page_id)) {
+    page_id_t local_page_id;
+    auto tablespace = GetTablespaceOf(logical_page_id, &local_page_id);
+    if (tablespace == nullptr) {
+      callback(true);
+      return;
+    }
+    tablespace->WritePageAsync(local_page_id, page_data, std::move(callback));
+    return;
+  }
+  if (NeedsBounce(page_data)) {
+    std::shared_ptr<char[]> bounce = AllocatePageBuffer(1);
+    memcpy(bounce.get(), page_data, PAGE_SIZE);
+    WritePageAsync(logical_page_id, bounce.get(), [bounce, callback = std::move(callback)](bool ok) { callback(ok); });
+    return;
+  }
+  if (closed) {
+    callback(false);
+    return;
+  }
+  page_id_t physical_page_id = MapPageId(logical_page_id);
+  int64_t offset = static_cast<int64_t>(physical_page_id) * PAGE_SIZE;
+  auto done = [this, physical_page_id, offset, page_data, callback = std::move(callback)](ssize_t result) {
+    if (result < 0) {
+      LOG(ERROR) << "I/O error while writing: " << strerror(static_cast<int>(-result));
+      callback(false);
+      return;
+    }
+    if (result < PAGE_SIZE) {
+      // rare, finish the page synchronously
+      WritePhysicalPage(physical_page_id, page_data);
+    } else {
+      GrowFileSize(offset + PAGE_SIZE);
+    }
+    num_writes_++;
+    if (durability_ == DurabilityPolicy::SYNC_EVERY_WRITE) {
+      Sync();
+    }
+    callback(true);
+  };
+  std::scoped_lock<std::mutex> lock(async_latch_);
+  async_queued_.push_back({true, offset, const_cast<char *>(page_data), PAGE_SIZE, std::move(done)});
+}
+
+size_t DiskManager::SubmitBatch() {
+  // every file has its own queue
+  size_t submitted = 0;
+  for (auto &tablespace : OpenTablespaces()) {
+    submitted += tablespace->SubmitBatch();
+  }
+  std::scoped_lock<std::mutex> lock(async_latch_);
+  // Close submitted everything queued before it
+  if (async_queued_.empty() || closed) {
+    return submitted;
+  }
+  if (async_io_ == nullptr) {
+    async_io_ = AsyncIO::Create(db_fd_);
+  }
+  submitted += async_queued_.size();
+  async_io_->Submit(async_queued_);
+  async_queued_.clear();
+  return submitted;
+}
+
+void DiskManager::ConfigureAsyncIO(size_t queue_depth, bool use_io_uring) {
+  for (auto &tablespace : OpenTablespaces()) {
+    tablespace->ConfigureAsyncIO(queue_depth, use_io_uring);
+  }
+  std::scoped_lock<std::mutex> lock(async_latch_);
+  if (closed) {
+    return;
+  }
+  // the old backend waits for its I/O in flight
+  async_io_.reset();
+  async_io_ = AsyncIO::Create(db_fd_, queue_depth, use_io_uring);
+}
+
+AsyncIO::Backend DiskManager::GetAsyncIOBackend() {
+  std::scoped_lock<std::mutex> lock(async_latch_);
+  if (async_io_ == nullptr) {
+    async_io_ = AsyncIO::Create(db_fd_);
+  }
+  return async_io_->GetBackend();
+}
+
+void DiskManager::Checkpoint() {
+  for (auto &tablespace : OpenTablespaces()) {
+    tablespace->Checkpoint();
+  }
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  if (closed) {
+    return;
+  }
+  FlushBitmaps();
+  WriteMetaPages();
+  if (durability_ != DurabilityPolicy::NONE) {
+    Sync();
+  }
 }
 
 page_id_t DiskManager::AllocatePage() {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   //元数据页
-  DiskFileMetaPage* meta_page_information = reinterpret_cast<DiskFileMetaPage*>(this->meta_data_); 
-  page_id_t result_logic_page = 0;    //返回的page逻辑页号
+  DiskFileMetaPage* meta_page_information = reinterpret_cast<DiskFileMetaPage*>(this->meta_data_);
+  // the extents below the hint are full, the first extent with a free page is taken as before
+  while (first_free_extent_ < meta_page_information->GetExtentNums() &&
+         ExtentUsedPages(first_free_extent_) >= BITMAP_SIZE) {
+    first_free_extent_++;
+  }
+  uint32_t extent_id = first_free_extent_;
+  //如果前面已用的分区没有空页，开一个新的页。
+  if (extent_id == meta_page_information->GetExtentNums() && !AddExtent(&extent_id)) {
+    return INVALID_PAGE_ID;
+  }
   uint32_t temp_offest_in_exetent = 0;
-  char bit_map[PAGE_SIZE];
-  int is_find = 0;
-  
-  for(uint32_t i = 0;i<meta_page_information->GetExtentNums();i++)
+  GetBitmap(extent_id)->AllocatePage(temp_offest_in_exetent);
+  bitmap_dirty_[extent_id] = true;
+  //该分区所用page数++
+  ExtentUsedPages(extent_id)++;
+  //所用的总page数++
+  meta_page_information->num_allocated_pages_++;
+  return extent_id * BITMAP_SIZE + temp_offest_in_exetent;
+}
+
+page_id_t DiskManager::AllocatePage(const void *owner) {
+  if (uint32_t tablespace_id = GetTablespaceId(owner); tablespace_id != 0) {
+    // the run of owner is kept by the disk manager of its file
+    auto tablespace = GetTablespace(tablespace_id, true);
+    page_id_t local_page_id = tablespace == nullptr ? INVALID_PAGE_ID : tablespace->AllocatePage(owner);
+    if (local_page_id == INVALID_PAGE_ID) {
+      return INVALID_PAGE_ID;
+    }
+    page_id_t page_id = TablespacePageId(tablespace_id, local_page_id);
+    if (page_id == INVALID_PAGE_ID) {
+      tablespace->DeAllocatePage(local_page_id);
+    }
+    return page_id;
+  }
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  PageRun &run = page_runs_[owner];
+  if (run.remaining_ == 0) {
+    // a small table keeps a small run, a growing one gets longer runs
+    run.size_ = run.size_ == 0 ? page_run_min_size_ : std::min(run.size_ * 2, page_run_max_size_);
+    // next_page_id_ is right behind the previous run
+    page_id_t first_page_id = AllocateRun(run.size_, run.next_page_id_);
+    if (first_page_id == INVALID_PAGE_ID) {
+      return INVALID_PAGE_ID;
+    }
+    run.next_page_id_ = first_page_id;
+    run.remaining_ = run.size_;
+  }
+  run.remaining_--;
+  return run.next_page_id_++;
+}
+
+page_id_t DiskManager::AllocateRun(uint32_t count, page_id_t near) {
+  if (count == 0 || count > BITMAP_SIZE) {
+    return INVALID_PAGE_ID;
+  }
+  if (IsTablespacePage(near)) {
+    uint32_t tablespace_id = TablespaceOf(near);
+    page_id_t local_page_id;
+    auto tablespace = GetTablespaceOf(near, &local_page_id);
+    page_id_t first_page_id = tablespace == nullptr ? INVALID_PAGE_ID : tablespace->AllocateRun(count, local_page_id);
+    if (first_page_id == INVALID_PAGE_ID) {
+      return INVALID_PAGE_ID;
+    }
+    page_id_t page_id = TablespacePageId(tablespace_id, first_page_id);
+    for (uint32_t i = 0; page_id == INVALID_PAGE_ID && i < count; i++) {
+      tablespace->DeAllocatePage(first_page_id + i);
+    }
+    return page_id;
+  }
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  uint32_t extent_id = 0;
+  uint32_t page_offset = 0;
+  bool found = false;
+  if (near != INVALID_PAGE_ID && static_cast<uint32_t>(near) / BITMAP_SIZE < meta_page->GetExtentNums()) {
+    extent_id = near / BITMAP_SIZE;
+    page_offset = near % BITMAP_SIZE;
+    found = ExtentUsedPages(extent_id) + count <= BITMAP_SIZE &&
+            GetBitmap(extent_id)->AllocateRun(count, page_offset);
+  }
+  // first fit over the extents with enough free pages, which may still be too fragmented
+  for (uint32_t i = first_free_extent_; !found && i < meta_page->GetExtentNums(); i++) {
+    if (ExtentUsedPages(i) + count > BITMAP_SIZE) {
+      continue;
+    }
+    extent_id = i;
+    page_offset = 0;
+    found = GetBitmap(i)->AllocateRun(count, page_offset);
+  }
+  while (!found) {
+    if (!AddExtent(&extent_id)) {
+      return INVALID_PAGE_ID;
+    }
+    // an overflow meta page may have taken the first page of the new extent
+    page_offset = 0;
+    found = GetBitmap(extent_id)->AllocateRun(count, page_offset);
+  }
+  bitmap_dirty_[extent_id] = true;
+  ExtentUsedPages(extent_id) += count;
+  meta_page->num_allocated_pages_ += count;
+  page_id_t first_page_id = extent_id * BITMAP_SIZE + page_offset;
+  Preallocate(first_page_id, count);
+  return first_page_id;
+}
+
+void DiskManager::ReleasePages(const void *owner) {
+  if (uint32_t tablespace_id = GetTablespaceId(owner); tablespace_id != 0) {
+    if (auto tablespace = GetTablespace(tablespace_id, false)) {
+      tablespace->ReleasePages(owner);
+    }
+    return;
+  }
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  auto iter = page_runs_.find(owner);
+  if (iter == page_runs_.end()) {
+    return;
+  }
+  for (PageRun &run = iter->second; run.remaining_ > 0; run.remaining_--) {
+    DeAllocatePage(run.next_page_id_++);
+  }
+  page_runs_.erase(iter);
+}
+
+void DiskManager::ConfigurePageRuns(uint32_t min_size, uint32_t max_size) {
+  for (auto &tablespace : OpenTablespaces()) {
+    tablespace->ConfigurePageRuns(min_size, max_size);
+  }
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  page_run_min_size_ = std::clamp<uint32_t>(min_size, 1, BITMAP_SIZE);
+  page_run_max_size_ = std::clamp<uint32_t>(max_size, page_run_min_size_, BITMAP_SIZE);
+}
+
+size_t DiskManager::TruncateFreeExtents() {
+  size_t truncated = 0;
+  for (auto &tablespace : OpenTablespaces()) {
+    truncated += tablespace->TruncateFreeExtents();
+  }
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  if (closed) {
+    return truncated;
+  }
+  auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  uint32_t num_extents = meta_page->GetExtentNums();
+  while (num_extents > 0 && ExtentUsedPages(num_extents - 1) == 0) {
+    num_extents--;
+  }
+  if (num_extents != meta_page->GetExtentNums()) {
+    // an extent added again later reads its bitmap past the end of the file, all free
+    meta_page->num_extents_ = num_extents;
+    bitmaps_.resize(std::min<size_t>(bitmaps_.size(), num_extents));
+    bitmap_dirty_.resize(bitmaps_.size());
+    first_free_extent_ = std::min(first_free_extent_, num_extents);
+    FlushBitmaps();
+    WriteMetaPages();
+  }
+  // the file ends with the last allocated page, pages allocated again later are read past the end as zeros
+  int64_t size = static_cast<int64_t>(BitmapPhysicalPageId(num_extents)) * PAGE_SIZE;
+  if (num_extents > 0) {
+    BitmapPage<PAGE_SIZE> *bitmap = GetBitmap(num_extents - 1);
+    uint32_t used_end = BITMAP_SIZE;
+    while (used_end > 0 && bitmap->IsPageFree(used_end - 1)) {
+      used_end--;
+    }
+    size = (static_cast<int64_t>(BitmapPhysicalPageId(num_extents - 1)) + 1 + used_end) * PAGE_SIZE;
+  }
+  int64_t file_size = file_size_;
+  if (file_size <= size) {
+    return truncated;
+  }
+  // readers check the size first, nobody reads the pages cut off
+  file_size_ = size;
+  if (ftruncate(db_fd_, size) != 0) {
+    LOG(WARNING) << "Can not truncate " << file_name_ << ": " << strerror(errno);
+  }
+  return truncated + (file_size - size) / PAGE_SIZE;
+}
+
+void DiskManager::CreateTablespace(const void *owner, uint32_t tablespace_id) {
+  if (!file_per_object_) {
+    return;
+  }
+  if (tablespace_id == 0) {
+    LOG(WARNING) << "No tablespace id left, the pages of a new object go to " << file_name_;
+    return;
+  }
+  // an empty index reopened finds its file again
+  GetTablespace(tablespace_id, true);
+  std::scoped_lock<std::shared_mutex> lock(tablespace_latch_);
+  tablespace_owners_[owner] = tablespace_id;
+}
+
+void DiskManager::OpenTablespace(const void *owner, page_id_t page_id) {
+  if (!IsTablespacePage(page_id)) {
+    return;
+  }
+  uint32_t tablespace_id = TablespaceOf(page_id);
+  if (tablespace_id == 0) {
+    LOG(ERROR) << "Page " << page_id << " is in no tablespace of " << SegmentFileName();
+    return;
+  }
+  std::scoped_lock<std::shared_mutex> lock(tablespace_latch_);
+  tablespace_owners_[owner] = tablespace_id;
+}
+
+uint32_t DiskManager::GetTablespaceId(const void *owner) {
+  std::shared_lock<std::shared_mutex> lock(tablespace_latch_);
+  auto iter = tablespace_owners_.find(owner);
+  return iter == tablespace_owners_.end() ? 0 : iter->second;
+}
+
+void DiskManager::DropTablespace(uint32_t tablespace_id) {
+  std::shared_ptr<DiskManager> tablespace;
   {
-    if(meta_page_information->GetExtentUsedPage(i)<BITMAP_SIZE)
-    {
-      //算物理页号（位图页）
-      uint32_t bit_map_physical_page = i*(this->BITMAP_SIZE + 1) + 1;
-      //读到自己定义的字符串里，强制类型转换成bitmap，调用其函数
-      this->ReadPhysicalPage(bit_map_physical_page,bit_map);
-      BitmapPage<PAGE_SIZE>* Bitmap_Page_information = reinterpret_cast<BitmapPage<PAGE_SIZE>*>(bit_map); 
-      Bitmap_Page_information->AllocatePage(temp_offest_in_exetent);
-      result_logic_page = i*this->BITMAP_SIZE + temp_offest_in_exetent;
-      //该分区所用page数++
-      meta_page_information->extent_used_page_[i]++;
-      //所用的总page数++
-      meta_page_information->num_allocated_pages_++;
-      is_find = 1;
-      this->WritePhysicalPage(bit_map_physical_page,bit_map);
-      break;
+    std::scoped_lock<std::shared_mutex> lock(tablespace_latch_);
+    for (auto iter = tablespace_owners_.begin(); iter != tablespace_owners_.end();) {
+      iter = iter->second == tablespace_id ? tablespace_owners_.erase(iter) : std::next(iter);
+    }
+    auto iter = tablespaces_.find(tablespace_id);
+    if (iter != tablespaces_.end()) {
+      tablespace = std::move(iter->second);
+      tablespaces_.erase(iter);
+    }
+    // the page ids of its segments go to the next tablespace growing
+    auto segments = tablespace_segments_.find(tablespace_id);
+    if (segments != tablespace_segments_.end()) {
+      for (uint32_t segment : segments->second) {
+        segments_[segment] = Segment();
+      }
+      tablespace_segments_.erase(segments);
+      WriteSegments();
+    }
+  }
+  if (unlink(TablespaceFileName(tablespace_id).c_str()) != 0 && errno != ENOENT) {
+    LOG(WARNING) << "Can not remove " << TablespaceFileName(tablespace_id) << ": " << strerror(errno);
+  }
+  if (tablespace != nullptr) {
+    // nothing left to make durable, I/O still holding it is dropped
+    tablespace->durability_ = DurabilityPolicy::NONE;
+    tablespace->Close();
+  }
+}
+
+std::shared_ptr<DiskManager> DiskManager::GetTablespace(uint32_t tablespace_id, bool create) {
+  {
+    // the file is open already for every page I/O of the tablespace but the first
+    std::shared_lock<std::shared_mutex> lock(tablespace_latch_);
+    auto iter = tablespaces_.find(tablespace_id);
+    if (iter != tablespaces_.end()) {
+      return iter->second;
+    }
+  }
+  std::scoped_lock<std::shared_mutex> lock(tablespace_latch_);
+  // another thread may have opened it meanwhile
+  auto iter = tablespaces_.find(tablespace_id);
+  if (iter != tablespaces_.end()) {
+    return iter->second;
+  }
+  std::string file_name = TablespaceFileName(tablespace_id);
+  if (closed || (!create && GetFileSize(file_name) < 0)) {
+    return nullptr;
+  }
+  auto tablespace = std::make_shared<DiskManager>(file_name, durability_, io_mode_);
+  // the file may grow into every segment
+  tablespace->max_page_id_ = static_cast<page_id_t>(
+          std::min<int64_t>(MAX_VALID_PAGE_ID, static_cast<int64_t>(TABLESPACE_SEGMENTS) * SEGMENT_PAGES - 1));
+  tablespace->ConfigurePageRuns(page_run_min_size_, page_run_max_size_);
+  tablespaces_[tablespace_id] = tablespace;
+  return tablespace;
+}
+
+uint32_t DiskManager::TablespaceOf(page_id_t page_id) {
+  if (!IsTablespacePage(page_id)) {
+    return 0;
+  }
+  std::shared_lock<std::shared_mutex> lock(tablespace_latch_);
+  return segments_[SegmentOf(page_id)].tablespace_id_;
+}
+
+std::shared_ptr<DiskManager> DiskManager::GetTablespaceOf(page_id_t page_id, page_id_t *local_page_id) {
+  uint32_t tablespace_id;
+  {
+    std::shared_lock<std::shared_mutex> lock(tablespace_latch_);
+    const Segment &segment = segments_[SegmentOf(page_id)];
+    if (segment.tablespace_id_ == 0) {
+      return nullptr;
+    }
+    tablespace_id = segment.tablespace_id_;
+    *local_page_id = static_cast<page_id_t>(segment.index_) * SEGMENT_PAGES + SegmentOffset(page_id);
+    auto iter = tablespaces_.find(tablespace_id);
+    if (iter != tablespaces_.end()) {
+      return iter->second;
     }
   }
-   //如果前面已用的分区没有空页，开一个新的页。
-  if(is_find==0)
+  return GetTablespace(tablespace_id, false);
+}
+
+page_id_t DiskManager::TablespacePageId(uint32_t tablespace_id, page_id_t local_page_id) {
+  uint32_t index = local_page_id / SEGMENT_PAGES;
+  page_id_t offset = local_page_id % SEGMENT_PAGES;
   {
-    uint32_t bit_map_physical_page = meta_page_information->num_extents_*(this->BITMAP_SIZE + 1) + 1;
-    this->ReadPhysicalPage(bit_map_physical_page,bit_map);
-    BitmapPage<PAGE_SIZE>* Bitmap_Page_information = reinterpret_cast<BitmapPage<PAGE_SIZE>*>(bit_map); 
-    Bitmap_Page_information->AllocatePage(temp_offest_in_exetent);
-    result_logic_page = meta_page_information->num_extents_*this->BITMAP_SIZE + temp_offest_in_exetent;
-    
-    //该分区所用page数++
-    meta_page_information->extent_used_page_[meta_page_information->num_extents_]++;
-    //所用的总page数++
-    meta_page_information->num_allocated_pages_++;
-    //分区数++
-    meta_page_information->num_extents_ ++;
-    this->WritePhysicalPage(bit_map_physical_page,bit_map);
-  }
-  return result_logic_page;
+    std::shared_lock<std::shared_mutex> lock(tablespace_latch_);
+    auto iter = tablespace_segments_.find(tablespace_id);
+    if (iter != tablespace_segments_.end() && index < iter->second.size()) {
+      return TABLESPACE_PAGE_FLAG | static_cast<page_id_t>(iter->second[index] << TABLESPACE_PAGE_BITS) | offset;
+    }
+  }
+  // the file grew past its last segment, it gets the first free ones
+  std::scoped_lock<std::shared_mutex> lock(tablespace_latch_);
+  std::vector<uint32_t> &owned = tablespace_segments_[tablespace_id];
+  size_t num_owned = owned.size();
+  uint32_t segment = 0;
+  while (owned.size() <= index) {
+    while (segment < TABLESPACE_SEGMENTS && segments_[segment].tablespace_id_ != 0) {
+      segment++;
+    }
+    if (segment == TABLESPACE_SEGMENTS) {
+      break;
+    }
+    segments_[segment] = {tablespace_id, static_cast<uint32_t>(owned.size())};
+    owned.push_back(segment);
+  }
+  if (owned.size() != num_owned) {
+    WriteSegments();
+  }
+  if (owned.size() <= index) {
+    LOG(ERROR) << "Can not grow tablespace " << tablespace_id << " of " << file_name_ << ", all "
+               << TABLESPACE_SEGMENTS << " segments are taken";
+    return INVALID_PAGE_ID;
+  }
+  return TABLESPACE_PAGE_FLAG | static_cast<page_id_t>(owned[index] << TABLESPACE_PAGE_BITS) | offset;
+}
+
+void DiskManager::WriteSegments() {
+  // written aside and renamed over the old map, a crash leaves one or the other
+  std::string temp_file_name = SegmentFileName() + ".tmp";
+  int fd = open(temp_file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  bool written = fd >= 0 && pwrite(fd, segments_, sizeof(segments_), 0) == static_cast<ssize_t>(sizeof(segments_)) &&
+                 (durability_ == DurabilityPolicy::NONE || fdatasync(fd) == 0);
+  if (fd >= 0) {
+    close(fd);
+  }
+  if (!written || rename(temp_file_name.c_str(), SegmentFileName().c_str()) != 0) {
+    LOG(ERROR) << "Can not write " << SegmentFileName() << ": " << strerror(errno);
+  }
+}
+
+std::vector<std::shared_ptr<DiskManager>> DiskManager::OpenTablespaces() {
+  std::shared_lock<std::shared_mutex> lock(tablespace_latch_);
+  std::vector<std::shared_ptr<DiskManager>> tablespaces;
+  for (auto &[tablespace_id, tablespace] : tablespaces_) {
+    tablespaces.push_back(tablespace);
+  }
+  return tablespaces;
+}
+
+void DiskManager::RemoveFiles(const std::string &db_file) {
+  remove(db_file.c_str());
+  remove((db_file + ".segments").c_str());
+  // the tablespace files are the files next to it named db_file.n, collected first as removing them while the
+  // directory is read may skip some
+  size_t slash = db_file.rfind('/');
+  std::string dir = slash == std::string::npos ? "" : db_file.substr(0, slash + 1);
+  std::string prefix = db_file.substr(dir.size()) + ".";
+  DIR *dir_stream = opendir(dir.empty() ? "." : dir.c_str());
+  if (dir_stream == nullptr) {
+    return;
+  }
+  std::vector<std::string> tablespace_files;
+  while (struct dirent *entry = readdir(dir_stream)) {
+    std::string name = entry->d_name;
+    if (name.size() > prefix.size() && name.compare(0, prefix.size(), prefix) == 0 &&
+        std::all_of(name.begin() + prefix.size(), name.end(), [](unsigned char c) { return isdigit(c); })) {
+      tablespace_files.push_back(dir + name);
+    }
+  }
+  closedir(dir_stream);
+  for (auto &file : tablespace_files) {
+    remove(file.c_str());
+  }
 }
 
 void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
+  if (IsTablespacePage(logical_page_id)) {
+    page_id_t local_page_id;
+    if (auto tablespace = GetTablespaceOf(logical_page_id, &local_page_id)) {
+      tablespace->DeAllocatePage(local_page_id);
+    }
+    return;
+  }
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   //元数据页
-  DiskFileMetaPage* meta_page_information = reinterpret_cast<DiskFileMetaPage*>(this->meta_data_); 
+  DiskFileMetaPage* meta_page_information = reinterpret_cast<DiskFileMetaPage*>(this->meta_data_);
   uint32_t temp_offest_in_exetent = logical_page_id % BITMAP_SIZE;
   uint32_t temp_exetent = logical_page_id / BITMAP_SIZE;
-
-  char bit_map[PAGE_SIZE];
-  //算物理页号（位图页）
-  uint32_t bit_map_physical_page = temp_exetent*(this->BITMAP_SIZE + 1) + 1;
-  //读到自己定义的字符串里，强制类型转换成bitmap，调用其函数
-  this->ReadPhysicalPage(bit_map_physical_page,bit_map);
-  BitmapPage<PAGE_SIZE>* Bitmap_Page_information = reinterpret_cast<BitmapPage<PAGE_SIZE>*>(bit_map); 
-  Bitmap_Page_information->DeAllocatePage(temp_offest_in_exetent);
+  if (temp_exetent >= meta_page_information->GetExtentNums() ||
+      !GetBitmap(temp_exetent)->DeAllocatePage(temp_offest_in_exetent)) {
+    // the page was free already
+    return;
+  }
+  bitmap_dirty_[temp_exetent] = true;
   //所用的总page数--
   meta_page_information->num_allocated_pages_--;
   //该分区所用page数--
-  meta_page_information->extent_used_page_[temp_exetent]--;
-  this->WritePhysicalPage(bit_map_physical_page,bit_map);
+  ExtentUsedPages(temp_exetent)--;
+  if (temp_exetent < first_free_extent_) {
+    first_free_extent_ = temp_exetent;
+  }
 }
 
 bool DiskManager::IsPageFree(page_id_t logical_page_id) {
-  //元数据页
-  // DiskFileMetaPage* meta_page_information = reinterpret_cast<DiskFileMetaPage*>(this->meta_data_); 
+  if (IsTablespacePage(logical_page_id)) {
+    page_id_t local_page_id;
+    auto tablespace = GetTablespaceOf(logical_page_id, &local_page_id);
+    return tablespace == nullptr || tablespace->IsPageFree(local_page_id);
+  }
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  DiskFileMetaPage* meta_page_information = reinterpret_cast<DiskFileMetaPage*>(this->meta_data_);
   uint32_t temp_offest_in_exetent = logical_page_id % BITMAP_SIZE;
   uint32_t temp_exetent = logical_page_id / BITMAP_SIZE;
+  if (temp_exetent >= meta_page_information->GetExtentNums()) {
+    return true;
+  }
+  return GetBitmap(temp_exetent)->IsPageFree(temp_offest_in_exetent);
+}
+
+uint32_t &DiskManager::ExtentUsedPages(uint32_t extent_id) {
+  if (extent_id < DiskFileMetaPage::EXTENTS_PER_META_PAGE) {
+    return reinterpret_cast<DiskFileMetaPage *>(meta_data_)->extent_used_page_[extent_id];
+  }
+  extent_id -= DiskFileMetaPage::EXTENTS_PER_META_PAGE;
+  auto *page = reinterpret_cast<DiskFileMetaOverflowPage *>(
+          meta_overflow_pages_[extent_id / DiskFileMetaOverflowPage::EXTENTS_PER_PAGE].get());
+  return page->extent_used_page_[extent_id % DiskFileMetaOverflowPage::EXTENTS_PER_PAGE];
+}
+
+bool DiskManager::AddExtent(uint32_t *extent_id) {
+  auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  int64_t num_pages = (static_cast<int64_t>(meta_page->GetExtentNums()) + 1) * static_cast<int64_t>(BITMAP_SIZE);
+  if (num_pages > max_page_id_ + 1LL) {
+    LOG(ERROR) << "Can not grow " << file_name_ << " past " << max_page_id_ + 1LL << " pages";
+    return false;
+  }
+  *extent_id = meta_page->num_extents_++;
+  ExtentUsedPages(*extent_id) = 0;
+  size_t counted_extents = DiskFileMetaPage::EXTENTS_PER_META_PAGE +
+                           meta_overflow_pages_.size() * DiskFileMetaOverflowPage::EXTENTS_PER_PAGE;
+  if (meta_page->GetExtentNums() < counted_extents) {
+    return true;
+  }
+  // the count of the new extent took the last slot, the counts of the next ones go to an overflow meta page taken
+  // from the new extent, which is still empty
+  uint32_t page_offset = 0;
+  GetBitmap(*extent_id)->AllocatePage(page_offset);
+  bitmap_dirty_[*extent_id] = true;
+  ExtentUsedPages(*extent_id)++;
+  meta_page->num_allocated_pages_++;
+  page_id_t page_id = *extent_id * BITMAP_SIZE + page_offset;
+  if (meta_overflow_pages_.empty()) {
+    meta_page->SetNextMetaPageId(page_id);
+  } else {
+    reinterpret_cast<DiskFileMetaOverflowPage *>(meta_overflow_pages_.back().get())->SetNextMetaPageId(page_id);
+  }
+  meta_overflow_page_ids_.push_back(page_id);
+  meta_overflow_pages_.push_back(std::make_unique<char[]>(PAGE_SIZE));
+  return true;
+}
 
-  char bit_map[PAGE_SIZE];
-  //算物理页号（位图页）
-  uint32_t bit_map_physical_page = temp_exetent*(this->BITMAP_SIZE + 1) + 1;
-  //读到自己定义的字符串里，强制类型转换成bitmap，调用其函数
-  this->ReadPhysicalPage(bit_map_physical_page,bit_map);
-  BitmapPage<PAGE_SIZE>* Bitmap_Page_information = reinterpret_cast<BitmapPage<PAGE_SIZE>*>(bit_map);
-  return Bitmap_Page_information->IsPageFree(temp_offest_in_exetent);
+void DiskManager::WriteMetaPages() {
+  WritePhysicalPage(META_PAGE_ID, meta_data_);
+  for (size_t i = 0; i < meta_overflow_pages_.size(); i++) {
+    WritePhysicalPage(MapPageId(meta_overflow_page_ids_[i]), meta_overflow_pages_[i].get());
+  }
+}
+
+BitmapPage<PAGE_SIZE> *DiskManager::GetBitmap(uint32_t extent_id) {
+  if (extent_id >= bitmaps_.size()) {
+    bitmaps_.resize(extent_id + 1);
+    bitmap_dirty_.resize(extent_id + 1, false);
+  }
+  if (bitmaps_[extent_id] == nullptr) {
+    //算物理页号（位图页）
+    bitmaps_[extent_id] = std::make_unique<char[]>(PAGE_SIZE);
+    ReadPhysicalPage(BitmapPhysicalPageId(extent_id), bitmaps_[extent_id].get());
+  }
+  return reinterpret_cast<BitmapPage<PAGE_SIZE> *>(bitmaps_[extent_id].get());
+}
+
+void DiskManager::FlushBitmaps() {
+  for (uint32_t extent_id = 0; extent_id < bitmaps_.size(); extent_id++) {
+    if (bitmap_dirty_[extent_id]) {
+      WritePhysicalPage(BitmapPhysicalPageId(extent_id), bitmaps_[extent_id].get());
+      bitmap_dirty_[extent_id] = false;
+    }
+  }
+}
+
+page_id_t DiskManager::BitmapPhysicalPageId(uint32_t extent_id) {
+  return extent_id * (BITMAP_SIZE + 1) + 1;
 }
 
 page_id_t DiskManager::MapPageId(page_id_t logical_page_id) {
@@ -130,45 +888,161 @@ page_id_t DiskManager::MapPageId(page_id_t logical_page_id) {
   return result;
 }
 
-int DiskManager::GetFileSize(const std::string &file_name) {
+void DiskManager::Preallocate(page_id_t logical_page_id, uint32_t count) {
+  if (closed) {
+    return;
+  }
+  // the file size stays, reads past the end still see zeros
+  int64_t offset = static_cast<int64_t>(MapPageId(logical_page_id)) * PAGE_SIZE;
+  if (fallocate(db_fd_, FALLOC_FL_KEEP_SIZE, offset, static_cast<int64_t>(count) * PAGE_SIZE) != 0 &&
+      errno != EOPNOTSUPP) {
+    LOG(WARNING) << "Can not preallocate " << count << " pages: " << strerror(errno);
+  }
+}
+
+int64_t DiskManager::GetFileSize(const std::string &file_name) {
   struct stat stat_buf;
   int rc = stat(file_name.c_str(), &stat_buf);
   return rc == 0 ? stat_buf.st_size : -1;
 }
 
+std::unique_ptr<char[], void (*)(void *)> DiskManager::AllocatePageBuffer(size_t num_pages) {
+  // aligned_alloc wants a multiple of the alignment
+  size_t size = (num_pages * PAGE_SIZE + DIRECT_IO_ALIGNMENT - 1) / DIRECT_IO_ALIGNMENT * DIRECT_IO_ALIGNMENT;
+  auto *data = static_cast<char *>(aligned_alloc(DIRECT_IO_ALIGNMENT, std::max<size_t>(size, DIRECT_IO_ALIGNMENT)));
+  ASSERT(data != nullptr, "Out of memory exception");
+  return {data, free};
+}
+
+bool DiskManager::EnableDirectIO() {
+  if (PAGE_SIZE % DIRECT_IO_ALIGNMENT != 0) {
+    LOG(WARNING) << "Pages of " << PAGE_SIZE << " bytes can not be read with O_DIRECT, reading " << file_name_
+                 << " with pread";
+    return false;
+  }
+  int flags = fcntl(db_fd_, F_GETFL);
+  if (flags < 0 || fcntl(db_fd_, F_SETFL, flags | O_DIRECT) != 0) {
+    LOG(WARNING) << "Can not open " << file_name_ << " with O_DIRECT, reading it with pread: " << strerror(errno);
+    return false;
+  }
+  // some file systems take the flag and refuse the I/O
+  auto buffer = AllocatePageBuffer(1);
+  if (pread(db_fd_, buffer.get(), PAGE_SIZE, 0) < 0) {
+    LOG(WARNING) << "Can not read " << file_name_ << " with O_DIRECT, reading it with pread: " << strerror(errno);
+    fcntl(db_fd_, F_SETFL, flags);
+    return false;
+  }
+  return true;
+}
+
+void DiskManager::Sync() {
+  if (fdatasync(db_fd_) != 0) {
+    LOG(ERROR) << "I/O error while syncing: " << strerror(errno);
+    return;
+  }
+  num_syncs_++;
+}
+
 void DiskManager::ReadPhysicalPage(page_id_t physical_page_id, char *page_data) {
-  int offset = physical_page_id * PAGE_SIZE;
+  int64_t offset = static_cast<int64_t>(physical_page_id) * PAGE_SIZE;
   // check if read beyond file length
-  if (offset >= GetFileSize(file_name_)) {
+  if (offset >= file_size_) {
 #ifdef ENABLE_BPM_DEBUG
     LOG(INFO) << "Read less than a page" << std::endl;
 #endif
     memset(page_data, 0, PAGE_SIZE);
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
+    return;
+  }
+  if (NeedsBounce(page_data)) {
+    // e.g. the meta page and the bitmap pages
+    thread_local auto bounce = AllocatePageBuffer(1);
+    ReadPhysicalPage(physical_page_id, bounce.get());
+    memcpy(page_data, bounce.get(), PAGE_SIZE);
+    return;
+  }
+  // a partial last page, or one past the reserved address space, is read as usual
+  if (map_ != nullptr && offset + PAGE_SIZE <= file_size_ &&
+      static_cast<uint64_t>(offset) + PAGE_SIZE <= DISK_MMAP_RESERVE) {
+    memcpy(page_data, map_ + offset, PAGE_SIZE);
+    return;
+  }
+  ssize_t read_count = 0;
+  while (read_count < PAGE_SIZE) {
+    ssize_t n = pread(db_fd_, page_data + read_count, PAGE_SIZE - read_count, offset + read_count);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      LOG(ERROR) << "I/O error while reading: " << strerror(errno);
+      break;
+    }
+    if (n == 0) {
+      break;
+    }
+    read_count += n;
+  }
+  // if file ends before reading PAGE_SIZE
+  if (read_count < PAGE_SIZE) {
 #ifdef ENABLE_BPM_DEBUG
-      LOG(INFO) << "Read less than a page" << std::endl;
+    LOG(INFO) << "Read less than a page" << std::endl;
 #endif
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
-    }
+    memset(page_data + read_count, 0, PAGE_SIZE - read_count);
   }
 }
 
 void DiskManager::WritePhysicalPage(page_id_t physical_page_id, const char *page_data) {
-  size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
-  // set write cursor to offset
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG(ERROR) << "I/O error while writing";
-    return;
-  }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
-}
\ No newline at end of file
+  if (NeedsBounce(page_data)) {
+    thread_local auto bounce = AllocatePageBuffer(1);
+    memcpy(bounce.get(), page_data, PAGE_SIZE);
+    WritePhysicalPage(physical_page_id, bounce.get());
+    return;
+  }
+  int64_t offset = static_cast<int64_t>(physical_page_id) * PAGE_SIZE;
+  ssize_t write_count = 0;
+  while (write_count < PAGE_SIZE) {
+    ssize_t n = pwrite(db_fd_, page_data + write_count, PAGE_SIZE - write_count, offset + write_count);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    // check for I/O error
+    if (n <= 0) {
+      LOG(ERROR) << "I/O error while writing: " << strerror(errno);
+      return;
+    }
+    write_count += n;
+  }
+  GrowFileSize(offset + PAGE_SIZE);
+}
+
+void DiskManager::WritePhysicalPages(page_id_t physical_page_id, struct iovec *iov, int count) {
+  int64_t offset = static_cast<int64_t>(physical_page_id) * PAGE_SIZE;
+  int64_t end = offset + static_cast<int64_t>(count) * PAGE_SIZE;
+  while (count > 0) {
+    ssize_t n = pwritev(db_fd_, iov, count, offset);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    // check for I/O error
+    if (n <= 0) {
+      LOG(ERROR) << "I/O error while writing: " << strerror(errno);
+      return;
+    }
+    // a short write goes on with the rest of the pages
+    offset += n;
+    for (; count > 0 && static_cast<size_t>(n) >= iov->iov_len; iov++, count--) {
+      n -= iov->iov_len;
+    }
+    if (count > 0) {
+      iov->iov_base = static_cast<char *>(iov->iov_base) + n;
+      iov->iov_len -= n;
+    }
+  }
+  GrowFileSize(end);
+}
+
+void DiskManager::GrowFileSize(int64_t end) {
+  // the file only grows, pages written concurrently past the end race for the new size
+  int64_t size = file_size_;
+  while (size < end && !file_size_.compare_exchange_weak(size, end)) {
+  }
+}
@@ -1,142 +1,541 @@
 #include "storage/table_heap.h"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
-bool TableHeap::InsertTuple(Row &row, Transaction *txn) {
-  page_id_t i = first_page_id_;
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(i));
-  int lastI = i;
-  // first fit
-  while(i!=INVALID_PAGE_ID){
-    page=reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(i));
-    if(page->InsertTuple(row,schema_,txn,lock_manager_,log_manager_)){
-      buffer_pool_manager_->UnpinPage(page->GetTablePageId(),true);
+bool TableHeap::InsertTuple(Row &row, Transaction *txn, BufferAccessStrategy *strategy) {
+  std::scoped_lock<std::recursive_mutex> lock(fsm_latch_);
+  LoadFreeSpaceMap();
+  uint8_t min_category = FreeSpaceMapPage::CategoryFor(TablePage::SpaceFor(row.GetSerializedSize(schema_)));
+  // the free space map points to a page with room, the page chain is not walked
+  page_id_t i = FindFreeSpace(min_category);
+  if (i != INVALID_PAGE_ID) {
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(i);
+    auto page = reinterpret_cast<TablePage *>(guard.GetPage());
+    bool inserted = page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
+    UpdateFreeSpace(i, page);
+    if (inserted) {
       return true;
     }
-    lastI = i;
-    i = page->GetNextPageId();
-    buffer_pool_manager_->UnpinPage(page->GetTablePageId(),false);
   }
-  // need to allocate a new page, i=invalid page id
-  page=reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(i));
-  page->Init(i,lastI,log_manager_,txn);
-  // set next page id
-  auto lastPage=reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(lastI));
-  lastPage->SetNextPageId(i);
-  buffer_pool_manager_->UnpinPage(lastI, true);
+  // need to allocate a new page, after the last one
+  WritePageGuard new_guard = AppendPage(i, txn, strategy);
+  if (!new_guard.IsValid()) {
+    return false;
+  }
   // insert to new page
-  if(page->InsertTuple(row,schema_,txn,lock_manager_,log_manager_)){
-    buffer_pool_manager_->UnpinPage(i, true);
-    return true;
+  auto page = reinterpret_cast<TablePage *>(new_guard.GetPage());
+  bool inserted = page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
+  UpdateFreeSpace(i, page);
+  return inserted;
+}
+
+size_t TableHeap::InsertTuples(const std::vector<Row *> &rows, Transaction *txn, BufferAccessStrategy *strategy) {
+  std::scoped_lock<std::recursive_mutex> lock(fsm_latch_);
+  LoadFreeSpaceMap();
+  size_t inserted = 0;
+  page_id_t page_id = INVALID_PAGE_ID;
+  WritePageGuard guard;
+  for (Row *row : rows) {
+    uint32_t serialized_size = row->GetSerializedSize(schema_);
+    if (serialized_size > TablePage::SIZE_MAX_ROW) {
+      row->SetRowId(INVALID_ROWID);
+      continue;
+    }
+    if (guard.IsValid() &&
+        reinterpret_cast<TablePage *>(guard.GetPage())->InsertTuple(*row, schema_, txn, lock_manager_, log_manager_)) {
+      inserted++;
+      continue;
+    }
+    // the page is full, its entry is written once for all the tuples it took
+    if (guard.IsValid()) {
+      UpdateFreeSpace(page_id, reinterpret_cast<TablePage *>(guard.GetPage()));
+      guard.Drop();
+    }
+    page_id = FindFreeSpace(FreeSpaceMapPage::CategoryFor(TablePage::SpaceFor(serialized_size)));
+    if (page_id != INVALID_PAGE_ID) {
+      guard = buffer_pool_manager_->FetchPageWrite(page_id);
+      auto page = reinterpret_cast<TablePage *>(guard.GetPage());
+      if (page->InsertTuple(*row, schema_, txn, lock_manager_, log_manager_)) {
+        inserted++;
+        continue;
+      }
+      UpdateFreeSpace(page_id, page);
+      guard.Drop();
+    }
+    guard = AppendPage(page_id, txn, strategy);
+    if (!guard.IsValid()) {
+      row->SetRowId(INVALID_ROWID);
+      continue;
+    }
+    reinterpret_cast<TablePage *>(guard.GetPage())->InsertTuple(*row, schema_, txn, lock_manager_, log_manager_);
+    inserted++;
   }
-  buffer_pool_manager_->UnpinPage(i, true);
-  return false;
+  if (guard.IsValid()) {
+    UpdateFreeSpace(page_id, reinterpret_cast<TablePage *>(guard.GetPage()));
+  }
+  return inserted;
+}
+
+WritePageGuard TableHeap::AppendPage(page_id_t &page_id, Transaction *txn, BufferAccessStrategy *strategy) {
+  // from the run reserved for this heap, its pages stay contiguous while other tables grow
+  page_id_t last_page_id = last_page_id_;
+  WritePageGuard guard = buffer_pool_manager_->NewPageGuardedFor(this, page_id, strategy);
+  if (!guard.IsValid()) {
+    return guard;
+  }
+  auto page = reinterpret_cast<TablePage *>(guard.GetPage());
+  page->Init(page_id, last_page_id, log_manager_, txn);
+  // the page is linked once it has its entry, the free space map may need a page there is no room for
+  if (!AppendFreeSpace(page_id, page)) {
+    guard.Drop();
+    buffer_pool_manager_->DeletePage(page_id);
+    return guard;
+  }
+  // set next page id
+  {
+    WritePageGuard last_guard = buffer_pool_manager_->FetchPageWrite(last_page_id);
+    reinterpret_cast<TablePage *>(last_guard.GetPage())->SetNextPageId(page_id);
+  }
+  return guard;
 }
 
 bool TableHeap::MarkDelete(const RowId &rid, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
   // If the page could not be found, then abort the transaction.
-  if (page == nullptr) {
+  if (!guard.IsValid()) {
     return false;
   }
   // Otherwise, mark the tuple as deleted.
+  auto page = reinterpret_cast<TablePage *>(guard.GetPage());
   page->WLatch();
   page->MarkDelete(rid, txn, lock_manager_, log_manager_);
   page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
   return true;
 }
 
 bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Transaction *txn) {
-  auto page=reinterpret_cast<TablePage *>(buffer_pool_manager_ ->FetchPage(rid.GetPageId()));//get the page
-  if(page==nullptr){
+  std::scoped_lock<std::recursive_mutex> lock(fsm_latch_);
+  LoadFreeSpaceMap();
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());//get the page
+  if (!guard.IsValid()) {
     return false;
   }
-  Row *oldRow=new Row(rid);//get the old row
-  int type=page->UpdateTuple(row,oldRow,schema_,txn,lock_manager_,log_manager_);//get the update result
-  switch(type){
-    case 1:buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);return false;
-    case 2:buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);return false;//invalid update
-    case 0:buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);return true;
-    //not enough space for update
-    case 3:if(page->MarkDelete(rid,txn,lock_manager_,log_manager_)){
-      TablePage *oldPage=page;
-      int i=first_page_id_;
-      int preI=i;
-      while(i!=INVALID_PAGE_ID){
-        page=reinterpret_cast<TablePage *>(buffer_pool_manager_ ->FetchPage(i));
-        if(page->InsertTuple(row,schema_,txn,lock_manager_,log_manager_)){
-          oldPage->ApplyDelete(rid,txn,log_manager_);
-          buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
-          return true;
-        }else{
-          preI=i;
-          i=page->GetNextPageId();
-          buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
-        }
+  auto page = reinterpret_cast<TablePage *>(guard.GetPage());
+  Row oldRow(rid);//get the old row
+  int type = page->UpdateTuple(row, &oldRow, schema_, txn, lock_manager_, log_manager_);//get the update result
+  switch (type) {
+    case 0:
+      UpdateFreeSpace(rid.GetPageId(), page);
+      return true;
+    //not enough space for update: delete here and insert somewhere else
+    case 3:
+      if (!page->MarkDelete(rid, txn, lock_manager_, log_manager_)) {
+        return false;
       }
-      //create a new page
-      page=reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(i));
-      page->Init(preI,i,log_manager_,txn);
-      if(page->InsertTuple(row,schema_,txn,lock_manager_,log_manager_)){
-          oldPage->ApplyDelete(rid,txn,log_manager_);
-          buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
-          return true;
+      // the entry of this page is exact, the insert does not come back to it
+      UpdateFreeSpace(rid.GetPageId(), page);
+      if (InsertTuple(row, txn)) {
+        page->ApplyDelete(rid, txn, log_manager_);
+        UpdateFreeSpace(rid.GetPageId(), page);
+        return true;
       }
-      buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+      page->RollbackDelete(rid, txn, log_manager_);
       return false;
-    }else{
-      buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
+    //invalid update
+    default:
       return false;
-    }
   }
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
-  return false;
 }
 
 void TableHeap::ApplyDelete(const RowId &rid, Transaction *txn) {
   // Step1: Find the page which contains the tuple.
   // Step2: Delete the tuple from the page.
-  auto page=reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  page->ApplyDelete(rid,txn,log_manager_);
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  std::scoped_lock<std::recursive_mutex> lock(fsm_latch_);
+  LoadFreeSpaceMap();
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  auto page = reinterpret_cast<TablePage *>(guard.GetPage());
+  page->ApplyDelete(rid, txn, log_manager_);
+  UpdateFreeSpace(rid.GetPageId(), page);
 }
 
 void TableHeap::RollbackDelete(const RowId &rid, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  assert(page != nullptr);
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  assert(guard.IsValid());
   // Rollback the delete.
+  auto page = reinterpret_cast<TablePage *>(guard.GetPage());
   page->WLatch();
   page->RollbackDelete(rid, txn, log_manager_);
   page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
 
 void TableHeap::FreeHeap() {
-  int i=first_page_id_;
-  while(i!=INVALID_PAGE_ID){
-    auto page=reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(i));
-    i=page->GetNextPageId();
+  // a heap in a file of its own goes away with the file
+  if (buffer_pool_manager_->DropTablespace(this)) {
+    return;
+  }
+  std::scoped_lock<std::recursive_mutex> lock(fsm_latch_);
+  page_id_t fsm_page_id = INVALID_PAGE_ID;
+  page_id_t i = first_page_id_;
+  while (i != INVALID_PAGE_ID) {
+    ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(i);
+    page_id_t page_id = i;
+    auto page = reinterpret_cast<TablePage *>(guard.GetPage());
+    if (page_id == first_page_id_) {
+      fsm_page_id = page->GetFsmPageId();
+    }
+    i = page->GetNextPageId();
     // delete page
-    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
-    buffer_pool_manager_->DeletePage(page->GetTablePageId());
+    guard.Drop();
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  // and the pages of the free space map
+  while (fsm_page_id != INVALID_PAGE_ID) {
+    ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(fsm_page_id);
+    page_id_t page_id = fsm_page_id;
+    fsm_page_id = reinterpret_cast<const FreeSpaceMapPage *>(guard.GetData())->GetNextPageId();
+    guard.Drop();
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  buffer_pool_manager_->ReleasePages(this);
+  fsm_loaded_ = false;
+  fsm_page_ids_.clear();
+  fsm_max_categories_.clear();
+  fsm_entries_.clear();
+  page_directory_.clear();
+}
+
+size_t TableHeap::Vacuum(Transaction *txn, const MoveCallback &on_move, size_t *pages_before, size_t *pages_after) {
+  std::scoped_lock<std::recursive_mutex> lock(fsm_latch_);
+  LoadFreeSpaceMap();
+  std::vector<page_id_t> page_ids;
+  for (page_id_t page_id = first_page_id_; page_id != INVALID_PAGE_ID;) {
+    ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(page_id);
+    if (!guard.IsValid()) {
+      break;
+    }
+    page_ids.push_back(page_id);
+    page_id = reinterpret_cast<TablePage *>(guard.GetPage())->GetNextPageId();
+  }
+  // the tuples of the page at the back go into the first page in front of it with room, until both ends meet
+  size_t moved = 0;
+  size_t dest = 0;
+  for (size_t src = page_ids.size(); src-- > dest + 1;) {
+    WritePageGuard src_guard = buffer_pool_manager_->FetchPageWrite(page_ids[src]);
+    auto src_page = reinterpret_cast<TablePage *>(src_guard.GetPage());
+    WritePageGuard dest_guard = buffer_pool_manager_->FetchPageWrite(page_ids[dest]);
+    RowId rid;
+    for (bool found = src_page->GetFirstTupleRid(&rid); found && dest < src;
+         found = src_page->GetNextTupleRid(rid, &rid)) {
+      Row row(rid);
+      src_page->GetTuple(&row, schema_, txn, lock_manager_);
+      Row moved_row(row);
+      while (!reinterpret_cast<TablePage *>(dest_guard.GetPage())
+              ->InsertTuple(moved_row, schema_, txn, lock_manager_, log_manager_)) {
+        if (++dest == src) {
+          break;
+        }
+        dest_guard = buffer_pool_manager_->FetchPageWrite(page_ids[dest]);
+      }
+      if (dest == src) {
+        break;
+      }
+      on_move(row, moved_row.GetRowId());
+      src_page->ApplyDelete(rid, txn, log_manager_);
+      moved++;
+    }
+  }
+  // unlink the empty pages, the first page stays as the catalog knows it
+  std::vector<page_id_t> kept{first_page_id_};
+  for (size_t i = 1; i < page_ids.size(); i++) {
+    ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(page_ids[i]);
+    if (!reinterpret_cast<TablePage *>(guard.GetPage())->IsEmpty()) {
+      kept.push_back(page_ids[i]);
+      continue;
+    }
+    guard.Drop();
+    buffer_pool_manager_->DeletePage(page_ids[i]);
+  }
+  for (size_t i = 0; i < kept.size(); i++) {
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(kept[i]);
+    auto page = reinterpret_cast<TablePage *>(guard.GetPage());
+    page->SetPrevPageId(i == 0 ? INVALID_PAGE_ID : kept[i - 1]);
+    page->SetNextPageId(i + 1 == kept.size() ? INVALID_PAGE_ID : kept[i + 1]);
+    page->TrimSlots();
+  }
+  RebuildFreeSpaceMap(kept);
+  // the next page the heap needs starts a new run
+  buffer_pool_manager_->ReleasePages(this);
+  if (pages_before != nullptr) {
+    *pages_before = page_ids.size();
+  }
+  if (pages_after != nullptr) {
+    *pages_after = kept.size();
+  }
+  return moved;
+}
+
+void TableHeap::LoadFreeSpaceMap() {
+  if (fsm_loaded_) {
+    return;
+  }
+  page_id_t fsm_page_id;
+  {
+    ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(first_page_id_);
+    fsm_page_id = reinterpret_cast<TablePage *>(guard.GetPage())->GetFsmPageId();
+  }
+  if (fsm_page_id == INVALID_PAGE_ID) {
+    std::vector<page_id_t> page_ids;
+    for (page_id_t page_id = first_page_id_; page_id != INVALID_PAGE_ID;) {
+      page_ids.push_back(page_id);
+      ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(page_id);
+      page_id = reinterpret_cast<TablePage *>(guard.GetPage())->GetNextPageId();
+    }
+    RebuildFreeSpaceMap(page_ids);
+    return;
+  }
+  while (fsm_page_id != INVALID_PAGE_ID) {
+    ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(fsm_page_id);
+    auto fsm_page = reinterpret_cast<const FreeSpaceMapPage *>(guard.GetData());
+    uint32_t first_entry = fsm_page_ids_.size() * FreeSpaceMapPage::MAX_ENTRY_COUNT;
+    for (uint32_t i = 0; i < fsm_page->GetEntryCount(); i++) {
+      fsm_entries_[fsm_page->GetPageId(i)] = first_entry + i;
+      page_directory_.push_back(fsm_page->GetPageId(i));
+      last_page_id_ = fsm_page->GetPageId(i);
+    }
+    fsm_page_ids_.push_back(fsm_page_id);
+    fsm_max_categories_.push_back(fsm_page->GetMaxCategory());
+    fsm_page_id = fsm_page->GetNextPageId();
   }
+  fsm_loaded_ = true;
+}
+
+void TableHeap::RebuildFreeSpaceMap(const std::vector<page_id_t> &page_ids) {
+  size_t num_fsm_pages = std::max<size_t>(1, (page_ids.size() + FreeSpaceMapPage::MAX_ENTRY_COUNT - 1) /
+                                                 FreeSpaceMapPage::MAX_ENTRY_COUNT);
+  for (; fsm_page_ids_.size() > num_fsm_pages; fsm_page_ids_.pop_back()) {
+    buffer_pool_manager_->DeletePage(fsm_page_ids_.back());
+  }
+  while (fsm_page_ids_.size() < num_fsm_pages) {
+    page_id_t fsm_page_id;
+    WritePageGuard guard = buffer_pool_manager_->NewPageGuardedFor(this, fsm_page_id);
+    ASSERT(guard.IsValid(), "Create new page failed!");
+    fsm_page_ids_.push_back(fsm_page_id);
+  }
+  fsm_max_categories_.assign(num_fsm_pages, 0);
+  fsm_entries_.clear();
+  for (size_t m = 0; m < num_fsm_pages; m++) {
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(fsm_page_ids_[m]);
+    auto fsm_page = reinterpret_cast<FreeSpaceMapPage *>(guard.GetData());
+    fsm_page->Init();
+    if (m + 1 < num_fsm_pages) {
+      fsm_page->SetNextPageId(fsm_page_ids_[m + 1]);
+    }
+    for (size_t i = m * FreeSpaceMapPage::MAX_ENTRY_COUNT;
+         i < page_ids.size() && i < (m + 1) * FreeSpaceMapPage::MAX_ENTRY_COUNT; i++) {
+      ReadPageGuard page_guard = buffer_pool_manager_->FetchPageRead(page_ids[i]);
+      uint8_t category = FreeSpaceMapPage::CategoryOf(
+              reinterpret_cast<TablePage *>(page_guard.GetPage())->GetFreeSpaceRemaining());
+      fsm_page->Append(page_ids[i], category);
+      fsm_entries_[page_ids[i]] = i;
+      fsm_max_categories_[m] = std::max(fsm_max_categories_[m], category);
+    }
+  }
+  {
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(first_page_id_);
+    reinterpret_cast<TablePage *>(guard.GetPage())->SetFsmPageId(fsm_page_ids_[0]);
+  }
+  page_directory_ = page_ids;
+  last_page_id_ = page_ids.back();
+  fsm_loaded_ = true;
+}
+
+page_id_t TableHeap::FindFreeSpace(uint8_t min_category) {
+  for (size_t m = 0; m < fsm_page_ids_.size(); m++) {
+    if (fsm_max_categories_[m] < min_category) {
+      continue;
+    }
+    ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(fsm_page_ids_[m]);
+    auto fsm_page = reinterpret_cast<const FreeSpaceMapPage *>(guard.GetData());
+    int entry = fsm_page->Find(min_category);
+    if (entry != -1) {
+      return fsm_page->GetPageId(entry);
+    }
+    fsm_max_categories_[m] = fsm_page->GetMaxCategory();
+  }
+  return INVALID_PAGE_ID;
+}
+
+void TableHeap::UpdateFreeSpace(page_id_t page_id, TablePage *page) {
+  auto iter = fsm_entries_.find(page_id);
+  if (iter == fsm_entries_.end()) {
+    return;
+  }
+  size_t m = iter->second / FreeSpaceMapPage::MAX_ENTRY_COUNT;
+  uint32_t entry = iter->second % FreeSpaceMapPage::MAX_ENTRY_COUNT;
+  uint8_t category = FreeSpaceMapPage::CategoryOf(page->GetFreeSpaceRemaining());
+  {
+    // most inserts leave the category as it is, the map page stays clean
+    ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(fsm_page_ids_[m]);
+    if (reinterpret_cast<const FreeSpaceMapPage *>(guard.GetData())->GetCategory(entry) == category) {
+      return;
+    }
+  }
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(fsm_page_ids_[m]);
+  reinterpret_cast<FreeSpaceMapPage *>(guard.GetData())->SetCategory(entry, category);
+  fsm_max_categories_[m] = std::max(fsm_max_categories_[m], category);
+}
+
+bool TableHeap::AppendFreeSpace(page_id_t page_id, TablePage *page) {
+  uint8_t category = FreeSpaceMapPage::CategoryOf(page->GetFreeSpaceRemaining());
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(fsm_page_ids_.back());
+  auto fsm_page = reinterpret_cast<FreeSpaceMapPage *>(guard.GetData());
+  if (fsm_page->IsFull()) {
+    page_id_t fsm_page_id;
+    WritePageGuard new_guard = buffer_pool_manager_->NewPageGuardedFor(this, fsm_page_id);
+    if (!new_guard.IsValid()) {
+      return false;
+    }
+    fsm_page->SetNextPageId(fsm_page_id);
+    fsm_page_ids_.push_back(fsm_page_id);
+    fsm_max_categories_.push_back(0);
+    guard = std::move(new_guard);
+    fsm_page = reinterpret_cast<FreeSpaceMapPage *>(guard.GetData());
+    fsm_page->Init();
+  }
+  fsm_entries_[page_id] = (fsm_page_ids_.size() - 1) * FreeSpaceMapPage::MAX_ENTRY_COUNT + fsm_page->GetEntryCount();
+  fsm_page->Append(page_id, category);
+  page_directory_.push_back(page_id);
+  fsm_max_categories_.back() = std::max(fsm_max_categories_.back(), category);
+  last_page_id_ = page_id;
+  return true;
 }
 
 bool TableHeap::GetTuple(Row *row, Transaction *txn) {
-  auto page=reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(row->GetRowId().GetPageId()));
-  if(page->GetTuple(row,schema_,txn,lock_manager_)){
-    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
-    return true;
-  }else{
-    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
+  ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(row->GetRowId().GetPageId());
+  if (!guard.IsValid()) {
     return false;
   }
+  return reinterpret_cast<TablePage *>(guard.GetPage())->GetTuple(row, schema_, txn, lock_manager_);
+}
+
+TableIterator TableHeap::Begin(Transaction *txn, std::shared_ptr<BufferAccessStrategy> strategy) {
+  return TableIterator(this, txn, std::move(strategy));
+}
+
+TableHeap::PageScan::PageScan(TableHeap *table_heap, Transaction *txn, std::shared_ptr<BufferAccessStrategy> strategy)
+        : table_heap_(table_heap), txn_(txn), strategy_(std::move(strategy)),
+          next_page_id_(table_heap->GetFirstPageId()) {}
+
+bool TableHeap::PageScan::Next() {
+  rids_.clear();
+  failed_ = false;
+  while (next_page_id_ != INVALID_PAGE_ID) {
+    // the page before is released by the move
+    guard_ = table_heap_->buffer_pool_manager_->FetchPageRead(next_page_id_, strategy_.get());
+    if (!guard_.IsValid()) {
+      // e.g. every frame of the pool is pinned, the caller learns the scan stopped short
+      failed_ = true;
+      break;
+    }
+    auto page = reinterpret_cast<TablePage *>(guard_.GetPage());
+    page_id_ = next_page_id_;
+    next_page_id_ = page->GetNextPageId();
+    // read ahead along the chain like TableIterator
+    size_t distance = table_heap_->prefetch_distance_;
+    if (pages_until_prefetch_ > 0) {
+      pages_until_prefetch_--;
+    } else if (distance > 0 && next_page_id_ != INVALID_PAGE_ID) {
+      table_heap_->buffer_pool_manager_->Prefetch(next_page_id_, distance, TablePage::NextPageIdOf, strategy_);
+      pages_until_prefetch_ = distance / 2;
+    }
+    RowId rid;
+    for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+      rids_.push_back(rid);
+    }
+    if (rids_.empty()) {
+      // skip pages left empty by deletes
+      continue;
+    }
+    while (views_.size() < rids_.size()) {
+      views_.emplace_back(table_heap_->schema_);
+    }
+    for (size_t i = 0; i < rids_.size(); i++) {
+      views_[i].Reset(page->GetTupleData(rids_[i].GetSlotNum()), rids_[i]);
+    }
+    return true;
+  }
+  guard_.Drop();
+  page_id_ = INVALID_PAGE_ID;
+  return false;
+}
+
+bool TableHeap::Scan(const std::function<void(const RowView &)> &visit, Transaction *txn,
+                     std::shared_ptr<BufferAccessStrategy> strategy) {
+  PageScan scan(this, txn, std::move(strategy));
+  while (scan.Next()) {
+    for (size_t i = 0; i < scan.GetTupleCount(); i++) {
+      visit(scan.GetView(i));
+    }
+  }
+  return !scan.IsFailed();
+}
+
+size_t TableHeap::GetParallelScanWorkers(size_t num_workers) {
+  std::scoped_lock<std::recursive_mutex> lock(fsm_latch_);
+  LoadFreeSpaceMap();
+  return ParallelScanWorkers(num_workers, page_directory_.size());
+}
+
+bool TableHeap::ParallelScan(size_t num_workers, const ParallelScanCallback &visit, Transaction *txn,
+                             std::shared_ptr<BufferAccessStrategy> strategy) {
+  // the directory is read once, the workers do not follow the page chain to find their pages
+  std::vector<page_id_t> page_ids = GetPageIds();
+  num_workers = ParallelScanWorkers(num_workers, page_ids.size());
+  // a worker that can not fetch a page stops the others, the scan is incomplete anyway
+  std::atomic<bool> failed{false};
+  auto scan_range = [&](size_t worker) {
+    size_t begin = page_ids.size() * worker / num_workers;
+    size_t end = page_ids.size() * (worker + 1) / num_workers;
+    size_t distance = prefetch_distance_;
+    RowView view(schema_);
+    for (size_t i = begin; i < end && !failed.load(std::memory_order_relaxed); i++) {
+      // read ahead within the range, the chain after its last page belongs to the next worker
+      if (distance > 0 && (i - begin) % std::max<size_t>(1, distance / 2) == 0 && i + 1 < end) {
+        buffer_pool_manager_->Prefetch(page_ids[i + 1], std::min(distance, end - i - 1), TablePage::NextPageIdOf,
+                                       strategy);
+      }
+      ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(page_ids[i], strategy.get());
+      if (!guard.IsValid()) {
+        failed = true;
+        return;
+      }
+      auto page = reinterpret_cast<TablePage *>(guard.GetPage());
+      RowId rid;
+      for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+        view.Reset(page->GetTupleData(rid.GetSlotNum()), rid);
+        visit(worker, view);
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t worker = 1; worker < num_workers; worker++) {
+    threads.emplace_back(scan_range, worker);
+  }
+  scan_range(0);
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return !failed;
 }
 
-TableIterator TableHeap::Begin(Transaction *txn) {
-  return TableIterator(this);
+std::vector<page_id_t> TableHeap::GetPageIds() {
+  std::scoped_lock<std::recursive_mutex> lock(fsm_latch_);
+  LoadFreeSpaceMap();
+  return page_directory_;
 }
 
 TableIterator TableHeap::End() {
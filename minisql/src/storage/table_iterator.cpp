@@ -5,21 +5,25 @@
 //own constructor
 TableIterator::TableIterator(TableHeap *th,RowId *row_id){
   table_heap=th;
-  page=reinterpret_cast<TablePage *>(table_heap->buffer_pool_manager_->FetchPage(row_id->GetPageId()));
-  row=new Row(*row_id);
-  table_heap->GetTuple(row, nullptr);
-  table_heap->buffer_pool_manager_->UnpinPage(page->GetPageId(),false);
+  if(row_id!=nullptr){
+    row=std::make_shared<Row>(*row_id);
+    table_heap->GetTuple(row.get(), nullptr);
+  }
 }
 
-TableIterator::TableIterator(TableHeap *th){
-  table_heap=th;
-  page=reinterpret_cast<TablePage *>(th->buffer_pool_manager_->FetchPage(th->GetFirstPageId()));
-  RowId *row_id=new RowId();
-  if(page->GetFirstTupleRid(row_id)){
-    row=new Row(*row_id);
-    table_heap->GetTuple(row, nullptr);
+TableIterator::TableIterator(TableHeap *th) : TableIterator(th, nullptr, nullptr) {}
+
+TableIterator::TableIterator(TableHeap *th, Transaction *txn, std::shared_ptr<BufferAccessStrategy> strategy)
+        : txn(txn), table_heap(th), strategy(std::move(strategy)) {
+  ReadPageGuard guard=th->buffer_pool_manager_->FetchPageRead(th->GetFirstPageId(), this->strategy.get());
+  auto page=reinterpret_cast<TablePage *>(guard.GetPage());
+  ReadAhead(page->GetNextPageId());
+  RowId row_id;
+  if(page->GetFirstTupleRid(&row_id)){
+    ReadTuple(page, row_id);
+  }else{
+    NextPage(page->GetNextPageId());
   }
-  table_heap->buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
 }
 
 TableIterator::TableIterator() {
@@ -29,8 +33,9 @@ TableIterator::TableIterator() {
 TableIterator::TableIterator(const TableIterator &other) {
   table_heap=other.table_heap;
   txn=other.txn;
-  page=other.page;
   row=other.row;
+  strategy=other.strategy;
+  pages_until_prefetch=other.pages_until_prefetch;
 }
 
 TableIterator::~TableIterator() {
@@ -54,60 +59,62 @@ const Row &TableIterator::operator*() {
 }
 
 Row *TableIterator::operator->() {
-  return row;
+  return row.get();
 }
 
 TableIterator &TableIterator::operator++() {
-  RowId *row_id=new RowId();
-  if(page->GetNextTupleRid(row->GetRowId(),row_id)){
-    row=new Row(*row_id);
-    table_heap->GetTuple(row, nullptr);
+  ReadPageGuard guard=table_heap->buffer_pool_manager_->FetchPageRead(row->GetRowId().GetPageId(), strategy.get());
+  auto page=reinterpret_cast<TablePage *>(guard.GetPage());
+  RowId row_id;
+  if(page->GetNextTupleRid(row->GetRowId(),&row_id)){
+    // read from the page already pinned, not through TableHeap::GetTuple
+    ReadTuple(page, row_id);
     return *this;
-  }else{//need to find next page
-    int i=page->GetNextPageId();
-    if(i!=INVALID_PAGE_ID){
-      page=reinterpret_cast<TablePage *>(table_heap->buffer_pool_manager_->FetchPage(i));
-      if(page->GetFirstTupleRid(row_id)){
-        row=new Row(*row_id);
-        table_heap->GetTuple(row, nullptr);
-        table_heap->buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
-        return *this;
-      }else{
-        row=nullptr;
-        table_heap->buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
-        return *this;
-      }
-    }else{
-      row=nullptr;
-      return *this;
-    }
   }
+  //need to find next page
+  page_id_t next_page_id=page->GetNextPageId();
+  guard.Drop();
+  NextPage(next_page_id);
+  return *this;
 }
 
 TableIterator TableIterator::operator++(int) {
   TableIterator tmp(*this);
-  RowId *row_id=new RowId();
-  if(page->GetNextTupleRid(row->GetRowId(),row_id)){
-    row=new Row(*row_id);
-    table_heap->GetTuple(row, nullptr);
-    return TableIterator(tmp);
-  }else{//need to find next page
-    int i=page->GetNextPageId();
-    if(i!=INVALID_PAGE_ID){
-      page=reinterpret_cast<TablePage *>(table_heap->buffer_pool_manager_->FetchPage(i));
-      if(page->GetFirstTupleRid(row_id)){
-        row=new Row(*row_id);
-        table_heap->GetTuple(row, nullptr);
-        table_heap->buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
-        return TableIterator(tmp);
-      }else{
-        row=nullptr;
-        table_heap->buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
-        return TableIterator(tmp);
-      }
-    }else{
-      row=nullptr;
-      return TableIterator(tmp);
+  operator++();
+  return TableIterator(tmp);
+}
+
+void TableIterator::NextPage(page_id_t page_id) {
+  row=nullptr;
+  // skip pages left empty by deletes
+  while(page_id!=INVALID_PAGE_ID){
+    ReadPageGuard guard=table_heap->buffer_pool_manager_->FetchPageRead(page_id, strategy.get());
+    auto page=reinterpret_cast<TablePage *>(guard.GetPage());
+    ReadAhead(page->GetNextPageId());
+    RowId row_id;
+    if(page->GetFirstTupleRid(&row_id)){
+      ReadTuple(page, row_id);
+      return;
     }
+    page_id=page->GetNextPageId();
   }
 }
+
+void TableIterator::ReadAhead(page_id_t next_page_id) {
+  size_t distance = table_heap->prefetch_distance_;
+  if (distance == 0 || next_page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  // the prefetcher walks the chain itself, so only ask again when half of the window is consumed
+  if (pages_until_prefetch > 0) {
+    pages_until_prefetch--;
+    return;
+  }
+  table_heap->buffer_pool_manager_->Prefetch(next_page_id, distance, TablePage::NextPageIdOf, strategy);
+  pages_until_prefetch = distance / 2;
+}
+
+void TableIterator::ReadTuple(TablePage *page, const RowId &rid) {
+  row=std::make_shared<Row>(rid);
+  page->GetTuple(row.get(), table_heap->schema_, txn, table_heap->lock_manager_);
+}
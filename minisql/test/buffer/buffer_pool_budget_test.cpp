@@ -0,0 +1,110 @@
+#include <cstdio>
+#include <string>
+
+#include "buffer/buffer_pool_budget.h"
+#include "gtest/gtest.h"
+
+TEST(BufferPoolBudgetTest, SetPoolSizeTest) {
+  const std::string db_name = "bpm_budget_test.db";
+  const size_t budget_frames = 100;
+  const size_t min_pool_size = 10;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  BufferPoolBudget budget(budget_frames, min_pool_size);
+  auto *bpm_a = new BufferPoolManager(60, disk_manager, DEFAULT_REPLACER_TYPE, budget_frames);
+  budget.Register(bpm_a);
+  // Scenario: a new pool starts with the spare frames.
+  EXPECT_EQ(40, budget.InitialPoolSize());
+  auto *bpm_b = new BufferPoolManager(budget.InitialPoolSize(), disk_manager, DEFAULT_REPLACER_TYPE, budget_frames);
+  budget.Register(bpm_b);
+  EXPECT_EQ(budget_frames, budget.GetUsed());
+  EXPECT_EQ(min_pool_size, budget.InitialPoolSize());
+
+  // Scenario: a fixed size takes the missing frames from the automatically tuned pools.
+  ASSERT_TRUE(budget.SetPoolSize(bpm_a, 80));
+  EXPECT_EQ(80, bpm_a->GetPoolSize());
+  EXPECT_EQ(20, bpm_b->GetPoolSize());
+  EXPECT_EQ(budget_frames, budget.GetUsed());
+
+  // Scenario: a size over the budget is refused without shrinking any pool.
+  EXPECT_FALSE(budget.SetPoolSize(bpm_a, 95));
+  EXPECT_EQ(80, bpm_a->GetPoolSize());
+  EXPECT_EQ(20, bpm_b->GetPoolSize());
+
+  // Scenario: a fixed pool is not a donor, the other pool can not grow into it.
+  EXPECT_FALSE(budget.SetPoolSize(bpm_b, 30));
+  ASSERT_TRUE(budget.SetPoolSize(bpm_a, 50));
+  ASSERT_TRUE(budget.SetPoolSize(bpm_b, 50));
+  EXPECT_EQ(budget_frames, budget.GetUsed());
+
+  // Scenario: the frames of an unregistered pool become spare.
+  budget.Unregister(bpm_a);
+  EXPECT_EQ(50, budget.GetUsed());
+  ASSERT_TRUE(budget.SetPoolSize(bpm_b, budget_frames));
+  EXPECT_FALSE(budget.SetPoolSize(bpm_a, 10));
+
+  budget.Unregister(bpm_b);
+  delete bpm_b;
+  delete bpm_a;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolBudgetTest, RebalanceTest) {
+  const std::string db_name = "bpm_budget_rebalance_test.db";
+  const size_t budget_frames = 200;
+  const size_t min_pool_size = 10;
+  const size_t working_set = 150;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  BufferPoolBudget budget(budget_frames, min_pool_size);
+  auto *busy = new BufferPoolManager(20, disk_manager, DEFAULT_REPLACER_TYPE, budget_frames);
+  auto *idle = new BufferPoolManager(100, disk_manager, DEFAULT_REPLACER_TYPE, budget_frames);
+  budget.Register(busy);
+  budget.Register(idle);
+  page_id_t page_id;
+  for (size_t i = 0; i < working_set; i++) {
+    ASSERT_NE(nullptr, busy->NewPage(page_id));
+    busy->UnpinPage(page_id, true);
+  }
+
+  // Scenario: a pool that keeps missing grows, first with the spare frames, then with frames of the idle
+  // pool, until its working set fits and it stops missing.
+  size_t last_size = busy->GetPoolSize();
+  for (int round = 0; round < 20; round++) {
+    for (page_id_t id = 0; id < static_cast<page_id_t>(working_set); id++) {
+      ASSERT_NE(nullptr, busy->FetchPage(id));
+      busy->UnpinPage(id, false);
+    }
+    budget.Rebalance();
+    EXPECT_GE(busy->GetPoolSize(), last_size);
+    last_size = busy->GetPoolSize();
+    EXPECT_LE(budget.GetUsed(), budget_frames);
+    EXPECT_GE(idle->GetPoolSize(), min_pool_size);
+  }
+  EXPECT_GE(busy->GetPoolSize(), working_set);
+  EXPECT_LT(idle->GetPoolSize(), 100);
+  size_t misses = busy->GetMissCount();
+  for (page_id_t id = 0; id < static_cast<page_id_t>(working_set); id++) {
+    ASSERT_NE(nullptr, busy->FetchPage(id));
+    busy->UnpinPage(id, false);
+  }
+  EXPECT_EQ(misses, busy->GetMissCount());
+
+  // Scenario: a pool with a fixed size is left alone.
+  ASSERT_TRUE(budget.SetPoolSize(idle, idle->GetPoolSize()));
+  size_t idle_size = idle->GetPoolSize();
+  for (int round = 0; round < 3; round++) {
+    budget.Rebalance();
+  }
+  EXPECT_EQ(idle_size, idle->GetPoolSize());
+
+  budget.Unregister(busy);
+  budget.Unregister(idle);
+  delete idle;
+  delete busy;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
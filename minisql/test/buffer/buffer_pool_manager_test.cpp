@@ -1,6 +1,9 @@
+#include <chrono>
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "glog/logging.h"
 #include "buffer/buffer_pool_manager.h"
@@ -72,4 +75,460 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
 
   delete bpm;
   delete disk_manager;
+}
+
+TEST(BufferPoolManagerTest, BackgroundWriterTest) {
+  const std::string db_name = "bpm_bg_writer_test.db";
+  const size_t buffer_pool_size = 10;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // Scenario: fill the pool with dirty pages, keep page 0 pinned.
+  Page *pages[buffer_pool_size];
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    pages[i] = bpm->NewPage(page_id_temp);
+    ASSERT_NE(nullptr, pages[i]);
+    snprintf(pages[i]->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    if (i != 0) {
+      bpm->UnpinPage(page_id_temp, true);
+    }
+  }
+
+  // Scenario: the background writer cleans every unpinned page, but not the pinned one.
+  bpm->StartBackgroundWriter(buffer_pool_size, 10);
+  auto all_clean = [&] {
+    for (size_t i = 1; i < buffer_pool_size; ++i) {
+      if (pages[i]->IsDirty()) {
+        return false;
+      }
+    }
+    return true;
+  };
+  for (int retry = 0; retry < 200 && !all_clean(); retry++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  bpm->StopBackgroundWriter();
+  EXPECT_TRUE(all_clean());
+  EXPECT_TRUE(pages[0]->IsDirty());
+  EXPECT_FALSE(bpm->CheckAllUnpinned());
+
+  char data[PAGE_SIZE];
+  char expected[PAGE_SIZE];
+  for (size_t i = 1; i < buffer_pool_size; ++i) {
+    disk_manager->ReadPage(i, data);
+    snprintf(expected, PAGE_SIZE, "page %d", static_cast<page_id_t>(i));
+    EXPECT_STREQ(expected, data);
+  }
+
+  // Scenario: a checkpoint writes the remaining dirty page as well.
+  bpm->FlushAllPages();
+  EXPECT_FALSE(pages[0]->IsDirty());
+  disk_manager->ReadPage(0, data);
+  EXPECT_STREQ("page 0", data);
+  bpm->UnpinPage(0, false);
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const std::string db_name = "bpm_prefetch_test.db";
+  const size_t buffer_pool_size = 10;
+  const page_id_t chain_length = 8;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // Scenario: build a chain 0 -> 1 -> ... -> 7 (next page id at offset 0), then push it out of the pool.
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < chain_length; i++) {
+    auto *page = bpm->NewPage(page_id_temp);
+    ASSERT_NE(nullptr, page);
+    page_id_t next = i + 1 < chain_length ? i + 1 : INVALID_PAGE_ID;
+    memcpy(page->GetData(), &next, sizeof(page_id_t));
+    bpm->UnpinPage(page_id_temp, true);
+  }
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id_temp));
+    bpm->UnpinPage(page_id_temp, false);
+  }
+  auto wait_for_prefetch = [&](size_t count) {
+    for (int retry = 0; retry < 200 && bpm->GetPrefetchCount() < count; retry++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(count, bpm->GetPrefetchCount());
+  };
+
+  // Scenario: prefetch a list of pages, fetching them afterwards does not miss.
+  bpm->Prefetch({0, 1});
+  wait_for_prefetch(2);
+  size_t misses = bpm->GetMissCount();
+  for (page_id_t i = 0; i < 2; i++) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i + 1, *reinterpret_cast<page_id_t *>(page->GetData()));
+    bpm->UnpinPage(i, false);
+  }
+  EXPECT_EQ(misses, bpm->GetMissCount());
+
+  // Scenario: prefetch the chain from page 0, pages 0 and 1 are already in the pool, 2..5 are loaded.
+  bpm->Prefetch(0, 6, [](const char *page_data) { return *reinterpret_cast<const page_id_t *>(page_data); });
+  wait_for_prefetch(6);
+  for (page_id_t i = 0; i < 6; i++) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i + 1, *reinterpret_cast<page_id_t *>(page->GetData()));
+    bpm->UnpinPage(i, false);
+  }
+  EXPECT_EQ(misses, bpm->GetMissCount());
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+// runs the steps of a prefetch by hand, so they can be interleaved with other work in a fixed order
+class StepPrefetchBufferPoolManager : public BufferPoolManager {
+public:
+  using BufferPoolManager::BufferPoolManager;
+  using BufferPoolManager::PrefetchLookup;
+  using BufferPoolManager::PrefetchInstall;
+};
+
+TEST(BufferPoolManagerTest, PrefetchFlushTest) {
+  const std::string db_name = "bpm_prefetch_flush_test.db";
+  const size_t buffer_pool_size = 3;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new StepPrefetchBufferPoolManager(buffer_pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size + 1; i++) {
+    auto *page = bpm->NewPage(page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "old %d", page_id_temp);
+    bpm->UnpinPage(page_id_temp, true);
+  }
+  bpm->FlushAllPages();
+  // fill the pool with the other pages, pinned, so the page is evicted clean
+  auto push_out = [&](page_id_t page_id) {
+    for (page_id_t i = 0; i <= static_cast<page_id_t>(buffer_pool_size); i++) {
+      if (i != page_id) {
+        ASSERT_NE(nullptr, bpm->FetchPage(i));
+      }
+    }
+    for (page_id_t i = 0; i <= static_cast<page_id_t>(buffer_pool_size); i++) {
+      if (i != page_id) {
+        bpm->UnpinPage(i, false);
+      }
+    }
+  };
+
+  // Scenario: the prefetcher reads the page, then it is fetched, changed, written back by a flush and evicted
+  // clean before the read is installed. The stale read is dropped, whether the write was by FlushPage or by the
+  // background writer.
+  for (bool background : {false, true}) {
+    page_id_t page_id = background ? 1 : 0;
+    push_out(page_id);
+    page_id_t next;
+    size_t write_backs;
+    ASSERT_FALSE(bpm->PrefetchLookup(page_id, nullptr, &next, &write_backs));
+    char read[PAGE_SIZE];
+    disk_manager->ReadPage(page_id, read);
+
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "new %d", page_id);
+    bpm->UnpinPage(page_id, true);
+    if (background) {
+      bpm->StartBackgroundWriter(buffer_pool_size, 10);
+      for (int retry = 0; retry < 200 && page->IsDirty(); retry++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+      bpm->StopBackgroundWriter();
+    } else {
+      ASSERT_TRUE(bpm->FlushPage(page_id));
+    }
+    ASSERT_FALSE(page->IsDirty());
+    push_out(page_id);
+
+    ASSERT_TRUE(bpm->PrefetchInstall(page_id, read, write_backs, nullptr));
+    page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    char expected[PAGE_SIZE];
+    snprintf(expected, PAGE_SIZE, "new %d", page_id);
+    EXPECT_STREQ(expected, page->GetData());
+    bpm->UnpinPage(page_id, false);
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, PageGuardTest) {
+  const std::string db_name = "bpm_page_guard_test.db";
+  const size_t buffer_pool_size = 10;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // Scenario: a new page is unpinned dirty when its guard goes out of scope.
+  page_id_t page_id;
+  {
+    WritePageGuard guard = bpm->NewPageGuarded(page_id);
+    ASSERT_TRUE(guard.IsValid());
+    EXPECT_EQ(page_id, guard.PageId());
+    snprintf(guard.GetData(), PAGE_SIZE, "guarded");
+    EXPECT_FALSE(bpm->CheckAllUnpinned());
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  size_t writes = disk_manager->GetNumWrites();
+  bpm->FlushAllPages();
+  EXPECT_EQ(writes + 1, disk_manager->GetNumWrites());
+
+  // Scenario: moving a guard moves the pin, the page is unpinned exactly once.
+  {
+    ReadPageGuard guard = bpm->FetchPageRead(page_id);
+    ReadPageGuard other(std::move(guard));
+    EXPECT_FALSE(guard.IsValid());
+    EXPECT_STREQ("guarded", other.GetData());
+    guard = std::move(other);
+    EXPECT_EQ(1, guard.GetPage()->GetPinCount());
+    ReadPageGuard second = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(2, second.GetPage()->GetPinCount());
+    second.Drop();
+    EXPECT_EQ(1, guard.GetPage()->GetPinCount());
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  // Scenario: reading through a guard leaves the page clean, nothing is written back.
+  writes = disk_manager->GetNumWrites();
+  {
+    ReadPageGuard guard = bpm->FetchPageRead(page_id);
+    EXPECT_FALSE(guard.GetPage()->IsDirty());
+  }
+  bpm->FlushAllPages();
+  EXPECT_EQ(writes, disk_manager->GetNumWrites());
+
+  // Scenario: a guard on a page that can not be brought into the pool is empty.
+  Page *pinned[buffer_pool_size];
+  for (auto &page : pinned) {
+    page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+  }
+  EXPECT_FALSE(bpm->FetchPageRead(0).IsValid());
+  EXPECT_FALSE(bpm->FetchPageWrite(0).IsValid());
+  for (auto &page : pinned) {
+    bpm->UnpinPage(page->GetPageId(), false);
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, ResizeTest) {
+  const std::string db_name = "bpm_resize_test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t max_pool_size = 40;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, DEFAULT_REPLACER_TYPE, max_pool_size);
+  EXPECT_EQ(max_pool_size, bpm->GetMaxPoolSize());
+  EXPECT_FALSE(bpm->Resize(0));
+  EXPECT_FALSE(bpm->Resize(max_pool_size + 1));
+
+  // Scenario: a grown pool holds more pinned pages at once, the pages pinned before stay where they are.
+  std::vector<page_id_t> page_ids;
+  std::vector<Page *> pages;
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    page_ids.push_back(page_id);
+    pages.push_back(page);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(page_id));
+  ASSERT_TRUE(bpm->Resize(max_pool_size));
+  EXPECT_EQ(max_pool_size, bpm->GetPoolSize());
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    EXPECT_EQ(pages[i], bpm->FetchPage(page_ids[i]));
+    bpm->UnpinPage(page_ids[i], false);
+  }
+  for (size_t i = buffer_pool_size; i < max_pool_size; i++) {
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    page_ids.push_back(page_id);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(page_id));
+
+  // Scenario: frames holding pinned pages can not be removed.
+  EXPECT_FALSE(bpm->Resize(buffer_pool_size));
+  EXPECT_EQ(max_pool_size, bpm->GetPoolSize());
+
+  // Scenario: shrinking writes back the dirty pages of the removed frames, no content is lost.
+  for (auto id : page_ids) {
+    bpm->UnpinPage(id, true);
+  }
+  size_t writes = disk_manager->GetNumWrites();
+  ASSERT_TRUE(bpm->Resize(buffer_pool_size));
+  EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+  EXPECT_EQ(writes + max_pool_size - buffer_pool_size, disk_manager->GetNumWrites());
+  for (auto id : page_ids) {
+    Page *page = bpm->FetchPage(id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(id), std::string(page->GetData()));
+    bpm->UnpinPage(id, false);
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  // Scenario: after shrinking, the pool only holds as many pinned pages as it has frames.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+  }
+  EXPECT_EQ(nullptr, bpm->FetchPage(page_ids[buffer_pool_size]));
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    bpm->UnpinPage(page_ids[i], false);
+  }
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, AccessStrategyTest) {
+  const std::string db_name = "bpm_access_strategy_test.db";
+  const size_t buffer_pool_size = 50;
+  const size_t hot_pages = 20;
+  const size_t scan_pages = 200;
+  const size_t ring_size = 8;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  std::vector<page_id_t> hot;
+  std::vector<page_id_t> cold;
+  page_id_t page_id;
+  for (size_t i = 0; i < hot_pages + scan_pages; i++) {
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+    (i < scan_pages ? cold : hot).push_back(page_id);
+  }
+  for (auto id : hot) {
+    ASSERT_NE(nullptr, bpm->FetchPage(id));
+    bpm->UnpinPage(id, false);
+  }
+
+  // Scenario: a scan through a ring only recycles the frames of its ring, the hot pages stay in the pool
+  // except the ring_size pages evicted while the ring is filled.
+  BufferAccessStrategy strategy(ring_size);
+  size_t misses = bpm->GetMissCount();
+  for (auto id : cold) {
+    Page *page = bpm->FetchPage(id, &strategy);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(id), std::string(page->GetData()));
+    bpm->UnpinPage(id, false);
+  }
+  EXPECT_GE(strategy.GetReuseCount(), scan_pages - buffer_pool_size - ring_size);
+  for (auto id : hot) {
+    ASSERT_NE(nullptr, bpm->FetchPage(id));
+    bpm->UnpinPage(id, false);
+  }
+  // the cold pages still in the pool from their creation were hits
+  EXPECT_LE(bpm->GetMissCount(), misses + scan_pages - (buffer_pool_size - hot_pages) + ring_size);
+
+  // Scenario: without a ring the same scan evicts the hot pages.
+  for (auto id : cold) {
+    ASSERT_NE(nullptr, bpm->FetchPage(id));
+    bpm->UnpinPage(id, false);
+  }
+  misses = bpm->GetMissCount();
+  for (auto id : hot) {
+    ASSERT_NE(nullptr, bpm->FetchPage(id));
+    bpm->UnpinPage(id, false);
+  }
+  EXPECT_EQ(misses + hot_pages, bpm->GetMissCount());
+
+  // Scenario: new pages written through a ring are written back when their frame is recycled, and a
+  // pinned frame of the ring is not recycled.
+  BufferAccessStrategy bulk_strategy(ring_size);
+  Page *pinned = bpm->NewPage(page_id, &bulk_strategy);
+  ASSERT_NE(nullptr, pinned);
+  page_id_t pinned_id = page_id;
+  size_t writes = disk_manager->GetNumWrites();
+  for (size_t i = 0; i < 4 * ring_size; i++) {
+    Page *page = bpm->NewPage(page_id, &bulk_strategy);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+    EXPECT_NE(pinned, page);
+  }
+  EXPECT_GE(disk_manager->GetNumWrites(), writes + 2 * ring_size);
+  bpm->UnpinPage(pinned_id, false);
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, NewPagesTest) {
+  const std::string db_name = "bpm_new_pages_test.db";
+  const size_t buffer_pool_size = 10;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // Scenario: new pages come with consecutive page ids, all pinned.
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  std::vector<Page *> pages;
+  ASSERT_TRUE(bpm->NewPages(4, pages));
+  ASSERT_EQ(4, pages.size());
+  for (size_t i = 0; i < pages.size(); i++) {
+    EXPECT_EQ(page_id + 1 + static_cast<page_id_t>(i), pages[i]->GetPageId());
+    EXPECT_EQ(1, pages[i]->GetPinCount());
+  }
+
+  // Scenario: if they do not all fit into the pool, nothing is allocated.
+  EXPECT_FALSE(bpm->NewPages(buffer_pool_size, pages));
+  EXPECT_TRUE(pages.empty());
+  EXPECT_TRUE(bpm->IsPageFree(page_id + 5));
+  page_id_t next_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(next_page_id));
+  EXPECT_EQ(page_id + 5, next_page_id);
+
+  // Scenario: pages of an owner are taken from its run, the rest of the run is freed when it is released.
+  for (page_id_t id = page_id; id <= next_page_id; id++) {
+    bpm->UnpinPage(id, false);
+  }
+  int owner = 0;
+  ASSERT_NE(nullptr, bpm->NewPageFor(&owner, page_id));
+  EXPECT_EQ(next_page_id + 1, page_id);
+  EXPECT_FALSE(bpm->IsPageFree(page_id + 1));
+  bpm->UnpinPage(page_id, true);
+  bpm->ReleasePages(&owner);
+  EXPECT_TRUE(bpm->IsPageFree(page_id + 1));
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
 }
\ No newline at end of file
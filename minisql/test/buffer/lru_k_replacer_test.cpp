@@ -0,0 +1,106 @@
+#include <cstdio>
+#include <string>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/lru_k_replacer.h"
+#include "gtest/gtest.h"
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2);
+
+  // Scenario: frames 1..6 are accessed once, frame 1 and 2 a second time (with others in between).
+  for (int i = 1; i <= 6; i++) {
+    lru_k_replacer.RecordAccess(i);
+  }
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.RecordAccess(2);
+  for (int i = 1; i <= 6; i++) {
+    lru_k_replacer.Unpin(i);
+  }
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: frames accessed only once have infinite k-distance and go first, oldest first.
+  int value;
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+
+  // Scenario: pinned frames can not be victimized, and an unknown frame is ignored.
+  lru_k_replacer.Pin(5);
+  lru_k_replacer.Pin(3);
+  EXPECT_EQ(3, lru_k_replacer.Size());
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(6, value);
+
+  // Scenario: among frames with k accesses, the oldest second-to-last access goes first.
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+
+  // Scenario: a removed frame forgets its history.
+  lru_k_replacer.Remove(2);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+  lru_k_replacer.Unpin(5);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(5, value);
+}
+
+TEST(LRUKReplacerTest, CorrelatedAccessTest) {
+  LRUKReplacer lru_k_replacer(4, 2);
+
+  // Scenario: back-to-back accesses to frame 1 (one per row of a scanned page) count as one.
+  lru_k_replacer.RecordAccess(0);
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.RecordAccess(0);
+  lru_k_replacer.Unpin(0);
+  lru_k_replacer.Unpin(1);
+
+  int value;
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+}
+
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  const std::string db_name = "lru_k_replacer_test.db";
+  const size_t pool_size = 10;
+  const int hot_pages = 5;
+  const int scanned_pages = 50;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(pool_size, disk_manager, ReplacerType::LRU_K_REPLACER);
+  page_id_t page_id;
+  for (int i = 0; i < hot_pages + scanned_pages; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    bpm->UnpinPage(page_id, false);
+  }
+
+  // Scenario: the hot pages are fetched repeatedly, then a scan touches every cold page once.
+  for (int round = 0; round < 3; round++) {
+    for (page_id_t i = 0; i < hot_pages; i++) {
+      ASSERT_NE(nullptr, bpm->FetchPage(i));
+      bpm->UnpinPage(i, false);
+    }
+  }
+  for (page_id_t i = hot_pages; i < hot_pages + scanned_pages; i++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    bpm->UnpinPage(i, false);
+  }
+
+  // Scenario: the scan did not push the hot pages out of the pool.
+  size_t misses = bpm->GetMissCount();
+  for (page_id_t i = 0; i < hot_pages; i++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    bpm->UnpinPage(i, false);
+  }
+  EXPECT_EQ(misses, bpm->GetMissCount());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
@@ -0,0 +1,113 @@
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/page_table.h"
+#include "gtest/gtest.h"
+
+TEST(PageTableTest, SampleTest) {
+  PageTable page_table(4);
+  frame_id_t frame_id;
+
+  // Scenario: insert up to the capacity, further pages are rejected.
+  EXPECT_TRUE(page_table.Insert(10, 0));
+  EXPECT_TRUE(page_table.Insert(11, 1));
+  EXPECT_TRUE(page_table.Insert(12, 2));
+  EXPECT_TRUE(page_table.Insert(13, 3));
+  EXPECT_FALSE(page_table.Insert(14, 0));
+  EXPECT_EQ(4, page_table.Size());
+
+  // Scenario: overwriting an existing page is always allowed.
+  EXPECT_TRUE(page_table.Insert(13, 2));
+  ASSERT_TRUE(page_table.Find(13, &frame_id));
+  EXPECT_EQ(2, frame_id);
+  EXPECT_FALSE(page_table.Find(14, &frame_id));
+
+  // Scenario: erase frees a slot, erasing an unknown page fails.
+  EXPECT_TRUE(page_table.Erase(11));
+  EXPECT_FALSE(page_table.Erase(11));
+  EXPECT_FALSE(page_table.Find(11, &frame_id));
+  EXPECT_TRUE(page_table.Insert(14, 1));
+  ASSERT_TRUE(page_table.Find(10, &frame_id));
+  EXPECT_EQ(0, frame_id);
+  ASSERT_TRUE(page_table.Find(14, &frame_id));
+  EXPECT_EQ(1, frame_id);
+  EXPECT_EQ(4, page_table.Size());
+}
+
+TEST(PageTableTest, RandomTest) {
+  const size_t num_frames = 100;
+  PageTable page_table(num_frames);
+  std::unordered_map<page_id_t, frame_id_t> expected;
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<page_id_t> dist(0, 300);
+
+  // Scenario: random inserts and erases agree with std::unordered_map (erase exercises the backward shift).
+  for (int i = 0; i < 100000; i++) {
+    page_id_t page_id = dist(gen);
+    if (gen() % 2 == 0) {
+      bool inserted = page_table.Insert(page_id, i);
+      EXPECT_EQ(expected.count(page_id) != 0 || expected.size() < num_frames, inserted);
+      if (inserted) {
+        expected[page_id] = i;
+      }
+    } else {
+      EXPECT_EQ(expected.erase(page_id) != 0, page_table.Erase(page_id));
+    }
+    ASSERT_EQ(expected.size(), page_table.Size());
+  }
+  frame_id_t frame_id;
+  for (page_id_t page_id = 0; page_id <= 300; page_id++) {
+    auto iter = expected.find(page_id);
+    ASSERT_EQ(iter != expected.end(), page_table.Find(page_id, &frame_id));
+    if (iter != expected.end()) {
+      EXPECT_EQ(iter->second, frame_id);
+    }
+  }
+}
+
+TEST(PageTableTest, GrowTest) {
+  PageTable page_table(4);
+  frame_id_t frame_id;
+  for (page_id_t page_id = 0; page_id < 4; page_id++) {
+    ASSERT_TRUE(page_table.Insert(page_id, page_id));
+  }
+  EXPECT_FALSE(page_table.Insert(4, 4));
+
+  // Scenario: growing keeps every entry and admits the new frames, shrinking is ignored.
+  page_table.Grow(1000);
+  page_table.Grow(2);
+  for (page_id_t page_id = 4; page_id < 1000; page_id++) {
+    ASSERT_TRUE(page_table.Insert(page_id, page_id));
+  }
+  EXPECT_FALSE(page_table.Insert(1000, 0));
+  EXPECT_EQ(1000, page_table.Size());
+  for (page_id_t page_id = 0; page_id < 1000; page_id++) {
+    ASSERT_TRUE(page_table.Find(page_id, &frame_id));
+    EXPECT_EQ(page_id, frame_id);
+  }
+  EXPECT_TRUE(page_table.Erase(0));
+  EXPECT_FALSE(page_table.Find(0, &frame_id));
+}
+
+TEST(PageTableTest, UnknownPageTest) {
+  const std::string db_name = "page_table_test.db";
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(2, disk_manager);
+
+  // Scenario: unpinning or flushing a page that is not in the pool fails and has no side effect.
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  EXPECT_FALSE(bpm->UnpinPage(page_id + 1, false));
+  EXPECT_FALSE(bpm->FlushPage(page_id + 1));
+  EXPECT_FALSE(bpm->CheckAllUnpinned());
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
@@ -0,0 +1,104 @@
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  const std::string db_name = "parallel_bpm_test.db";
+  const size_t num_instances = 4;
+  const size_t pool_size = 5;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, pool_size, disk_manager);
+  EXPECT_EQ(num_instances * pool_size, bpm->GetPoolSize());
+
+  // Scenario: page ids are handed out in order and every page lands in its own shard.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < num_instances * pool_size; ++i) {
+    auto *page = bpm->NewPage(page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page_id_temp);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+  }
+
+  // Scenario: every shard is full, the next page can not be created and its id is given back.
+  EXPECT_EQ(nullptr, bpm->NewPage(page_id_temp));
+  EXPECT_FALSE(bpm->CheckAllUnpinned());
+
+  // Scenario: unpin everything, new pages now evict (and write back) the old ones.
+  for (size_t i = 0; i < num_instances * pool_size; ++i) {
+    EXPECT_TRUE(bpm->UnpinPage(i, true));
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  for (size_t i = 0; i < num_instances * pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id_temp));
+    EXPECT_EQ(num_instances * pool_size + i, page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+
+  // Scenario: evicted pages come back with their content.
+  char expected[PAGE_SIZE];
+  for (size_t i = 0; i < num_instances * pool_size; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", static_cast<page_id_t>(i));
+    EXPECT_STREQ(expected, page->GetData());
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(ParallelBufferPoolManagerTest, ConcurrentFetchTest) {
+  const std::string db_name = "parallel_bpm_concurrent_test.db";
+  const size_t num_instances = 8;
+  const size_t pool_size = 8;
+  const int num_threads = 8;
+  const int num_pages = 128;  // twice the pool, so threads keep evicting each other's pages
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; i++) {
+    auto *page = bpm->NewPage(page_id_temp);
+    ASSERT_NE(nullptr, page);
+    memcpy(page->GetData(), &page_id_temp, sizeof(page_id_t));
+    bpm->UnpinPage(page_id_temp, true);
+  }
+
+  std::vector<std::thread> threads;
+  std::vector<int> errors(num_threads, 0);
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      for (int round = 0; round < 50; round++) {
+        for (int i = t; i < num_pages; i += num_threads) {
+          auto *page = bpm->FetchPage(i);
+          if (page == nullptr || *reinterpret_cast<page_id_t *>(page->GetData()) != i) {
+            errors[t]++;
+          }
+          if (page != nullptr) {
+            bpm->UnpinPage(i, false);
+          }
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (int t = 0; t < num_threads; t++) {
+    EXPECT_EQ(0, errors[t]);
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
@@ -1,3 +1,5 @@
+#include <sys/stat.h>
+
 #include "catalog/catalog.h"
 #include "common/instance.h"
 #include "gtest/gtest.h"
@@ -135,4 +137,284 @@ TEST(CatalogTest, CatalogIndexTest) {
     ASSERT_EQ(rid.Get(), ret_02[i].Get());
   }
   delete db_02;
-}
\ No newline at end of file
+}
+// Scenario: with file per object a table and its index are kept in files of their own, the database file stays
+// small, everything is found again after a reopen, and dropping the table unlinks both files.
+TEST(CatalogTest, FilePerObjectTest) {
+  const int num_rows = 2000;
+  std::string table_file = db_file_name + "." + std::to_string(DiskManager::TableTablespaceId(0));
+  std::string index_file = db_file_name + "." + std::to_string(DiskManager::IndexTablespaceId(0));
+  std::vector<Column *> columns = {
+          new Column("id", TypeId::kTypeInt, 0, false, false),
+          new Column("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  Schema schema(columns);
+  {
+    DBStorageEngine engine(db_file_name, true, DEFAULT_BUFFER_POOL_SIZE, DEFAULT_BUFFER_POOL_INSTANCES,
+                           DEFAULT_REPLACER_TYPE, 0, DEFAULT_DURABILITY_POLICY, DEFAULT_DISK_IO_MODE, true);
+    TableInfo *table_info = nullptr;
+    IndexInfo *index_info = nullptr;
+    ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->CreateTable("t", &schema, nullptr, table_info, {0}));
+    ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->CreateIndex("t", CatalogManager::AutoGenPKIndexName("t"), {"id"},
+                                                           nullptr, index_info));
+    for (int i = 0; i < num_rows; i++) {
+      std::vector<Field> fields = {
+              Field(TypeId::kTypeInt, i),
+              Field(TypeId::kTypeChar, const_cast<char *>("minisql"), 7, true)
+      };
+      Row row(fields);
+      ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->Insert(table_info, row, nullptr));
+      ASSERT_EQ(1u, engine.disk_mgr_->TablespaceOf(row.GetRowId().GetPageId()));
+    }
+  }
+  struct stat stat_buf;
+  ASSERT_EQ(0, stat(table_file.c_str(), &stat_buf));
+  off_t table_file_size = stat_buf.st_size;
+  ASSERT_EQ(0, stat(index_file.c_str(), &stat_buf));
+  // the database file only holds the catalog
+  ASSERT_EQ(0, stat(db_file_name.c_str(), &stat_buf));
+  EXPECT_LT(stat_buf.st_size, table_file_size);
+  EXPECT_LE(stat_buf.st_size, 8 * PAGE_SIZE);
+
+  // the tablespaces are found by their page ids, file per object off only affects new objects
+  DBStorageEngine engine(db_file_name, false);
+  TableInfo *table_info = nullptr;
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->GetTable("t", table_info));
+  ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->GetIndex("t", CatalogManager::AutoGenPKIndexName("t"), index_info));
+  int rows = 0;
+  for (auto iter = table_info->GetTableHeap()->Begin(nullptr); !iter.isNull(); ++iter) {
+    rows++;
+  }
+  EXPECT_EQ(num_rows, rows);
+  for (int i = 0; i < num_rows; i += 97) {
+    std::vector<Field> key_fields = {Field(TypeId::kTypeInt, i)};
+    Row key(key_fields);
+    std::vector<RowId> result;
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanKey(key, result, nullptr));
+    Row row(result[0]);
+    ASSERT_TRUE(table_info->GetTableHeap()->GetTuple(&row, nullptr));
+    EXPECT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, i)));
+  }
+  ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->DropTable("t"));
+  EXPECT_NE(0, stat(table_file.c_str(), &stat_buf));
+  EXPECT_NE(0, stat(index_file.c_str(), &stat_buf));
+}
+
+TEST(CatalogTest, VacuumTest) {
+  const int num_rows = 2000;
+  std::string table_file = db_file_name + "." + std::to_string(DiskManager::TableTablespaceId(0));
+  std::vector<Column *> columns = {
+          new Column("id", TypeId::kTypeInt, 0, false, false),
+          new Column("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  Schema schema(columns);
+  DBStorageEngine engine(db_file_name, true, DEFAULT_BUFFER_POOL_SIZE, DEFAULT_BUFFER_POOL_INSTANCES,
+                         DEFAULT_REPLACER_TYPE, 0, DEFAULT_DURABILITY_POLICY, DEFAULT_DISK_IO_MODE, true);
+  TableInfo *table_info = nullptr;
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->CreateTable("t", &schema, nullptr, table_info, {0}));
+  ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->CreateIndex("t", CatalogManager::AutoGenPKIndexName("t"), {"id"},
+                                                         nullptr, index_info));
+  std::string name(64, 'x');
+  for (int i = 0; i < num_rows; i++) {
+    std::vector<Field> fields = {
+            Field(TypeId::kTypeInt, i),
+            Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), 64, true)
+    };
+    Row row(fields);
+    ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->Insert(table_info, row, nullptr));
+  }
+  // Scenario: keep every tenth row, spread over all pages of the heap
+  std::vector<Row> deleted;
+  size_t scanned = 0;
+  for (auto iter = table_info->GetTableHeap()->Begin(nullptr); !iter.isNull(); ++iter) {
+    if (scanned++ % 10 != 0) {
+      deleted.push_back(*iter);
+    }
+  }
+  for (auto &row : deleted) {
+    ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->Delete(table_info, row, nullptr));
+  }
+  engine.bpm_->FlushAllPages();
+  struct stat stat_buf;
+  ASSERT_EQ(0, stat(table_file.c_str(), &stat_buf));
+  off_t file_size_before = stat_buf.st_size;
+
+  VacuumStats stats;
+  ASSERT_EQ(DB_TABLE_NOT_EXIST, engine.catalog_mgr_->Vacuum("no_such_table", nullptr, &stats));
+  ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->Vacuum("t", nullptr, &stats));
+  EXPECT_GT(stats.rows_moved_, 0u);
+  EXPECT_LT(stats.pages_after_ * 4, stats.pages_before_);
+  EXPECT_GT(stats.pages_truncated_, 0u);
+  engine.bpm_->FlushAllPages();
+  ASSERT_EQ(0, stat(table_file.c_str(), &stat_buf));
+  EXPECT_LT(stat_buf.st_size, file_size_before);
+
+  // Scenario: the heap holds the remaining rows and the index finds each of them at its new place
+  size_t rows = 0;
+  for (auto iter = table_info->GetTableHeap()->Begin(nullptr); !iter.isNull(); ++iter) {
+    rows++;
+  }
+  EXPECT_EQ(num_rows - deleted.size(), rows);
+  size_t found = 0;
+  for (int i = 0; i < num_rows; i++) {
+    std::vector<Field> key_fields = {Field(TypeId::kTypeInt, i)};
+    Row key(key_fields);
+    std::vector<RowId> result;
+    if (index_info->GetIndex()->ScanKey(key, result, nullptr) != DB_SUCCESS) {
+      continue;
+    }
+    Row row(result[0]);
+    ASSERT_TRUE(table_info->GetTableHeap()->GetTuple(&row, nullptr));
+    EXPECT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, i)));
+    found++;
+  }
+  EXPECT_EQ(rows, found);
+}
+
+TEST(CatalogTest, InsertBatchTest) {
+  const int num_rows = 3000;
+  std::vector<Column *> columns = {
+          new Column("id", TypeId::kTypeInt, 0, false, false),
+          new Column("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  Schema schema(columns);
+  DBStorageEngine engine(db_file_name, true);
+  TableInfo *table_info = nullptr;
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->CreateTable("t", &schema, nullptr, table_info, {0}));
+  ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->CreateIndex("t", CatalogManager::AutoGenPKIndexName("t"), {"id"},
+                                                         nullptr, index_info));
+  std::vector<Field> first_fields = {
+          Field(TypeId::kTypeInt, 7),
+          Field(TypeId::kTypeChar, const_cast<char *>("single"), 6, true)
+  };
+  Row first_row(first_fields);
+  ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->Insert(table_info, first_row, nullptr));
+  // Scenario: keys in descending order, one already in the table and one twice in the batch
+  std::vector<Row> rows;
+  rows.reserve(num_rows + 1);
+  for (int i = num_rows - 1; i >= 0; i--) {
+    std::string name = "name" + std::to_string(i);
+    std::vector<Field> fields = {
+            Field(TypeId::kTypeInt, i),
+            Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)
+    };
+    rows.emplace_back(fields);
+  }
+  std::vector<Field> twice_fields = {
+          Field(TypeId::kTypeInt, 42),
+          Field(TypeId::kTypeChar, const_cast<char *>("twice"), 5, true)
+  };
+  rows.emplace_back(twice_fields);
+  std::vector<dberr_t> results;
+  ASSERT_EQ(DB_PK_DUPLICATE, engine.catalog_mgr_->InsertBatch(table_info, rows, nullptr, &results));
+  ASSERT_EQ(rows.size(), results.size());
+  EXPECT_EQ(DB_PK_DUPLICATE, results[num_rows - 1 - 7]);
+  EXPECT_EQ(DB_PK_DUPLICATE, results[num_rows]);
+  EXPECT_EQ(DB_SUCCESS, results[num_rows - 1 - 42]);
+
+  int count = 0;
+  for (auto iter = table_info->GetTableHeap()->Begin(nullptr); !iter.isNull(); ++iter) {
+    count++;
+  }
+  EXPECT_EQ(num_rows, count);
+  for (int i = 0; i < num_rows; i++) {
+    std::vector<Field> key_fields = {Field(TypeId::kTypeInt, i)};
+    Row key(key_fields);
+    std::vector<RowId> result;
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanKey(key, result, nullptr));
+    Row row(result[0]);
+    ASSERT_TRUE(table_info->GetTableHeap()->GetTuple(&row, nullptr));
+    std::string name = i == 7 ? "single" : "name" + std::to_string(i);
+    Field name_field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true);
+    EXPECT_EQ(CmpBool::kTrue, row.GetField(1)->CompareEquals(name_field));
+  }
+}
+
+TEST(CatalogTest, InsertBatchUniqueKeyTest) {
+  std::vector<Column *> columns = {
+          new Column("id", TypeId::kTypeInt, 0, false, false),
+          new Column("name", TypeId::kTypeChar, 64, 1, true, true)
+  };
+  Schema schema(columns);
+  DBStorageEngine engine(db_file_name, true);
+  TableInfo *table_info = nullptr;
+  IndexInfo *pk_index_info = nullptr;
+  IndexInfo *uni_index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->CreateTable("t", &schema, nullptr, table_info, {0}));
+  ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->CreateIndex("t", CatalogManager::AutoGenPKIndexName("t"), {"id"},
+                                                         nullptr, pk_index_info));
+  ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->CreateIndex("t", CatalogManager::AutoGenUniIndexName("t", "name"),
+                                                         {"name"}, nullptr, uni_index_info));
+  std::vector<Field> taken_fields = {
+          Field(TypeId::kTypeInt, 1),
+          Field(TypeId::kTypeChar, const_cast<char *>("taken"), 5, true)
+  };
+  Row taken_row(taken_fields);
+  ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->Insert(table_info, taken_row, nullptr));
+  // Scenario: two rows share a primary key and the first one conflicts on the unique key. As with one Insert after
+  // the other, the first row is rejected and the second one takes the primary key, and then its unique key.
+  std::vector<std::pair<int, std::string>> values = {{2, "taken"}, {2, "free"}, {3, "free"}, {3, "other"}};
+  std::vector<Row> rows;
+  for (auto &value : values) {
+    std::vector<Field> fields = {
+            Field(TypeId::kTypeInt, value.first),
+            Field(TypeId::kTypeChar, const_cast<char *>(value.second.c_str()), value.second.size(), true)
+    };
+    rows.emplace_back(fields);
+  }
+  std::vector<dberr_t> results;
+  ASSERT_EQ(DB_UNI_KEY_DUPLICATE, engine.catalog_mgr_->InsertBatch(table_info, rows, nullptr, &results));
+  std::vector<dberr_t> expected = {DB_UNI_KEY_DUPLICATE, DB_SUCCESS, DB_UNI_KEY_DUPLICATE, DB_SUCCESS};
+  EXPECT_EQ(expected, results);
+
+  int count = 0;
+  for (auto iter = table_info->GetTableHeap()->Begin(nullptr); !iter.isNull(); ++iter) {
+    count++;
+  }
+  EXPECT_EQ(3, count);
+  std::vector<std::pair<int, std::string>> stored = {{1, "taken"}, {2, "free"}, {3, "other"}};
+  for (auto &value : stored) {
+    std::vector<Field> key_fields = {Field(TypeId::kTypeInt, value.first)};
+    Row key(key_fields);
+    std::vector<RowId> result;
+    ASSERT_EQ(DB_SUCCESS, pk_index_info->GetIndex()->ScanKey(key, result, nullptr));
+    Row row(result[0]);
+    ASSERT_TRUE(table_info->GetTableHeap()->GetTuple(&row, nullptr));
+    Field name_field(TypeId::kTypeChar, const_cast<char *>(value.second.c_str()), value.second.size(), true);
+    EXPECT_EQ(CmpBool::kTrue, row.GetField(1)->CompareEquals(name_field));
+  }
+
+  // Scenario: a row too large for a page does not take its primary key, the next row with the key is inserted.
+  std::vector<Column *> payload_columns = {
+          new Column("id", TypeId::kTypeInt, 0, false, false),
+          new Column("payload", TypeId::kTypeChar, PAGE_SIZE, 1, true, false)
+  };
+  Schema payload_schema(payload_columns);
+  TableInfo *payload_table_info = nullptr;
+  IndexInfo *payload_index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->CreateTable("p", &payload_schema, nullptr, payload_table_info, {0}));
+  ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->CreateIndex("p", CatalogManager::AutoGenPKIndexName("p"), {"id"},
+                                                         nullptr, payload_index_info));
+  std::string large_payload(PAGE_SIZE, 'x');
+  std::vector<std::string> payloads = {large_payload, "small"};
+  std::vector<Row> payload_rows;
+  for (auto &payload : payloads) {
+    std::vector<Field> fields = {
+            Field(TypeId::kTypeInt, 4),
+            Field(TypeId::kTypeChar, const_cast<char *>(payload.c_str()), payload.size(), true)
+    };
+    payload_rows.emplace_back(fields);
+  }
+  ASSERT_EQ(DB_TUPLE_TOO_LARGE,
+            engine.catalog_mgr_->InsertBatch(payload_table_info, payload_rows, nullptr, &results));
+  expected = {DB_TUPLE_TOO_LARGE, DB_SUCCESS};
+  EXPECT_EQ(expected, results);
+  std::vector<Field> key_fields = {Field(TypeId::kTypeInt, 4)};
+  Row key(key_fields);
+  std::vector<RowId> result;
+  ASSERT_EQ(DB_SUCCESS, payload_index_info->GetIndex()->ScanKey(key, result, nullptr));
+  EXPECT_EQ(payload_rows[1].GetRowId().Get(), result[0].Get());
+}
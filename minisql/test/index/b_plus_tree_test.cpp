@@ -60,4 +60,43 @@ TEST(BPlusTreeTests, SampleTest) {
     ASSERT_TRUE(tree.GetValue(delete_seq[i], ans));
     ASSERT_EQ(kv_map[delete_seq[i]], ans[ans.size() - 1]);
   }
-}
\ No newline at end of file
+}
+// Scenario: keys inserted one by one with some removed, then a sorted batch mixing new and present keys, the batch
+// lookup has to agree with GetValue on every key, including ones past the last key of the tree
+TEST(BPlusTreeTests, SortedBatchTest) {
+  DBStorageEngine engine(db_name);
+  BasicComparator<int> comparator;
+  BPlusTree<int, int, BasicComparator<int>> tree(0, engine.bpm_, comparator, 4, 4);
+  const int n = 60;
+  for (int i = 0; i < n; i += 2) {
+    tree.Insert(i, i);
+  }
+  for (int i = 0; i < n; i += 6) {
+    tree.Remove(i);
+  }
+  // every key from 0 to 2n, the even ones below n are there except the ones removed
+  std::vector<std::pair<int, int>> entries;
+  for (int i = 0; i < 2 * n; i++) {
+    entries.emplace_back(i, i);
+  }
+  ASSERT_EQ(2 * n - n / 2 + n / 6, tree.InsertSorted(entries));
+  ASSERT_TRUE(tree.Check());
+  std::vector<int> ans;
+  for (int i = 0; i < 2 * n; i++) {
+    ASSERT_TRUE(tree.GetValue(i, ans));
+    ASSERT_EQ(i, ans.back());
+  }
+  for (int i = 0; i < n; i += 3) {
+    tree.Remove(i);
+  }
+  std::vector<int> keys;
+  for (int i = 0; i < 3 * n; i++) {
+    keys.push_back(i);
+  }
+  std::vector<bool> found;
+  tree.LookupSorted(keys, found);
+  ASSERT_EQ(keys.size(), found.size());
+  for (int i = 0; i < 3 * n; i++) {
+    ASSERT_EQ(tree.GetValue(i, ans), found[i]) << "key " << i;
+  }
+}
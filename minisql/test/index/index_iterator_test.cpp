@@ -33,3 +33,32 @@ TEST(BPlusTreeTests, IndexIteratorTest) {
     EXPECT_EQ(ans * 100, (*iter).second);
   }
 }
+
+TEST(BPlusTreeTests, ReadOnlyIndexScanTest) {
+  DBStorageEngine engine(db_name);
+  BasicComparator<int> comparator;
+  BPlusTree<int, int, BasicComparator<int>> tree(0, engine.bpm_, comparator, 4, 4);
+  for (int i = 1; i <= 50; i++) {
+    tree.Insert(i, i * 100, nullptr);
+  }
+  engine.bpm_->FlushAllPages();
+
+  // Scenario: lookups and iterator scans neither dirty nor leave pinned any page.
+  size_t writes = engine.disk_mgr_->GetNumWrites();
+  vector<int> v;
+  for (int i = 1; i <= 50; i++) {
+    ASSERT_TRUE(tree.GetValue(i, v));
+  }
+  int ans = 1;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter, ans++) {
+    EXPECT_EQ(ans, (*iter).first);
+  }
+  EXPECT_EQ(51, ans);
+  {
+    auto iter = tree.Begin(25);
+    EXPECT_EQ(25, (*iter).first);
+  }
+  EXPECT_TRUE(tree.Check());
+  engine.bpm_->FlushAllPages();
+  EXPECT_EQ(writes, engine.disk_mgr_->GetNumWrites());
+}
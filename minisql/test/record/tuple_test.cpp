@@ -5,6 +5,7 @@
 #include "page/table_page.h"
 #include "record/field.h"
 #include "record/row.h"
+#include "record/row_view.h"
 #include "record/schema.h"
 
 char *chars[] = {
@@ -120,6 +121,47 @@ TEST(TupleTest, RowTest) {
 }
 
 
+// Scenario: views of serialized rows with null fields between the others, the fields asked for out of order
+TEST(TupleTest, RowViewTest) {
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false),
+          ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 2, true, false),
+          ALLOC_COLUMN(heap)("note", TypeId::kTypeChar, 64, 3, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  std::vector<std::vector<Field>> rows_fields = {
+          {Field(TypeId::kTypeInt, 188), Field(TypeId::kTypeChar, chars[1], strlen(chars[1]), false),
+           Field(TypeId::kTypeFloat, 19.99f), Field(TypeId::kTypeChar, chars[2], strlen(chars[2]), false)},
+          {Field(TypeId::kTypeInt, -65537), Field(TypeId::kTypeChar), Field(TypeId::kTypeFloat),
+           Field(TypeId::kTypeChar, chars[0], strlen(chars[0]), false)}
+  };
+  char buffer[2][PAGE_SIZE];
+  RowView view(schema.get());
+  for (size_t r = 0; r < rows_fields.size(); r++) {
+    Row row(rows_fields[r]);
+    row.SerializeTo(buffer[r], schema.get());
+    view.Reset(buffer[r], RowId(1, r));
+    ASSERT_EQ(RowId(1, r), view.GetRowId());
+    ASSERT_EQ(4, view.GetFieldCount());
+    for (int i = 3; i >= 0; i--) {
+      const Field &expected = rows_fields[r][i];
+      ASSERT_EQ(expected.IsNull(), view.IsNull(i));
+      if (expected.IsNull()) {
+        ASSERT_TRUE(view.GetField(i).IsNull());
+      } else {
+        ASSERT_EQ(CmpBool::kTrue, view.GetField(i).CompareEquals(expected));
+      }
+    }
+    Row *decoded = view.ToRow();
+    ASSERT_EQ(RowId(1, r), decoded->GetRowId());
+    ASSERT_EQ(4, decoded->GetFieldCount());
+    ASSERT_EQ(CmpBool::kTrue, decoded->GetField(3)->CompareEquals(rows_fields[r][3]));
+    delete decoded;
+  }
+}
+
 //add some test
 TEST(TupleTest, ColTest) {
   SimpleMemHeap heap;
@@ -1,4 +1,10 @@
+#include <atomic>
+#include <cstddef>
+#include <fstream>
+#include <stdexcept>
+#include <sys/stat.h>
 #include <unordered_set>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "storage/disk_manager.h"
@@ -55,4 +61,476 @@ TEST(DiskManagerTest, FreePageAllocationTest) {
   EXPECT_EQ(DiskManager::BITMAP_SIZE - 2, meta_page->GetExtentUsedPage(0));
   EXPECT_EQ(DiskManager::BITMAP_SIZE - 3, meta_page->GetExtentUsedPage(1));
   remove(db_name.c_str());
-}
\ No newline at end of file
+}
+TEST(DiskManagerTest, MetaPageTest) {
+  std::string db_name = "disk_meta_test.db";
+  remove(db_name.c_str());
+  auto *disk_mgr = new DiskManager(db_name);
+  for (int i = 0; i < 10; i++) {
+    disk_mgr->AllocatePage();
+  }
+  disk_mgr->DeAllocatePage(3);
+  delete disk_mgr;
+
+  // Scenario: the meta page is written back on close and read again on open.
+  disk_mgr = new DiskManager(db_name);
+  auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData());
+  EXPECT_EQ(DISK_FILE_MAGIC_NUM, meta_page->GetMagicNum());
+  EXPECT_EQ(PAGE_SIZE, meta_page->GetPageSize());
+  EXPECT_EQ(9, meta_page->GetAllocatedPages());
+  EXPECT_TRUE(disk_mgr->IsPageFree(3));
+  EXPECT_EQ(3, disk_mgr->AllocatePage());
+  delete disk_mgr;
+
+  // Scenario: a file created with another page size is refused.
+  {
+    std::fstream file(db_name, std::ios::binary | std::ios::in | std::ios::out);
+    uint32_t other_page_size = PAGE_SIZE == 4096 ? 16384 : 4096;
+    file.seekp(offsetof(DiskFileMetaPage, page_size_));
+    file.write(reinterpret_cast<const char *>(&other_page_size), sizeof(uint32_t));
+  }
+  EXPECT_THROW(DiskManager disk_mgr_other(db_name), std::runtime_error);
+
+  // Scenario: so is a file that is not a database.
+  {
+    std::ofstream file(db_name, std::ios::binary | std::ios::trunc);
+    file << "not a database";
+  }
+  EXPECT_THROW(DiskManager disk_mgr_other(db_name), std::runtime_error);
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, PageIOTest) {
+  std::string db_name = "disk_io_test.db";
+  for (auto durability : {DurabilityPolicy::NONE, DurabilityPolicy::SYNC_ON_CHECKPOINT,
+                          DurabilityPolicy::SYNC_EVERY_WRITE}) {
+    remove(db_name.c_str());
+    auto *disk_mgr = new DiskManager(db_name, durability);
+    char data[PAGE_SIZE];
+    char buf[PAGE_SIZE];
+    // Scenario: a page past the end of the file reads as zeros.
+    memset(buf, 'x', PAGE_SIZE);
+    disk_mgr->ReadPage(5, buf);
+    for (int i = 0; i < PAGE_SIZE; i++) {
+      ASSERT_EQ(0, buf[i]);
+    }
+    // Scenario: written pages read back, also when the file grew past them.
+    for (page_id_t page_id = 0; page_id < 10; page_id++) {
+      memset(data, 'a' + page_id, PAGE_SIZE);
+      disk_mgr->WritePage(page_id, data);
+    }
+    for (page_id_t page_id = 0; page_id < 10; page_id++) {
+      disk_mgr->ReadPage(page_id, buf);
+      memset(data, 'a' + page_id, PAGE_SIZE);
+      ASSERT_EQ(0, memcmp(data, buf, PAGE_SIZE));
+    }
+    EXPECT_EQ(10, disk_mgr->GetNumWrites());
+    // Scenario: pages are synced as the durability policy says.
+    size_t syncs = durability == DurabilityPolicy::SYNC_EVERY_WRITE ? 10 : 0;
+    EXPECT_EQ(syncs, disk_mgr->GetNumSyncs());
+    disk_mgr->Checkpoint();
+    syncs += durability == DurabilityPolicy::NONE ? 0 : 1;
+    EXPECT_EQ(syncs, disk_mgr->GetNumSyncs());
+    delete disk_mgr;
+
+    // Scenario: the pages are there after reopening the file.
+    disk_mgr = new DiskManager(db_name, durability);
+    disk_mgr->ReadPage(7, buf);
+    memset(data, 'a' + 7, PAGE_SIZE);
+    EXPECT_EQ(0, memcmp(data, buf, PAGE_SIZE));
+    delete disk_mgr;
+  }
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, AsyncPageIOTest) {
+  std::string db_name = "disk_async_io_test.db";
+  const int num_pages = 200;
+  for (bool use_io_uring : {true, false}) {
+    remove(db_name.c_str());
+    auto *disk_mgr = new DiskManager(db_name);
+    // a small queue, so submitting has to wait for room
+    disk_mgr->ConfigureAsyncIO(8, use_io_uring);
+    if (!use_io_uring) {
+      EXPECT_EQ(AsyncIO::Backend::THREAD_POOL, disk_mgr->GetAsyncIOBackend());
+    }
+    std::vector<char> data(num_pages * PAGE_SIZE);
+    std::vector<char> buf(num_pages * PAGE_SIZE, 'x');
+    for (int i = 0; i < num_pages; i++) {
+      memset(data.data() + i * PAGE_SIZE, 'a' + i % 26, PAGE_SIZE);
+    }
+    // Scenario: a page past the end of the file reads as zeros, right away.
+    bool done = false;
+    disk_mgr->ReadPageAsync(num_pages, buf.data(), [&done](bool ok) { done = ok; });
+    EXPECT_TRUE(done);
+    EXPECT_EQ(0, buf[0]);
+
+    // Scenario: a batch of writes, more than the queue depth, then a batch of reads.
+    IOWaitGroup writes;
+    std::atomic<int> failed{0};
+    writes.Add(num_pages);
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      disk_mgr->WritePageAsync(page_id, data.data() + page_id * PAGE_SIZE, [&](bool ok) {
+        failed += ok ? 0 : 1;
+        writes.Done();
+      });
+    }
+    EXPECT_EQ(num_pages, disk_mgr->SubmitBatch());
+    writes.Wait();
+    EXPECT_EQ(0, failed);
+    EXPECT_EQ(num_pages, disk_mgr->GetNumWrites());
+    IOWaitGroup reads;
+    reads.Add(num_pages);
+    for (page_id_t page_id = num_pages - 1; page_id >= 0; page_id--) {
+      disk_mgr->ReadPageAsync(page_id, buf.data() + page_id * PAGE_SIZE, [&](bool ok) {
+        failed += ok ? 0 : 1;
+        reads.Done();
+      });
+    }
+    disk_mgr->SubmitBatch();
+    reads.Wait();
+    EXPECT_EQ(0, failed);
+    EXPECT_EQ(0, memcmp(data.data(), buf.data(), num_pages * PAGE_SIZE));
+
+    // Scenario: queued writes not submitted yet are written on close.
+    memset(data.data(), 'z', PAGE_SIZE);
+    disk_mgr->WritePageAsync(0, data.data(), [](bool) {});
+    delete disk_mgr;
+    disk_mgr = new DiskManager(db_name);
+    disk_mgr->ReadPage(0, buf.data());
+    EXPECT_EQ(0, memcmp(data.data(), buf.data(), PAGE_SIZE));
+    delete disk_mgr;
+  }
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, MmapTest) {
+  std::string db_name = "disk_mmap_test.db";
+  remove(db_name.c_str());
+  char data[PAGE_SIZE];
+  char buf[PAGE_SIZE];
+  auto *disk_mgr = new DiskManager(db_name);
+  for (page_id_t page_id = 0; page_id < 10; page_id++) {
+    memset(data, 'a' + page_id, PAGE_SIZE);
+    disk_mgr->WritePage(page_id, data);
+  }
+  delete disk_mgr;
+
+  disk_mgr = new DiskManager(db_name, DEFAULT_DURABILITY_POLICY, DiskIOMode::MMAP);
+  ASSERT_EQ(DiskIOMode::MMAP, disk_mgr->GetIOMode());
+  // Scenario: pages written before the file was mapped are copied out of the mapping.
+  for (page_id_t page_id = 0; page_id < 10; page_id++) {
+    disk_mgr->ReadPage(page_id, buf);
+    memset(data, 'a' + page_id, PAGE_SIZE);
+    ASSERT_EQ(0, memcmp(data, buf, PAGE_SIZE));
+  }
+  // Scenario: so are pages rewritten, or appended past the old end of the file, afterwards.
+  memset(data, 'y', PAGE_SIZE);
+  disk_mgr->WritePage(3, data);
+  disk_mgr->ReadPage(3, buf);
+  EXPECT_EQ(0, memcmp(data, buf, PAGE_SIZE));
+  memset(data, 'z', PAGE_SIZE);
+  disk_mgr->WritePage(20, data);
+  disk_mgr->ReadPage(20, buf);
+  EXPECT_EQ(0, memcmp(data, buf, PAGE_SIZE));
+  bool read_ok = false;
+  memset(buf, 0, PAGE_SIZE);
+  disk_mgr->ReadPageAsync(20, buf, [&read_ok](bool ok) { read_ok = ok; });
+  disk_mgr->SubmitBatch();
+  EXPECT_TRUE(read_ok);
+  EXPECT_EQ(0, memcmp(data, buf, PAGE_SIZE));
+  // Scenario: a page past the end of the file reads as zeros, the mapping is not touched there.
+  memset(buf, 'x', PAGE_SIZE);
+  disk_mgr->ReadPage(100, buf);
+  EXPECT_EQ(0, buf[0]);
+  EXPECT_EQ(0, buf[PAGE_SIZE - 1]);
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, BitmapCacheTest) {
+  std::string db_name = "disk_bitmap_test.db";
+  remove(db_name.c_str());
+  auto file_size = [&db_name]() {
+    struct stat stat_buf;
+    return stat(db_name.c_str(), &stat_buf) == 0 ? stat_buf.st_size : -1;
+  };
+  auto *disk_mgr = new DiskManager(db_name);
+  // Scenario: allocating a page does not touch the file, the bitmap is written by the checkpoint.
+  for (uint32_t i = 0; i < DiskManager::BITMAP_SIZE + 10; i++) {
+    ASSERT_EQ(i, disk_mgr->AllocatePage());
+  }
+  EXPECT_EQ(PAGE_SIZE, file_size());
+  disk_mgr->Checkpoint();
+  EXPECT_LT(PAGE_SIZE, file_size());
+
+  // Scenario: a page freed in a full extent is the next one allocated, then allocation goes on after the others.
+  disk_mgr->DeAllocatePage(100);
+  disk_mgr->DeAllocatePage(100);
+  EXPECT_TRUE(disk_mgr->IsPageFree(100));
+  EXPECT_EQ(100, disk_mgr->AllocatePage());
+  EXPECT_EQ(DiskManager::BITMAP_SIZE + 10, disk_mgr->AllocatePage());
+  auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData());
+  EXPECT_EQ(DiskManager::BITMAP_SIZE + 11, meta_page->GetAllocatedPages());
+  EXPECT_TRUE(disk_mgr->IsPageFree(5 * DiskManager::BITMAP_SIZE));
+  disk_mgr->DeAllocatePage(DiskManager::BITMAP_SIZE + 3);
+  delete disk_mgr;
+
+  // Scenario: the bitmaps changed after the checkpoint are written on close.
+  disk_mgr = new DiskManager(db_name);
+  EXPECT_FALSE(disk_mgr->IsPageFree(100));
+  EXPECT_TRUE(disk_mgr->IsPageFree(DiskManager::BITMAP_SIZE + 3));
+  EXPECT_FALSE(disk_mgr->IsPageFree(DiskManager::BITMAP_SIZE + 4));
+  EXPECT_EQ(DiskManager::BITMAP_SIZE + 3, disk_mgr->AllocatePage());
+  EXPECT_EQ(DiskManager::BITMAP_SIZE + 11, disk_mgr->AllocatePage());
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, PageRunTest) {
+  std::string db_name = "disk_page_run_test.db";
+  remove(db_name.c_str());
+  auto *disk_mgr = new DiskManager(db_name);
+  int table_a = 0;
+  int table_b = 0;
+  // Scenario: two objects growing at the same time each get their own run of contiguous pages.
+  for (page_id_t i = 0; i < PAGE_RUN_MIN_SIZE; i++) {
+    EXPECT_EQ(i, disk_mgr->AllocatePage(&table_a));
+    EXPECT_EQ(PAGE_RUN_MIN_SIZE + i, disk_mgr->AllocatePage(&table_b));
+  }
+
+  // Scenario: the next runs are twice as long, each as close behind the previous run of its object as possible.
+  EXPECT_EQ(2 * PAGE_RUN_MIN_SIZE, disk_mgr->AllocatePage(&table_a));
+  EXPECT_EQ(4 * PAGE_RUN_MIN_SIZE, disk_mgr->AllocatePage(&table_b));
+  EXPECT_EQ(2 * PAGE_RUN_MIN_SIZE + 1, disk_mgr->AllocatePage(&table_a));
+  EXPECT_FALSE(disk_mgr->IsPageFree(4 * PAGE_RUN_MIN_SIZE - 1));
+  EXPECT_EQ(6 * PAGE_RUN_MIN_SIZE, disk_mgr->AllocatePage());
+
+  // Scenario: a run never takes a hole too small for it.
+  disk_mgr->DeAllocatePage(3);
+  page_id_t run = disk_mgr->AllocateRun(2);
+  EXPECT_EQ(6 * PAGE_RUN_MIN_SIZE + 1, run);
+  EXPECT_FALSE(disk_mgr->IsPageFree(run + 1));
+  EXPECT_EQ(3, disk_mgr->AllocatePage());
+  EXPECT_EQ(INVALID_PAGE_ID, disk_mgr->AllocateRun(0));
+  EXPECT_EQ(INVALID_PAGE_ID, disk_mgr->AllocateRun(DiskManager::BITMAP_SIZE + 1));
+  EXPECT_EQ(DiskManager::BITMAP_SIZE, disk_mgr->AllocateRun(DiskManager::BITMAP_SIZE));
+
+  // Scenario: the unused part of a released run is free again.
+  disk_mgr->ReleasePages(&table_b);
+  EXPECT_FALSE(disk_mgr->IsPageFree(4 * PAGE_RUN_MIN_SIZE));
+  EXPECT_TRUE(disk_mgr->IsPageFree(4 * PAGE_RUN_MIN_SIZE + 1));
+  EXPECT_EQ(4 * PAGE_RUN_MIN_SIZE + 1, disk_mgr->AllocateRun(2 * PAGE_RUN_MIN_SIZE - 1));
+  auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData());
+  uint32_t allocated = meta_page->GetAllocatedPages();
+  delete disk_mgr;
+
+  // Scenario: so is the unused part of every run once the file is closed.
+  disk_mgr = new DiskManager(db_name);
+  meta_page = reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData());
+  EXPECT_EQ(allocated - (2 * PAGE_RUN_MIN_SIZE - 2), meta_page->GetAllocatedPages());
+  EXPECT_FALSE(disk_mgr->IsPageFree(2 * PAGE_RUN_MIN_SIZE + 1));
+  EXPECT_TRUE(disk_mgr->IsPageFree(2 * PAGE_RUN_MIN_SIZE + 2));
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, WritePagesTest) {
+  std::string db_name = "disk_write_pages_test.db";
+  remove(db_name.c_str());
+  auto *disk_mgr = new DiskManager(db_name, DurabilityPolicy::SYNC_EVERY_WRITE);
+  // Scenario: a batch out of order, with runs of neighbouring pages, one crossing the bitmap page of an extent.
+  std::vector<page_id_t> page_ids = {7, 3, 4, 5, static_cast<page_id_t>(DiskManager::BITMAP_SIZE), 0,
+                                     static_cast<page_id_t>(DiskManager::BITMAP_SIZE) - 1};
+  std::vector<std::vector<char>> data(page_ids.size(), std::vector<char>(PAGE_SIZE));
+  std::vector<std::pair<page_id_t, const char *>> pages;
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    snprintf(data[i].data(), PAGE_SIZE, "page %d", page_ids[i]);
+    data[i][PAGE_SIZE - 1] = static_cast<char>(i + 1);
+    pages.emplace_back(page_ids[i], data[i].data());
+  }
+  size_t syncs = disk_mgr->GetNumSyncs();
+  disk_mgr->WritePages(pages);
+  EXPECT_EQ(page_ids.size(), disk_mgr->GetNumWrites());
+  EXPECT_EQ(syncs + 1, disk_mgr->GetNumSyncs());
+  char buf[PAGE_SIZE];
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    disk_mgr->ReadPage(page_ids[i], buf);
+    EXPECT_EQ(0, memcmp(buf, data[i].data(), PAGE_SIZE));
+  }
+  // Scenario: the pages in between are untouched.
+  disk_mgr->ReadPage(6, buf);
+  EXPECT_EQ(0, buf[0]);
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, DirectIOTest) {
+  std::string db_name = "disk_direct_io_test.db";
+  remove(db_name.c_str());
+  auto *disk_mgr = new DiskManager(db_name, DEFAULT_DURABILITY_POLICY, DiskIOMode::DIRECT);
+  // the file system of the test may not support O_DIRECT, the pages are the same either way
+  EXPECT_NE(DiskIOMode::MMAP, disk_mgr->GetIOMode());
+  auto aligned = DiskManager::AllocatePageBuffer(2);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(aligned.get()) % DIRECT_IO_ALIGNMENT);
+  std::vector<char> unaligned(PAGE_SIZE + 1);
+  char *unaligned_page = unaligned.data() + 1;
+
+  // Scenario: pages written from aligned and from unaligned memory, one at a time and in a batch.
+  snprintf(aligned.get(), PAGE_SIZE, "aligned");
+  snprintf(unaligned_page, PAGE_SIZE, "unaligned");
+  snprintf(aligned.get() + PAGE_SIZE, PAGE_SIZE, "batched");
+  disk_mgr->WritePage(0, aligned.get());
+  disk_mgr->WritePage(1, unaligned_page);
+  std::vector<std::pair<page_id_t, const char *>> pages = {
+          {3, aligned.get() + PAGE_SIZE}, {2, unaligned_page}, {4, aligned.get()}};
+  disk_mgr->WritePages(pages);
+  IOWaitGroup writes;
+  writes.Add();
+  disk_mgr->WritePageAsync(5, unaligned_page, [&writes](bool) { writes.Done(); });
+  disk_mgr->SubmitBatch();
+  writes.Wait();
+  EXPECT_EQ(0, disk_mgr->AllocatePage());
+
+  // Scenario: they read back into aligned and into unaligned memory.
+  const char *expected[] = {"aligned", "unaligned", "unaligned", "batched", "aligned", "unaligned"};
+  for (page_id_t page_id = 0; page_id < 6; page_id++) {
+    disk_mgr->ReadPage(page_id, aligned.get());
+    EXPECT_STREQ(expected[page_id], aligned.get());
+    IOWaitGroup reads;
+    reads.Add();
+    disk_mgr->ReadPageAsync(page_id, unaligned_page, [&reads](bool) { reads.Done(); });
+    disk_mgr->SubmitBatch();
+    reads.Wait();
+    EXPECT_STREQ(expected[page_id], unaligned_page);
+  }
+  delete disk_mgr;
+
+  // Scenario: the meta page and the bitmap pages are on disk for a reader without O_DIRECT.
+  disk_mgr = new DiskManager(db_name);
+  EXPECT_FALSE(disk_mgr->IsPageFree(0));
+  char buf[PAGE_SIZE];
+  disk_mgr->ReadPage(3, buf);
+  EXPECT_STREQ("batched", buf);
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, LargeFileTest) {
+  std::string db_name = "disk_large_file_test.db";
+  remove(db_name.c_str());
+  auto *disk_mgr = new DiskManager(db_name, DurabilityPolicy::NONE);
+  auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData());
+  // Scenario: pages past the 2 GB and the 4 GB offset of a sparse file are written and read back.
+  const std::vector<page_id_t> page_ids = {static_cast<page_id_t>((2LL << 30) / PAGE_SIZE),
+                                           static_cast<page_id_t>((4LL << 30) / PAGE_SIZE),
+                                           static_cast<page_id_t>((5LL << 30) / PAGE_SIZE)};
+  for (page_id_t i = 0; i <= page_ids.back(); i++) {
+    ASSERT_EQ(i, disk_mgr->AllocatePage());
+  }
+  char buf[PAGE_SIZE];
+  for (auto page_id : page_ids) {
+    memset(buf, 0, PAGE_SIZE);
+    snprintf(buf, PAGE_SIZE, "page %d", page_id);
+    disk_mgr->WritePage(page_id, buf);
+  }
+  disk_mgr->Checkpoint();
+  struct stat stat_buf;
+  ASSERT_EQ(0, stat(db_name.c_str(), &stat_buf));
+  EXPECT_GT(stat_buf.st_size, 5LL << 30);
+  EXPECT_LT(stat_buf.st_blocks * 512, 64LL << 20);
+
+  // Scenario: the used page counts of the extents past the meta page go to an overflow meta page, taken from the
+  // extent whose count fills the meta page.
+  EXPECT_EQ(0, meta_page->GetNextMetaPageId());
+  while (meta_page->GetExtentNums() < DiskFileMetaPage::EXTENTS_PER_META_PAGE + 2) {
+    ASSERT_NE(INVALID_PAGE_ID, disk_mgr->AllocatePage());
+  }
+  page_id_t overflow_page_id = (DiskFileMetaPage::EXTENTS_PER_META_PAGE - 1) * DiskManager::BITMAP_SIZE;
+  EXPECT_EQ(overflow_page_id, meta_page->GetNextMetaPageId());
+  page_id_t last_page_id = disk_mgr->AllocatePage();
+  EXPECT_EQ(static_cast<page_id_t>(meta_page->GetAllocatedPages()), last_page_id + 1);
+  disk_mgr->DeAllocatePage(last_page_id - 1);
+  delete disk_mgr;
+
+  // Scenario: the chain is read back, allocation goes on from the counts in the overflow meta page.
+  disk_mgr = new DiskManager(db_name, DurabilityPolicy::NONE);
+  meta_page = reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData());
+  EXPECT_EQ(DiskFileMetaPage::EXTENTS_PER_META_PAGE + 2, meta_page->GetExtentNums());
+  EXPECT_FALSE(disk_mgr->IsPageFree(overflow_page_id));
+  for (auto page_id : page_ids) {
+    disk_mgr->ReadPage(page_id, buf);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(buf));
+  }
+  EXPECT_EQ(last_page_id - 1, disk_mgr->AllocatePage());
+  EXPECT_EQ(last_page_id + 1, disk_mgr->AllocatePage());
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, RemoveFilesTest) {
+  std::string db_name = "disk_remove_files_test.db";
+  const std::vector<std::string> removed = {db_name, db_name + ".1", db_name + ".4096"};
+  const std::vector<std::string> kept = {db_name + ".1.bak", db_name + ".tmp", "disk_remove_files_test.db2.1"};
+  for (auto &file : removed) {
+    std::ofstream(file) << "page";
+  }
+  for (auto &file : kept) {
+    std::ofstream(file) << "page";
+  }
+  // Scenario: the database file goes with every tablespace file next to it, whatever its number, other files stay.
+  DiskManager::RemoveFiles(db_name);
+  struct stat stat_buf;
+  for (auto &file : removed) {
+    EXPECT_NE(0, stat(file.c_str(), &stat_buf)) << file;
+  }
+  for (auto &file : kept) {
+    EXPECT_EQ(0, stat(file.c_str(), &stat_buf)) << file;
+    remove(file.c_str());
+  }
+}
+
+TEST(DiskManagerTest, TablespaceSegmentTest) {
+  std::string db_name = "disk_tablespace_segment_test.db";
+  DiskManager::RemoveFiles(db_name);
+  int first_owner = 0;
+  int second_owner = 0;
+  int third_owner = 0;
+  auto *disk_mgr = new DiskManager(db_name, DurabilityPolicy::NONE);
+  disk_mgr->SetFilePerObject(true);
+  // Scenario: tablespace ids are not limited by the bits of a page id, every tablespace gets a segment of its own.
+  disk_mgr->CreateTablespace(&first_owner, 5000);
+  disk_mgr->CreateTablespace(&second_owner, 7);
+  page_id_t first_page_id = disk_mgr->AllocatePage(&first_owner);
+  page_id_t second_page_id = disk_mgr->AllocatePage(&second_owner);
+  ASSERT_TRUE(DiskManager::IsTablespacePage(first_page_id));
+  ASSERT_TRUE(DiskManager::IsTablespacePage(second_page_id));
+  EXPECT_EQ(5000u, disk_mgr->TablespaceOf(first_page_id));
+  EXPECT_EQ(7u, disk_mgr->TablespaceOf(second_page_id));
+  EXPECT_NE(first_page_id >> TABLESPACE_PAGE_BITS, second_page_id >> TABLESPACE_PAGE_BITS);
+  char buf[PAGE_SIZE];
+  memset(buf, 0, PAGE_SIZE);
+  snprintf(buf, PAGE_SIZE, "tablespace 5000");
+  disk_mgr->WritePage(first_page_id, buf);
+  delete disk_mgr;
+
+  // Scenario: the segment map is read back on open, the pages are found again by their page ids.
+  disk_mgr = new DiskManager(db_name, DurabilityPolicy::NONE);
+  EXPECT_EQ(5000u, disk_mgr->TablespaceOf(first_page_id));
+  EXPECT_EQ(7u, disk_mgr->TablespaceOf(second_page_id));
+  EXPECT_FALSE(disk_mgr->IsPageFree(first_page_id));
+  disk_mgr->ReadPage(first_page_id, buf);
+  EXPECT_EQ("tablespace 5000", std::string(buf));
+
+  // Scenario: the segment of a dropped tablespace goes to the next tablespace growing.
+  disk_mgr->DropTablespace(5000);
+  EXPECT_EQ(0u, disk_mgr->TablespaceOf(first_page_id));
+  EXPECT_TRUE(disk_mgr->IsPageFree(first_page_id));
+  disk_mgr->SetFilePerObject(true);
+  disk_mgr->CreateTablespace(&third_owner, 9);
+  page_id_t third_page_id = disk_mgr->AllocatePage(&third_owner);
+  EXPECT_EQ(first_page_id >> TABLESPACE_PAGE_BITS, third_page_id >> TABLESPACE_PAGE_BITS);
+  EXPECT_EQ(9u, disk_mgr->TablespaceOf(third_page_id));
+  delete disk_mgr;
+  DiskManager::RemoveFiles(db_name);
+}
@@ -1,3 +1,8 @@
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
 #include <unordered_map>
 
@@ -55,3 +60,384 @@ TEST(TableHeapTest, TableHeapSampleTest) {
   }
 }
 
+TEST(TableHeapTest, ReadOnlyScanTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 1000;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  std::vector<RowId> rids;
+  std::string characters = "read only";
+  characters.resize(64);
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{
+            Field(TypeId::kTypeInt, i),
+            Field(TypeId::kTypeChar, characters.data(), 64, true)
+    };
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+  }
+  engine.bpm_->FlushAllPages();
+  EXPECT_TRUE(engine.bpm_->CheckAllUnpinned());
+
+  // Scenario: point reads and a full scan neither dirty nor leave pinned any page.
+  size_t writes = engine.disk_mgr_->GetNumWrites();
+  for (auto &rid : rids) {
+    Row row(rid);
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+  }
+  int count = 0;
+  for (auto iter = table_heap->Begin(nullptr); !iter.isNull(); ++iter) {
+    ASSERT_EQ(rids[count], iter->GetRowId());
+    count++;
+  }
+  ASSERT_EQ(row_nums, count);
+  EXPECT_TRUE(engine.bpm_->CheckAllUnpinned());
+  engine.bpm_->FlushAllPages();
+  EXPECT_EQ(writes, engine.disk_mgr_->GetNumWrites());
+}
+
+// Scenario: a scan in place visits each tuple left after deletes once, with the fields it was inserted with
+TEST(TableHeapTest, ScanTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 1000;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  std::unordered_map<int64_t, std::pair<int, std::string>> rows;
+  for (int i = 0; i < row_nums; i++) {
+    std::string name = "name" + std::to_string(i);
+    Fields fields{
+            Field(TypeId::kTypeInt, i),
+            i % 7 == 0 ? Field(TypeId::kTypeChar) :
+            Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)
+    };
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    if (i % 3 == 0) {
+      ASSERT_TRUE(table_heap->MarkDelete(row.GetRowId(), nullptr));
+      table_heap->ApplyDelete(row.GetRowId(), nullptr);
+    } else {
+      rows[row.GetRowId().Get()] = {i, i % 7 == 0 ? "NULL" : name};
+    }
+  }
+  size_t visited = 0;
+  table_heap->Scan([&](const RowView &row) {
+    auto iter = rows.find(row.GetRowId().Get());
+    ASSERT_NE(rows.end(), iter);
+    ASSERT_EQ(CmpBool::kTrue, row.GetField(0).CompareEquals(Field(TypeId::kTypeInt, iter->second.first)));
+    ASSERT_EQ(iter->second.second, row.GetField(1).ToString());
+    rows.erase(iter);
+    visited++;
+  }, nullptr);
+  ASSERT_TRUE(rows.empty());
+  ASSERT_EQ(static_cast<size_t>(row_nums - (row_nums + 2) / 3), visited);
+}
+
+// pin every frame of the pool with new pages, a page not in the pool can not be fetched any more
+static std::vector<page_id_t> PinAllFrames(BufferPoolManager *bpm) {
+  std::vector<page_id_t> page_ids;
+  page_id_t page_id;
+  // the frames the background writer is writing back are not evictable until it is done
+  for (int retries = 0; page_ids.size() < bpm->GetPoolSize() && retries < 1000;) {
+    if (bpm->NewPage(page_id) != nullptr) {
+      page_ids.push_back(page_id);
+    } else {
+      retries++;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  return page_ids;
+}
+
+// Scenario: a page scan takes one pin per page, skips the pages emptied by deletes, and yields the tuples of each
+// page in the order of the iterator, which takes one pin per row
+TEST(TableHeapTest, PageScanTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 1000;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  table_heap->SetPrefetchDistance(0);
+  char characters[64] = "page scan";
+  std::vector<RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{
+            Field(TypeId::kTypeInt, i),
+            Field(TypeId::kTypeChar, characters, 64, true)
+    };
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+  }
+  // empty the second page
+  page_id_t emptied = rids[0].GetPageId();
+  for (auto &rid : rids) {
+    if (rid.GetPageId() != rids[0].GetPageId()) {
+      emptied = rid.GetPageId();
+      break;
+    }
+  }
+  std::vector<RowId> left;
+  for (auto &rid : rids) {
+    if (rid.GetPageId() == emptied) {
+      ASSERT_TRUE(table_heap->MarkDelete(rid, nullptr));
+      table_heap->ApplyDelete(rid, nullptr);
+    } else {
+      left.push_back(rid);
+    }
+  }
+  size_t pages = 0;
+  for (page_id_t page_id = table_heap->GetFirstPageId(); page_id != INVALID_PAGE_ID; pages++) {
+    ReadPageGuard guard = engine.bpm_->FetchPageRead(page_id);
+    page_id = TablePage::NextPageIdOf(guard.GetData());
+  }
+
+  size_t fetches = engine.bpm_->GetHitCount() + engine.bpm_->GetMissCount();
+  TableHeap::PageScan scan(table_heap, nullptr);
+  size_t count = 0;
+  size_t batches = 0;
+  while (scan.Next()) {
+    ASSERT_NE(emptied, scan.GetPageId());
+    ASSERT_LT(0, scan.GetTupleCount());
+    for (size_t i = 0; i < scan.GetTupleCount(); i++) {
+      ASSERT_EQ(left[count], scan.GetRowIds()[i]);
+      ASSERT_EQ(left[count], scan.GetView(i).GetRowId());
+      if (i == 0) {
+        Row *row = scan.GetRow(i);
+        ASSERT_EQ(left[count], row->GetRowId());
+        ASSERT_EQ(CmpBool::kTrue, row->GetField(1)->CompareEquals(Field(TypeId::kTypeChar, characters, 64, false)));
+        delete row;
+      }
+      count++;
+    }
+    batches++;
+  }
+  ASSERT_EQ(left.size(), count);
+  ASSERT_EQ(pages - 1, batches);
+  EXPECT_EQ(pages, engine.bpm_->GetHitCount() + engine.bpm_->GetMissCount() - fetches);
+  EXPECT_TRUE(engine.bpm_->CheckAllUnpinned());
+
+  fetches = engine.bpm_->GetHitCount() + engine.bpm_->GetMissCount();
+  count = 0;
+  for (auto iter = table_heap->Begin(nullptr); !iter.isNull(); ++iter) {
+    ASSERT_EQ(left[count], iter->GetRowId());
+    count++;
+  }
+  ASSERT_EQ(left.size(), count);
+  EXPECT_EQ(left.size() + pages, engine.bpm_->GetHitCount() + engine.bpm_->GetMissCount() - fetches);
+
+  // Scenario: with every frame pinned the pages of the heap can not be fetched, the scan stops and says so
+  std::vector<page_id_t> pinned = PinAllFrames(engine.bpm_);
+  ASSERT_EQ(engine.bpm_->GetPoolSize(), pinned.size());
+  TableHeap::PageScan failed_scan(table_heap, nullptr);
+  EXPECT_FALSE(failed_scan.Next());
+  EXPECT_TRUE(failed_scan.IsFailed());
+  EXPECT_FALSE(table_heap->Scan([](const RowView &) {}, nullptr));
+  for (page_id_t page_id : pinned) {
+    engine.bpm_->UnpinPage(page_id, false);
+  }
+  count = 0;
+  EXPECT_TRUE(table_heap->Scan([&](const RowView &) { count++; }, nullptr));
+  EXPECT_EQ(left.size(), count);
+}
+
+TEST(TableHeapTest, FreeSpaceMapTest) {
+  SimpleMemHeap heap;
+  const int row_nums = 3000;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  std::string characters = "free space map";
+  characters.resize(64);
+  std::vector<RowId> rids;
+  page_id_t first_page_id;
+  {
+    DBStorageEngine engine(db_file_name);
+    TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+    first_page_id = table_heap->GetFirstPageId();
+    for (int i = 0; i < row_nums; i++) {
+      Fields fields{
+              Field(TypeId::kTypeInt, i),
+              Field(TypeId::kTypeChar, characters.data(), 64, true)
+      };
+      Row row(fields);
+      ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+      rids.push_back(row.GetRowId());
+    }
+    // Scenario: rows deleted in the middle of the heap make room for new rows there.
+    for (int i = row_nums / 2; i < row_nums / 2 + 10; i++) {
+      ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+      table_heap->ApplyDelete(rids[i], nullptr);
+    }
+  }
+  // Scenario: the map is persistent, a reopened heap finds the room without walking the page chain.
+  DBStorageEngine engine(db_file_name, false);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, first_page_id, schema.get(), nullptr, nullptr, &heap);
+  table_heap->SetPrefetchDistance(0);
+  size_t misses = engine.bpm_->GetMissCount();
+  for (int i = row_nums / 2; i < row_nums / 2 + 10; i++) {
+    Fields fields{
+            Field(TypeId::kTypeInt, row_nums + i),
+            Field(TypeId::kTypeChar, characters.data(), 64, true)
+    };
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    EXPECT_EQ(rids[i].GetPageId(), row.GetRowId().GetPageId());
+  }
+  misses = engine.bpm_->GetMissCount() - misses;
+  size_t pages = 0;
+  for (page_id_t page_id = first_page_id; page_id != INVALID_PAGE_ID; pages++) {
+    ReadPageGuard guard = engine.bpm_->FetchPageRead(page_id);
+    page_id = TablePage::NextPageIdOf(guard.GetData());
+  }
+  EXPECT_LT(misses, pages / 4);
+  // Scenario: an update growing out of its page moves to a page with room.
+  std::string longer = "a longer name, which needs more space than the name before";
+  longer.resize(64);
+  Fields fields{
+          Field(TypeId::kTypeInt, 0),
+          Field(TypeId::kTypeChar, longer.data(), 64, true)
+  };
+  Row row(fields);
+  for (int i = row_nums - 1; i >= row_nums - 50; i--) {
+    ASSERT_TRUE(table_heap->UpdateTuple(row, rids[i], nullptr));
+  }
+  int count = 0;
+  for (auto iter = table_heap->Begin(nullptr); !iter.isNull(); ++iter) {
+    count++;
+  }
+  EXPECT_EQ(row_nums, count);
+  size_t pages_after = 0;
+  for (page_id_t page_id = first_page_id; page_id != INVALID_PAGE_ID; pages_after++) {
+    ReadPageGuard guard = engine.bpm_->FetchPageRead(page_id);
+    page_id = TablePage::NextPageIdOf(guard.GetData());
+  }
+  EXPECT_LE(pages_after, pages + 2);
+}
+
+static std::vector<page_id_t> PageChain(BufferPoolManager *bpm, page_id_t first_page_id) {
+  std::vector<page_id_t> page_ids;
+  for (page_id_t page_id = first_page_id; page_id != INVALID_PAGE_ID;) {
+    page_ids.push_back(page_id);
+    ReadPageGuard guard = bpm->FetchPageRead(page_id);
+    page_id = TablePage::NextPageIdOf(guard.GetData());
+  }
+  return page_ids;
+}
+
+// Scenario: the page directory follows the page chain through appends, vacuum and a reopen, and a parallel scan
+// splits it between its workers so that each tuple is visited once, in the order of the chain worker after worker
+TEST(TableHeapTest, ParallelScanTest) {
+  SimpleMemHeap heap;
+  const size_t num_workers = 4;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  std::string characters = "parallel scan";
+  characters.resize(64);
+  page_id_t first_page_id;
+  size_t row_nums = 0;
+  {
+    DBStorageEngine engine(db_file_name);
+    TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+    first_page_id = table_heap->GetFirstPageId();
+    std::vector<RowId> rids;
+    while (table_heap->GetPageIds().size() < num_workers * PARALLEL_SCAN_MIN_PAGES) {
+      Fields fields{
+              Field(TypeId::kTypeInt, static_cast<int32_t>(row_nums)),
+              Field(TypeId::kTypeChar, characters.data(), 64, true)
+      };
+      Row row(fields);
+      ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+      rids.push_back(row.GetRowId());
+      row_nums++;
+    }
+    ASSERT_EQ(PageChain(engine.bpm_, first_page_id), table_heap->GetPageIds());
+    // delete the first half of the rows, vacuum moves the others to the front of the heap
+    for (size_t i = 0; i < row_nums / 2; i++) {
+      ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+      table_heap->ApplyDelete(rids[i], nullptr);
+    }
+    table_heap->Vacuum(nullptr, [](const Row &, const RowId &) {});
+    ASSERT_EQ(PageChain(engine.bpm_, first_page_id), table_heap->GetPageIds());
+    // and the heap grows again past the pages vacuum freed
+    for (size_t i = 0; i < row_nums / 2; i++) {
+      Fields fields{
+              Field(TypeId::kTypeInt, static_cast<int32_t>(row_nums + i)),
+              Field(TypeId::kTypeChar, characters.data(), 64, true)
+      };
+      Row row(fields);
+      ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    }
+    ASSERT_EQ(PageChain(engine.bpm_, first_page_id), table_heap->GetPageIds());
+  }
+  DBStorageEngine engine(db_file_name, false);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, first_page_id, schema.get(), nullptr, nullptr, &heap);
+  std::vector<page_id_t> page_ids = table_heap->GetPageIds();
+  ASSERT_EQ(PageChain(engine.bpm_, first_page_id), page_ids);
+  ASSERT_LE(num_workers * PARALLEL_SCAN_MIN_PAGES, page_ids.size());
+
+  std::vector<RowId> expected;
+  for (auto iter = table_heap->Begin(nullptr); !iter.isNull(); ++iter) {
+    expected.push_back(iter->GetRowId());
+  }
+  ASSERT_EQ(row_nums, expected.size());
+  std::vector<std::vector<RowId>> visited(num_workers);
+  std::vector<std::vector<int32_t>> ids(num_workers);
+  table_heap->ParallelScan(num_workers, [&](size_t worker, const RowView &row) {
+    visited[worker].push_back(row.GetRowId());
+    ids[worker].push_back(std::stoi(row.GetField(0).ToString()));
+  }, nullptr);
+  std::vector<RowId> all;
+  std::vector<bool> seen(row_nums + row_nums / 2, false);
+  for (size_t worker = 0; worker < num_workers; worker++) {
+    EXPECT_FALSE(visited[worker].empty());
+    all.insert(all.end(), visited[worker].begin(), visited[worker].end());
+    for (int32_t id : ids[worker]) {
+      ASSERT_FALSE(seen[id]);
+      seen[id] = true;
+    }
+  }
+  ASSERT_EQ(expected, all);
+  EXPECT_TRUE(engine.bpm_->CheckAllUnpinned());
+
+  // Scenario: more workers than the heap has ranges of PARALLEL_SCAN_MIN_PAGES pages are not started
+  size_t max_worker = 0;
+  std::mutex latch;
+  table_heap->ParallelScan(1000, [&](size_t worker, const RowView &) {
+    std::scoped_lock<std::mutex> lock(latch);
+    max_worker = std::max(max_worker, worker);
+  }, nullptr);
+  EXPECT_EQ(page_ids.size() / PARALLEL_SCAN_MIN_PAGES - 1, max_worker);
+  EXPECT_EQ(max_worker + 1, table_heap->GetParallelScanWorkers(1000));
+
+  // Scenario: with every frame pinned no worker can fetch a page, the scan says so instead of visiting nothing
+  std::vector<page_id_t> pinned = PinAllFrames(engine.bpm_);
+  ASSERT_EQ(engine.bpm_->GetPoolSize(), pinned.size());
+  std::atomic<size_t> visited_rows{0};
+  EXPECT_FALSE(table_heap->ParallelScan(num_workers, [&](size_t, const RowView &) { visited_rows++; }, nullptr));
+  EXPECT_EQ(0u, visited_rows);
+  for (page_id_t page_id : pinned) {
+    engine.bpm_->UnpinPage(page_id, false);
+  }
+  EXPECT_TRUE(table_heap->ParallelScan(num_workers, [&](size_t, const RowView &) { visited_rows++; }, nullptr));
+  EXPECT_EQ(expected.size(), visited_rows);
+}